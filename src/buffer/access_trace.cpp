@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// access_trace.cpp
+//
+// Identification: src/buffer/access_trace.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/access_trace.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+
+constexpr char ACCESS_TRACE_MAGIC[8] = "BTTRACE";
+constexpr uint32_t ACCESS_TRACE_VERSION = 1;
+/** Number of records buffered before they are written out. */
+constexpr size_t ACCESS_TRACE_BUFFER_RECORDS = 4096;
+
+auto CurrentThreadTraceId() -> uint16_t {
+  static std::atomic<uint16_t> next_thread_id{0};
+  thread_local uint16_t thread_id = next_thread_id++;
+  return thread_id;
+}
+
+}  // namespace
+
+AccessTraceWriter::AccessTraceWriter(const std::string &file_name)
+    : start_(std::chrono::steady_clock::now()), file_(file_name, std::ios::binary | std::ios::trunc) {
+  if (!file_.is_open()) {
+    throw Exception(ExceptionType::INVALID, "can't create access trace file " + file_name);
+  }
+  AccessTraceHeader header{};
+  memcpy(header.magic_, ACCESS_TRACE_MAGIC, sizeof(header.magic_));
+  header.version_ = ACCESS_TRACE_VERSION;
+  header.record_size_ = sizeof(AccessTraceRecord);
+  file_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file_.flush();
+  buffer_.reserve(ACCESS_TRACE_BUFFER_RECORDS);
+}
+
+AccessTraceWriter::~AccessTraceWriter() { Close(); }
+
+void AccessTraceWriter::Record(AccessType type, page_id_t page_id, uint8_t flags) {
+  AccessTraceRecord record{};
+  record.timestamp_ns_ =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+  record.page_id_ = page_id;
+  record.thread_id_ = CurrentThreadTraceId();
+  record.type_ = type;
+  record.flags_ = flags;
+
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (closed_) {
+    return;
+  }
+  buffer_.push_back(record);
+  num_records_++;
+  if (buffer_.size() >= ACCESS_TRACE_BUFFER_RECORDS) {
+    FlushBuffer();
+  }
+}
+
+void AccessTraceWriter::Close() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (closed_) {
+    return;
+  }
+  FlushBuffer();
+  file_.close();
+  closed_ = true;
+  buffer_.shrink_to_fit();
+}
+
+auto AccessTraceWriter::GetNumRecords() -> uint64_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return num_records_;
+}
+
+void AccessTraceWriter::FlushBuffer() {
+  file_.write(reinterpret_cast<const char *>(buffer_.data()),
+              static_cast<std::streamsize>(buffer_.size() * sizeof(AccessTraceRecord)));
+  buffer_.clear();
+}
+
+AccessTraceReader::AccessTraceReader(const std::string &file_name) : file_(file_name, std::ios::binary) {
+  if (!file_.is_open()) {
+    throw Exception(ExceptionType::INVALID, "can't open access trace file " + file_name);
+  }
+  AccessTraceHeader header{};
+  if (!file_.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      memcmp(header.magic_, ACCESS_TRACE_MAGIC, sizeof(header.magic_)) != 0) {
+    throw Exception(ExceptionType::INVALID, file_name + " is not an access trace");
+  }
+  if (header.version_ != ACCESS_TRACE_VERSION || header.record_size_ != sizeof(AccessTraceRecord)) {
+    throw Exception(ExceptionType::INVALID, file_name + " has an unsupported access trace version");
+  }
+}
+
+auto AccessTraceReader::Next(AccessTraceRecord *record) -> bool {
+  return static_cast<bool>(file_.read(reinterpret_cast<char *>(record), sizeof(AccessTraceRecord)));
+}
+
+}  // namespace bustub
@@ -0,0 +1,182 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames) : capacity_(num_frames) {}
+
+auto ARCReplacer::ShouldEvictFromT1() -> bool {
+  if (t1_evictable_.empty()) {
+    return false;
+  }
+  if (t2_evictable_.empty()) {
+    return true;
+  }
+  return t1_size_ > target_t1_size_;
+}
+
+auto ARCReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (t1_evictable_.empty() && t2_evictable_.empty()) {
+    return false;
+  }
+  auto from_t1 = ShouldEvictFromT1();
+  auto &evictable = from_t1 ? t1_evictable_ : t2_evictable_;
+  *frame_id = evictable.begin()->second;
+  auto it = frames_.find(*frame_id);
+  auto page_id = it->second.page_id_;
+  Untrack(it);
+  if (page_id != INVALID_PAGE_ID) {
+    (from_t1 ? b1_ : b2_).PushBack(page_id);
+    TrimGhosts();
+  }
+  return true;
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id) { RecordAccess(frame_id, INVALID_PAGE_ID); }
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  current_timestamp_++;
+
+  auto it = frames_.find(frame_id);
+  if (it != frames_.end()) {
+    // A hit: the page has now been seen at least twice, so it belongs to T2.
+    auto &entry = it->second;
+    if (entry.evictable_) {
+      EvictableSetOf(entry).erase({entry.last_access_, frame_id});
+    }
+    if (!entry.in_t2_) {
+      entry.in_t2_ = true;
+      t1_size_--;
+      t2_size_++;
+    }
+    entry.last_access_ = current_timestamp_;
+    if (entry.evictable_) {
+      EvictableSetOf(entry).emplace(entry.last_access_, frame_id);
+    }
+    return;
+  }
+
+  BUSTUB_ENSURE(frame_id >= 0 && static_cast<size_t>(frame_id) < capacity_, "frame id is invalid");
+  FrameEntry entry;
+  entry.page_id_ = page_id;
+  entry.last_access_ = current_timestamp_;
+  if (page_id != INVALID_PAGE_ID && b1_.Contains(page_id)) {
+    // The page was evicted from T1 too early: give T1 more room.
+    auto delta = std::max<size_t>(1, b2_.Size() / b1_.Size());
+    target_t1_size_ = std::min(capacity_, target_t1_size_ + delta);
+    b1_.Erase(page_id);
+    entry.in_t2_ = true;
+  } else if (page_id != INVALID_PAGE_ID && b2_.Contains(page_id)) {
+    // The page was evicted from T2 too early: give T2 more room.
+    auto delta = std::max<size_t>(1, b1_.Size() / b2_.Size());
+    target_t1_size_ = target_t1_size_ > delta ? target_t1_size_ - delta : 0;
+    b2_.Erase(page_id);
+    entry.in_t2_ = true;
+  }
+  (entry.in_t2_ ? t2_size_ : t1_size_)++;
+  EvictableSetOf(entry).emplace(entry.last_access_, frame_id);
+  frames_.emplace(frame_id, entry);
+  TrimGhosts();
+}
+
+void ARCReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end() || it->second.evictable_ == set_evictable) {
+    return;
+  }
+  auto &entry = it->second;
+  if (set_evictable) {
+    EvictableSetOf(entry).emplace(entry.last_access_, frame_id);
+  } else {
+    EvictableSetOf(entry).erase({entry.last_access_, frame_id});
+  }
+  entry.evictable_ = set_evictable;
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    return;
+  }
+  BUSTUB_ENSURE(it->second.evictable_, "frame not evictable, can't remove!");
+  Untrack(it);
+}
+
+auto ARCReplacer::EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> frames;
+  if (t1_evictable_.empty() && t2_evictable_.empty()) {
+    return frames;
+  }
+  // The list Evict() would pick from first, then the other one. Evictions don't move p, so this is exact as long as
+  // the preferred list does not run dry.
+  auto from_t1 = ShouldEvictFromT1();
+  for (auto *evictable : {from_t1 ? &t1_evictable_ : &t2_evictable_, from_t1 ? &t2_evictable_ : &t1_evictable_}) {
+    for (auto it = evictable->begin(); it != evictable->end() && frames.size() < max_frames; ++it) {
+      frames.push_back(it->second);
+    }
+  }
+  return frames;
+}
+
+void ARCReplacer::Resize(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (auto it = frames_.begin(); it != frames_.end();) {
+    if (static_cast<size_t>(it->first) < num_frames) {
+      ++it;
+      continue;
+    }
+    auto next = std::next(it);
+    Untrack(it);
+    it = next;
+  }
+  capacity_ = num_frames;
+  target_t1_size_ = std::min(target_t1_size_, capacity_);
+  TrimGhosts();
+}
+
+auto ARCReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return t1_evictable_.size() + t2_evictable_.size();
+}
+
+auto ARCReplacer::GetTargetT1Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return target_t1_size_;
+}
+
+void ARCReplacer::TrimGhosts() {
+  b1_.TrimTo(capacity_ > t1_size_ ? capacity_ - t1_size_ : 0);
+  auto resident = t1_size_ + t2_size_ + b1_.Size();
+  b2_.TrimTo(2 * capacity_ > resident ? 2 * capacity_ - resident : 0);
+}
+
+void ARCReplacer::Untrack(std::unordered_map<frame_id_t, FrameEntry>::iterator it) {
+  auto &entry = it->second;
+  if (entry.evictable_) {
+    EvictableSetOf(entry).erase({entry.last_access_, it->first});
+  }
+  (entry.in_t2_ ? t2_size_ : t1_size_)--;
+  frames_.erase(it);
+}
+
+}  // namespace bustub
@@ -12,6 +12,11 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/macros.h"
@@ -19,13 +24,32 @@
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHashTable<page_id_t, frame_id_t>(bucket_size_);
-  replacer_ = new LRUKReplacer(pool_size, replacer_k);
-  next_page_id_ = 0;
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager, replacer_policy) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy)
+    : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, BUFFER_POOL_MAX_SIZE)),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      next_page_id_(FirstUnusedPageId(disk_manager, num_instances, instance_index)),
+      pages_(pool_size, max_pool_size_),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      frame_io_(pool_size, max_pool_size_) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 0.");
+  // we allocate a consecutive memory space for the buffer pool, and keep the frame metadata apart from it
+  arena_ = new FrameArena(pool_size_, max_pool_size_);
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].data_ = arena_->GetFrameData(static_cast<frame_id_t>(i));
+  }
+  page_table_ = new PageTable(pool_size_);
+  replacer_ = MakeReplacer(replacer_policy, pool_size, replacer_k);
   // LOG_DEBUG("# [BPMI] pool_size is %zu", pool_size);
 
   // Initially, every page is in the free list.
@@ -35,9 +59,11 @@ BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManag
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
+  StopWarmUp();
+  StopBackgroundFlusher();
+  StopPrefetcher();
+  delete arena_;
   delete page_table_;
-  delete replacer_;
 }
 /**
  * TODO(P1): Add implementation
@@ -56,38 +82,81 @@ BufferPoolManagerInstance::~BufferPoolManagerInstance() {
  * @param[out] page_id id of created page
  * @return nullptr if no new pages could be created, otherwise pointer to new page
  */
-auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * { return NewPgImp(page_id, nullptr); }
+
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) -> Page * {
+  return NewPgImp(page_id, strategy, INVALID_PAGE_ID);
+}
+
+auto BufferPoolManagerInstance::AllocateExtentImp(tablespace_id_t tablespace, size_t num_pages) -> page_id_t {
+  if (tablespace != DEFAULT_TABLESPACE) {
+    return disk_manager_->AllocateExtent(tablespace, num_pages);
+  }
+  if (num_instances_ != 1) {
+    return INVALID_PAGE_ID;
+  }
   std::scoped_lock<std::mutex> lock(latch_);
-  LOG_INFO("# [NewPgImp] Now creating new page");
-  frame_id_t free_frame;
-  if (!free_list_.empty()) {
-    // LOG_DEBUG("# [NewPgImp] Get frame from free list");
-    free_frame = free_list_.front();
-    free_list_.pop_front();
-  } else if (replacer_->Evict(&free_frame)) {
-    // LOG_DEBUG("# [NewPgImp] Free list is full , now evicted %d", free_frame);
-    page_table_->Remove(pages_[free_frame].GetPageId());
+  if (static_cast<size_t>(next_page_id_) + num_pages > TABLESPACE_MAX_PAGES) {
+    return INVALID_PAGE_ID;
+  }
+  return next_page_id_.fetch_add(static_cast<page_id_t>(num_pages));
+}
+
+auto BufferPoolManagerInstance::NewReservedPgImp(page_id_t page_id) -> Page * {
+  ValidatePageId(page_id);
+  page_id_t new_page_id;
+  return NewPgImp(&new_page_id, nullptr, page_id);
+}
 
-    if (pages_[free_frame].IsDirty()) {
-      disk_manager_->WritePage(pages_[free_frame].GetPageId(), pages_[free_frame].GetData());
-      pages_[free_frame].is_dirty_ = false;
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy,
+                                         page_id_t reserved_page_id) -> Page * {
+  std::unique_lock<std::mutex> lock(latch_);
+  bool recycled = false;
+  *page_id = reserved_page_id == INVALID_PAGE_ID ? AllocatePage(&recycled) : reserved_page_id;
+  if (*page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  DropStaleCopy(*page_id, &lock);
+  frame_id_t frame_id;
+  page_id_t victim_page_id;
+  bool reused;
+  if (!AcquireFrame(&frame_id, &victim_page_id, strategy, &reused)) {
+    if (reserved_page_id == INVALID_PAGE_ID) {
+      ReturnPage(*page_id, recycled);
     }
-  } else {
-    // LOG_INFO("# [NewPgImp] Free list is full and can't evict, create new page failed");
     return nullptr;
   }
 
-  *page_id = AllocatePage();
-  // LOG_INFO("# [NewPgImp] Now got new page %d", *page_id);
-
-  page_table_->Insert(*page_id, free_frame);
-  pages_[free_frame].ResetMemory();
-  pages_[free_frame].page_id_ = *page_id;
-  pages_[free_frame].pin_count_++;
-  replacer_->RecordAccess(free_frame);
-  replacer_->SetEvictable(free_frame, false);
+  if (victim_page_id == INVALID_PAGE_ID) {
+    pages_[frame_id].ResetMemory();
+  } else {
+    frame_io_[frame_id].in_progress_ = true;
+  }
+  InstallPage(frame_id, *page_id);
+  // A recycled page still holds its old data on disk until the new, zeroed one is written over it. So may a page of an
+  // extent, which can be a run of free pages.
+  pages_[frame_id].is_dirty_ = recycled || reserved_page_id != INVALID_PAGE_ID;
+  TraceAccess(AccessType::NEW, *page_id);
+  if (strategy != nullptr) {
+    strategy->Advance(&pages_[frame_id], *page_id, reused);
+  }
+  if (victim_page_id == INVALID_PAGE_ID) {
+    return &pages_[frame_id];
+  }
 
-  return &pages_[free_frame];
+  // The victim still has to be written back. Do it without the latch, nobody else can touch the frame meanwhile.
+  lock.unlock();
+  try {
+    WriteBackVictim(frame_id, victim_page_id);
+  } catch (...) {
+    lock.lock();
+    AbortIo(frame_id, victim_page_id);
+    throw;
+  }
+  pages_[frame_id].ResetMemory();
+  lock.lock();
+  FinishIo(frame_id, victim_page_id);
+  return &pages_[frame_id];
 }
 
 /**
@@ -106,44 +175,55 @@ auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
  * @param page_id id of page to be fetched
  * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
  */
-auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
-  std::scoped_lock<std::mutex> lock(latch_);
-  // LOG_INFO("# [FetchPgImp] Now try to fetch page %d ", page_id);
-  frame_id_t fetch_frame;
-  if (page_table_->Find(page_id, fetch_frame)) {
-    // LOG_INFO("# [FetchPgImp] Find page in the pool, now fetch it");
-    replacer_->RecordAccess(fetch_frame);
-    replacer_->SetEvictable(fetch_frame, false);
-    pages_[fetch_frame].pin_count_++;
-    return &pages_[fetch_frame];
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * { return FetchPgImp(page_id, nullptr); }
+
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  if (auto *page = TryPinResident(page_id); page != nullptr) {
+    TraceAccess(AccessType::FETCH, page_id, ACCESS_TRACE_HIT);
+    return page;
   }
 
-  // LOG_INFO("# [FetchPgImp] Can't find page in the pool, now fetch it from the disk");
+  std::unique_lock<std::mutex> lock(latch_);
+  frame_id_t frame_id;
+  while (true) {
+    if (page_table_->Find(page_id, frame_id)) {
+      auto &page = pages_[frame_id];
+      page.pin_count_++;
+      replacer_->RecordAccess(frame_id, page_id);
+      replacer_->SetEvictable(frame_id, false);
+      if (!frame_io_[frame_id].in_progress_) {
+        TraceAccess(AccessType::FETCH, page_id, ACCESS_TRACE_HIT);
+        return &page;
+      }
+      // Another thread is reading the page in. Wait for that frame only, and retry if its read failed.
+      frame_io_[frame_id].io_done_.wait(lock, [&] { return !frame_io_[frame_id].in_progress_; });
+      if (page.page_id_ == page_id) {
+        TraceAccess(AccessType::FETCH, page_id, ACCESS_TRACE_HIT);
+        return &page;
+      }
+      ReleaseFailedFrame(frame_id);
+      continue;
+    }
 
-  if (!free_list_.empty()) {
-    fetch_frame = free_list_.front();
-    // LOG_INFO("# [FetchPgImp] Got frame %d from free list.", fetch_frame);
-    free_list_.pop_front();
-  } else if (replacer_->Evict(&fetch_frame)) {
-    // LOG_INFO("# [FetchPgImp] Got frame by evict.");
-    page_table_->Remove(pages_[fetch_frame].GetPageId());
-    if (pages_[fetch_frame].IsDirty()) {
-      disk_manager_->WritePage(pages_[fetch_frame].GetPageId(), pages_[fetch_frame].GetData());
-      pages_[fetch_frame].is_dirty_ = false;
+    // An evicted copy of the page that is still being written back must land on disk before we read it again.
+    auto it = writing_back_.find(page_id);
+    if (it == writing_back_.end()) {
+      break;
     }
-  } else {
-    return nullptr;
+    // Only this writer will notify us. The page may be reloaded and evicted again by another frame before we wake up,
+    // so wait for this write-back alone and then look the page up again.
+    auto writer = it->second;
+    frame_io_[writer].io_done_.wait(lock, [&] {
+      auto current = writing_back_.find(page_id);
+      return current == writing_back_.end() || current->second != writer;
+    });
   }
 
-  disk_manager_->ReadPage(page_id, pages_[fetch_frame].data_);
-
-  page_table_->Insert(page_id, fetch_frame);
-  pages_[fetch_frame].page_id_ = page_id;
-  pages_[fetch_frame].pin_count_ = 1;
-  replacer_->RecordAccess(fetch_frame);
-  replacer_->SetEvictable(fetch_frame, false);
-
-  return &pages_[fetch_frame];
+  auto *page = LoadPage(page_id, &lock, strategy);
+  if (page != nullptr) {
+    TraceAccess(AccessType::FETCH, page_id);
+  }
+  return page;
 }
 
 /**
@@ -174,20 +254,211 @@ auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) ->
       // LOG_DEBUG("# [UnpinPgImp] page_id%d, pinCount<=0", page_id);
       return false;
     }
-    if (pages_[unpin_frame].GetPinCount() == 1) {
+    if (--pages_[unpin_frame].pin_count_ == 0) {
       // LOG_DEBUG("# [UnpinPgImp] page_id%d, pinCount==1", page_id);
-      pages_[unpin_frame].pin_count_--;
-      replacer_->SetEvictable(unpin_frame, true);
-    } else {
-      // LOG_DEBUG("# [UnpinPgImp] page_id%d, pinCount>1", page_id);
-      pages_[unpin_frame].pin_count_--;
+      // A frame the background flusher is writing becomes evictable when the flusher is done with it.
+      replacer_->SetEvictable(unpin_frame, !frame_io_[unpin_frame].flushing_);
+      if (static_cast<size_t>(unpin_frame) >= pool_size_) {
+        retire_cv_.notify_all();
+      }
     }
+    TraceAccess(AccessType::UNPIN, page_id, is_dirty ? ACCESS_TRACE_DIRTY : 0);
     return true;
   }
 
   return false;
 }
 
+auto BufferPoolManagerInstance::FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> {
+  // Distinct ids in ascending order, each with the number of times it was requested.
+  std::vector<page_id_t> sorted_ids(page_ids);
+  std::sort(sorted_ids.begin(), sorted_ids.end());
+  struct BatchRequest {
+    page_id_t page_id_;
+    int count_;
+    frame_id_t frame_id_{-1};
+    page_id_t victim_page_id_{INVALID_PAGE_ID};
+  };
+  std::vector<BatchRequest> requests;
+  for (auto page_id : sorted_ids) {
+    if (!requests.empty() && requests.back().page_id_ == page_id) {
+      requests.back().count_++;
+    } else {
+      requests.push_back({page_id, 1});
+    }
+  }
+
+  std::vector<BatchRequest> hits;
+  std::vector<BatchRequest> misses;
+  std::vector<BatchRequest> deferred;
+  std::unique_lock<std::mutex> lock(latch_);
+  for (auto &request : requests) {
+    frame_id_t frame_id;
+    if (page_table_->Find(request.page_id_, frame_id)) {
+      if (frame_io_[frame_id].in_progress_) {
+        deferred.push_back(request);
+        continue;
+      }
+      pages_[frame_id].pin_count_ += request.count_;
+      request.frame_id_ = frame_id;
+      hits.push_back(request);
+    } else if (writing_back_.count(request.page_id_) != 0) {
+      deferred.push_back(request);
+    } else {
+      misses.push_back(request);
+    }
+  }
+  // Pin the hits in the replacer before evicting for the misses.
+  std::vector<std::pair<frame_id_t, page_id_t>> accessed;
+  for (const auto &hit : hits) {
+    accessed.emplace_back(hit.frame_id_, hit.page_id_);
+  }
+  replacer_->PinFrames(accessed);
+
+  accessed.clear();
+  size_t num_acquired = 0;
+  for (auto &miss : misses) {
+    if (!AcquireFrame(&miss.frame_id_, &miss.victim_page_id_)) {
+      break;
+    }
+    frame_io_[miss.frame_id_].in_progress_ = true;
+    InstallPage(miss.frame_id_, miss.page_id_, false);
+    accessed.emplace_back(miss.frame_id_, miss.page_id_);
+    num_acquired++;
+  }
+  replacer_->PinFrames(accessed);
+  bool acquired_all = num_acquired == misses.size();
+  misses.erase(misses.begin() + num_acquired, misses.end());
+
+  // Write back the victims, then read every miss that is not in the compressed cache with a single request, in page id
+  // order. If the pool ran out of frames the batch fails, but the victims that were already evicted still have to
+  // reach the disk.
+  lock.unlock();
+  try {
+    std::vector<page_id_t> read_ids;
+    std::vector<char *> read_buffers;
+    for (const auto &miss : misses) {
+      if (miss.victim_page_id_ != INVALID_PAGE_ID) {
+        WriteBackVictim(miss.frame_id_, miss.victim_page_id_);
+      }
+      read_ids.push_back(miss.page_id_);
+      read_buffers.push_back(pages_[miss.frame_id_].GetData());
+    }
+    if (acquired_all) {
+      ReadPagesData(read_ids, read_buffers);
+    }
+  } catch (...) {
+    lock.lock();
+    for (const auto &miss : misses) {
+      AbortIo(miss.frame_id_, miss.victim_page_id_);
+    }
+    for (const auto &hit : hits) {
+      DropPins(hit.frame_id_, hit.count_);
+    }
+    throw;
+  }
+  lock.lock();
+  if (!acquired_all) {
+    for (const auto &miss : misses) {
+      AbortIo(miss.frame_id_, miss.victim_page_id_);
+    }
+    for (const auto &hit : hits) {
+      DropPins(hit.frame_id_, hit.count_);
+    }
+    return {};
+  }
+
+  std::unordered_map<page_id_t, Page *> fetched;
+  for (const auto &miss : misses) {
+    FinishIo(miss.frame_id_, miss.victim_page_id_);
+    pages_[miss.frame_id_].pin_count_ += miss.count_ - 1;
+    fetched[miss.page_id_] = &pages_[miss.frame_id_];
+    TraceAccess(AccessType::FETCH, miss.page_id_);
+    for (int i = 1; i < miss.count_; i++) {
+      TraceAccess(AccessType::FETCH, miss.page_id_, ACCESS_TRACE_HIT);
+    }
+  }
+  for (const auto &hit : hits) {
+    fetched[hit.page_id_] = &pages_[hit.frame_id_];
+    for (int i = 0; i < hit.count_; i++) {
+      TraceAccess(AccessType::FETCH, hit.page_id_, ACCESS_TRACE_HIT);
+    }
+  }
+  lock.unlock();
+
+  // Pages that were being read or written back by another thread are fetched one by one once that I/O is done.
+  if (!deferred.empty()) {
+    std::vector<std::pair<page_id_t, int>> pinned;
+    for (const auto &request : misses) {
+      pinned.emplace_back(request.page_id_, request.count_);
+    }
+    for (const auto &request : hits) {
+      pinned.emplace_back(request.page_id_, request.count_);
+    }
+    for (const auto &request : deferred) {
+      for (int pins = 0; pins < request.count_; pins++) {
+        auto *page = FetchPgImp(request.page_id_);
+        if (page == nullptr) {
+          // Every frame is pinned: drop all the pins taken by this batch.
+          pinned.emplace_back(request.page_id_, pins);
+          lock.lock();
+          for (const auto &[page_id, count] : pinned) {
+            frame_id_t frame_id;
+            if (count > 0 && page_table_->Find(page_id, frame_id)) {
+              DropPins(frame_id, count);
+            }
+          }
+          return {};
+        }
+        fetched[request.page_id_] = page;
+      }
+      pinned.emplace_back(request.page_id_, request.count_);
+    }
+  }
+
+  std::vector<Page *> pages;
+  pages.reserve(page_ids.size());
+  for (auto page_id : page_ids) {
+    pages.push_back(fetched[page_id]);
+  }
+  return pages;
+}
+
+auto BufferPoolManagerInstance::UnpinPgsImp(const std::vector<page_id_t> &page_ids, bool is_dirty) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  bool all_unpinned = true;
+  bool retiring = false;
+  std::vector<frame_id_t> unpinned;
+  for (auto page_id : page_ids) {
+    frame_id_t frame_id;
+    if (!page_table_->Find(page_id, frame_id)) {
+      all_unpinned = false;
+      continue;
+    }
+    auto &page = pages_[frame_id];
+    if (!page.IsDirty()) {
+      page.is_dirty_ = is_dirty;
+    }
+    if (page.GetPinCount() <= 0) {
+      all_unpinned = false;
+      continue;
+    }
+    if (--page.pin_count_ == 0) {
+      // A frame the background flusher is writing becomes evictable when the flusher is done with it.
+      if (!frame_io_[frame_id].flushing_) {
+        unpinned.push_back(frame_id);
+      }
+      retiring = retiring || static_cast<size_t>(frame_id) >= pool_size_;
+    }
+    TraceAccess(AccessType::UNPIN, page_id, is_dirty ? ACCESS_TRACE_DIRTY : 0);
+  }
+  replacer_->UnpinFrames(unpinned);
+  if (retiring) {
+    retire_cv_.notify_all();
+  }
+  return all_unpinned;
+}
+
 /**
  * TODO(P1): Add implementation
  *
@@ -200,31 +471,43 @@ auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) ->
  * @return false if the page could not be found in the page table, true otherwise
  */
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
   if (page_id == INVALID_PAGE_ID) {
     throw "Page Can't be INVALID_PAGE_ID";
   }
+  std::unique_lock<std::mutex> lock(latch_);
   frame_id_t flush_frame;
-  if (page_table_->Find(page_id, flush_frame)) {
-    pages_[flush_frame].is_dirty_ = false;
-    disk_manager_->WritePage(page_id, pages_[flush_frame].GetData());
-    // LOG_INFO("# [FlushPgImp] Page %d flushed", page_id);
-    return true;
+  if (!page_table_->Find(page_id, flush_frame)) {
+    return false;
   }
-  // LOG_INFO("# [FlushPgImp] Can't find page %d, flush failed", page_id);
-  return false;
+  auto &page = pages_[flush_frame];
+  // Pin the frame so that it can't be evicted while the write runs without the latch.
+  page.pin_count_++;
+  replacer_->SetEvictable(flush_frame, false);
+  frame_io_[flush_frame].io_done_.wait(lock, [&] { return !frame_io_[flush_frame].in_progress_; });
+  if (page.page_id_ != page_id) {
+    ReleaseFailedFrame(flush_frame);
+    return false;
+  }
+  page.is_dirty_ = false;
+  lock.unlock();
+
+  WritePageData(page_id, page.GetData());
+
+  lock.lock();
+  if (--page.pin_count_ == 0) {
+    replacer_->SetEvictable(flush_frame, !frame_io_[flush_frame].flushing_);
+  }
+  return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  std::scoped_lock<std::mutex> lock(latch_);
-  // LOG_INFO("# [FlushAllPgsImp] Now flush all the pages.");
-  for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].GetPageId() != INVALID_PAGE_ID) {
-      pages_[i].is_dirty_ = false;
+  auto frames = CollectDirtyFrames();
+  WriteBackFrames(&frames, DiskRequestPriority::FOREGROUND);
+}
 
-      disk_manager_->WritePage(pages_[i].GetPageId(), pages_[i].GetData());
-    }
-  }
+void BufferPoolManagerInstance::SyncAllPgsImp() {
+  FlushAllPgsImp();
+  disk_manager_->Sync();
 }
 
 /**
@@ -241,35 +524,811 @@ void BufferPoolManagerInstance::FlushAllPgsImp() {
  * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
  */
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
   if (page_id == INVALID_PAGE_ID) {
     throw "Page Can't be INVALID_PAGE_ID";
   }
   // LOG_INFO("# [DeletePgImp] Now delete the page %d.", page_id);
 
   frame_id_t delete_frame;
+  while (page_table_->Find(page_id, delete_frame) && frame_io_[delete_frame].flushing_) {
+    // Let the background flusher finish writing the page, then look it up again.
+    frame_io_[delete_frame].io_done_.wait(lock, [&] { return !frame_io_[delete_frame].flushing_; });
+  }
   if (page_table_->Find(page_id, delete_frame)) {
-    if (pages_[delete_frame].GetPinCount() > 0) {
+    if (pages_[delete_frame].GetPinCount() > 0 || !DetachFrame(delete_frame)) {
       // LOG_INFO("# [DeletePgImp] Page %d can't be deleted.", page_id);
       return false;
     }
     pages_[delete_frame].ResetMemory();
     pages_[delete_frame].page_id_ = INVALID_PAGE_ID;
     pages_[delete_frame].is_dirty_ = false;
-    page_table_->Remove(page_id);
+    replacer_->SetEvictable(delete_frame, true);
     replacer_->Remove(delete_frame);
     free_list_.emplace_back(delete_frame);
+    frame_io_[delete_frame].in_free_list_ = true;
 
     DeallocatePage(page_id);
+    TraceAccess(AccessType::DELETE, page_id);
 
     // LOG_INFO("# [DeletePgImp] Page deleted.");
     return true;
   }
 
   LOG_INFO("# [DeletePgImp] Page didn't exist.");
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Erase(page_id);
+  }
+  // An evicted copy of the page that is still being written back must land before the page can be handed out again.
+  for (auto it = writing_back_.find(page_id); it != writing_back_.end(); it = writing_back_.find(page_id)) {
+    auto writer = it->second;
+    frame_io_[writer].io_done_.wait(lock, [&] {
+      auto current = writing_back_.find(page_id);
+      return current == writing_back_.end() || current->second != writer;
+    });
+  }
+  if (IsAllocated(page_id) && static_cast<uint32_t>(page_id) % num_instances_ == instance_index_) {
+    DeallocatePage(page_id);
+  }
+  TraceAccess(AccessType::DELETE, page_id);
+  return true;
+}
+
+void BufferPoolManagerInstance::StartBackgroundFlusher(double target_clean_ratio, size_t pages_per_second) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (flusher_running_) {
+    return;
+  }
+  flusher_running_ = true;
+  flusher_thread_ = std::thread(&BufferPoolManagerInstance::RunBackgroundFlusher, this, target_clean_ratio,
+                                pages_per_second);
+}
+
+void BufferPoolManagerInstance::StopBackgroundFlusher() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    flusher_running_ = false;
+  }
+  flusher_cv_.notify_all();
+  if (flusher_thread_.joinable()) {
+    flusher_thread_.join();
+  }
+}
+
+void BufferPoolManagerInstance::RunBackgroundFlusher(double target_clean_ratio, size_t pages_per_second) {
+  auto rounds_per_second = std::max<int64_t>(1, 1000 / std::max<int64_t>(1, bg_flush_interval.count()));
+  auto pages_per_round = std::max<size_t>(1, pages_per_second / static_cast<size_t>(rounds_per_second));
+
+  std::unique_lock<std::mutex> lock(latch_);
+  while (flusher_running_) {
+    // Free frames are clean already, only the rest of the window has to come from the eviction order.
+    auto window = static_cast<size_t>(target_clean_ratio * static_cast<double>(pool_size_));
+    auto free_frames = free_list_.size();
+    lock.unlock();
+    if (free_frames < window) {
+      background_writes_ += FlushEvictionCandidates(window - free_frames, pages_per_round);
+    }
+    lock.lock();
+    flusher_cv_.wait_for(lock, bg_flush_interval, [&] { return !flusher_running_; });
+  }
+}
+
+auto BufferPoolManagerInstance::FlushEvictionCandidates(size_t window, size_t max_pages) -> size_t {
+  FlushList frames;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    for (auto frame_id : replacer_->EvictionOrder(window)) {
+      if (frames.size() == max_pages) {
+        break;
+      }
+      if (BeginFlushLocked(frame_id)) {
+        frames.emplace_back(frame_id, pages_[frame_id].GetPageId());
+      }
+    }
+  }
+  auto count = frames.size();
+  WriteBackFrames(&frames, DiskRequestPriority::BACKGROUND);
+  return count;
+}
+
+auto BufferPoolManagerInstance::BeginFlushLocked(frame_id_t frame_id) -> bool {
+  auto &page = pages_[frame_id];
+  auto &io = frame_io_[frame_id];
+  if (page.GetPageId() == INVALID_PAGE_ID || !page.IsDirty() || io.in_progress_ || io.flushing_) {
+    return false;
+  }
+  // Keep the frame out of the replacer while the write runs. Fetchers can still pin and use it.
+  replacer_->SetEvictable(frame_id, false);
+  io.flushing_ = true;
+  page.is_dirty_ = false;
+  return true;
+}
+
+auto BufferPoolManagerInstance::CollectDirtyFrames() -> FlushList {
+  FlushList frames;
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (size_t i = 0; i < pool_size_; i++) {
+    auto frame_id = static_cast<frame_id_t>(i);
+    if (BeginFlushLocked(frame_id)) {
+      frames.emplace_back(frame_id, pages_[frame_id].GetPageId());
+    }
+  }
+  return frames;
+}
+
+void BufferPoolManagerInstance::EndFlush(const FlushList &frames, bool written) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (const auto &[frame_id, page_id] : frames) {
+    auto &page = pages_[frame_id];
+    frame_io_[frame_id].flushing_ = false;
+    if (!written) {
+      page.is_dirty_ = true;
+    }
+    if (page.GetPinCount() == 0) {
+      replacer_->SetEvictable(frame_id, true);
+    }
+    frame_io_[frame_id].io_done_.notify_all();
+  }
+}
+
+void BufferPoolManagerInstance::WriteBackFrames(FlushList *frames, DiskRequestPriority priority) {
+  if (frames->empty()) {
+    return;
+  }
+  std::sort(frames->begin(), frames->end(), [](const auto &a, const auto &b) { return a.second < b.second; });
+  std::vector<page_id_t> page_ids;
+  std::vector<char *> pages_data;
+  page_ids.reserve(frames->size());
+  pages_data.reserve(frames->size());
+  for (const auto &[frame_id, page_id] : *frames) {
+    page_ids.push_back(page_id);
+    pages_data.push_back(pages_[frame_id].GetData());
+  }
+  try {
+    WritePagesData(page_ids, pages_data, priority);
+  } catch (...) {
+    EndFlush(*frames, false);
+    throw;
+  }
+  EndFlush(*frames, true);
+}
+
+auto BufferPoolManagerInstance::LoadPage(page_id_t page_id, std::unique_lock<std::mutex> *lock,
+                                         BufferAccessStrategy *strategy) -> Page * {
+  frame_id_t frame_id;
+  page_id_t victim_page_id;
+  bool reused;
+  if (!AcquireFrame(&frame_id, &victim_page_id, strategy, &reused)) {
+    return nullptr;
+  }
+  // Both the write-back of the victim and the read of the new page happen without the latch. The frame is marked as
+  // having I/O in progress, so concurrent fetchers of page_id wait on it instead of reading the page a second time.
+  frame_io_[frame_id].in_progress_ = true;
+  InstallPage(frame_id, page_id);
+  if (strategy != nullptr) {
+    strategy->Advance(&pages_[frame_id], page_id, reused);
+  }
+  lock->unlock();
+  try {
+    if (victim_page_id != INVALID_PAGE_ID) {
+      WriteBackVictim(frame_id, victim_page_id);
+    }
+    ReadPageData(page_id, pages_[frame_id].GetData());
+  } catch (...) {
+    lock->lock();
+    AbortIo(frame_id, victim_page_id);
+    throw;
+  }
+  lock->lock();
+  FinishIo(frame_id, victim_page_id);
+  return &pages_[frame_id];
+}
+
+void BufferPoolManagerInstance::PrefetchPgsImp(page_id_t first_page_id, size_t num_pages) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // Bound the queue so that prefetching can't push the pages a scan is working on out of the pool.
+  auto max_queued = std::max<size_t>(1, pool_size_ / 4);
+  for (size_t i = 0; i < num_pages && prefetch_queue_.size() < max_queued; i++) {
+    auto page_id = first_page_id + static_cast<page_id_t>(i);
+    // Only prefetch pages owned by this instance that have been allocated already.
+    if (page_id < 0 || !IsAllocated(page_id) || page_id % num_instances_ != instance_index_) {
+      continue;
+    }
+    prefetch_queue_.push_back(page_id);
+  }
+  if (prefetch_queue_.empty()) {
+    return;
+  }
+  if (!prefetcher_thread_.joinable()) {
+    prefetcher_running_ = true;
+    prefetcher_thread_ = std::thread(&BufferPoolManagerInstance::RunPrefetcher, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::StopPrefetcher() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    prefetcher_running_ = false;
+    prefetch_queue_.clear();
+  }
+  prefetch_cv_.notify_all();
+  if (prefetcher_thread_.joinable()) {
+    prefetcher_thread_.join();
+  }
+}
+
+void BufferPoolManagerInstance::RunPrefetcher() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [&] { return !prefetcher_running_ || !prefetch_queue_.empty(); });
+    if (!prefetcher_running_) {
+      return;
+    }
+    auto page_id = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+
+    // Skip pages that are resident already, or still being written back by an eviction.
+    frame_id_t frame_id;
+    if (page_table_->Find(page_id, frame_id) || writing_back_.count(page_id) != 0) {
+      continue;
+    }
+    Page *page;
+    try {
+      page = LoadPage(page_id, &lock);
+    } catch (...) {
+      // Prefetching is best effort, a failed read is retried by the fetch that actually needs the page.
+      continue;
+    }
+    if (page == nullptr) {
+      continue;
+    }
+    // Prefetched pages are not pinned.
+    prefetched_pages_++;
+    frame_id = static_cast<frame_id_t>(page - pages_.Data());
+    if (--page->pin_count_ == 0) {
+      replacer_->SetEvictable(frame_id, !frame_io_[frame_id].flushing_);
+    }
+  }
+}
+
+auto BufferPoolManagerInstance::HotPagesImp() -> std::vector<page_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<page_id_t> page_ids;
+  std::vector<bool> listed(pool_size_, false);
+  auto list_frame = [&](frame_id_t frame_id) {
+    if (!listed[frame_id] && pages_[frame_id].page_id_ != INVALID_PAGE_ID && !frame_io_[frame_id].in_progress_) {
+      page_ids.push_back(pages_[frame_id].page_id_);
+      listed[frame_id] = true;
+    }
+  };
+  // Pages in use right now are the hottest, then come the others from the last one the replacer would evict. Frames
+  // the replacer doesn't list right now, e.g. because the background flusher is writing them, go last.
+  for (size_t i = 0; i < pool_size_; i++) {
+    if (pages_[i].GetPinCount() > 0) {
+      list_frame(static_cast<frame_id_t>(i));
+    }
+  }
+  auto order = replacer_->EvictionOrder(pool_size_);
+  for (auto it = order.rbegin(); it != order.rend(); it++) {
+    if (static_cast<size_t>(*it) < pool_size_) {
+      list_frame(*it);
+    }
+  }
+  for (size_t i = 0; i < pool_size_; i++) {
+    list_frame(static_cast<frame_id_t>(i));
+  }
+  return page_ids;
+}
+
+void BufferPoolManagerInstance::WarmUpImp(const std::vector<page_id_t> &page_ids) {
+  StopWarmUp();
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<page_id_t> to_load;
+  for (auto page_id : page_ids) {
+    if (to_load.size() == free_list_.size()) {
+      break;
+    }
+    if (page_id < 0 || static_cast<uint32_t>(page_id) % num_instances_ != instance_index_) {
+      continue;
+    }
+    // Tablespaces are not persisted: the pages of one that was not added again can't be read.
+    auto tablespace = DiskManager::TablespaceOf(page_id);
+    if (tablespace != DEFAULT_TABLESPACE && page_id >= disk_manager_->GetTablespaceEnd(tablespace)) {
+      continue;
+    }
+    to_load.push_back(page_id);
+  }
+  if (to_load.empty()) {
+    return;
+  }
+  std::sort(to_load.begin(), to_load.end());
+  to_load.erase(std::unique(to_load.begin(), to_load.end()), to_load.end());
+  // The pages exist on disk, NewPage() must not hand their ids out again. Those of the other tablespaces sort last and
+  // are below the end of their tablespace already.
+  auto last_default = std::find_if(to_load.rbegin(), to_load.rend(), [](page_id_t page_id) {
+    return DiskManager::TablespaceOf(page_id) == DEFAULT_TABLESPACE;
+  });
+  if (last_default != to_load.rend() && *last_default >= next_page_id_) {
+    next_page_id_ = *last_default + static_cast<page_id_t>(num_instances_);
+  }
+  warmup_running_ = true;
+  warmup_thread_ = std::thread(&BufferPoolManagerInstance::RunWarmUp, this, std::move(to_load));
+}
+
+void BufferPoolManagerInstance::WaitForWarmUp() {
+  if (warmup_thread_.joinable()) {
+    warmup_thread_.join();
+  }
+}
+
+void BufferPoolManagerInstance::StopWarmUp() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    warmup_running_ = false;
+  }
+  WaitForWarmUp();
+}
+
+void BufferPoolManagerInstance::RunWarmUp(const std::vector<page_id_t> &page_ids) {
+  for (size_t start = 0; start < page_ids.size(); start += WARMUP_BATCH_SIZE) {
+    {
+      std::scoped_lock<std::mutex> lock(latch_);
+      if (!warmup_running_) {
+        return;
+      }
+    }
+    auto end = std::min(page_ids.size(), start + WARMUP_BATCH_SIZE);
+    try {
+      if (!PreloadPages(std::vector<page_id_t>(page_ids.begin() + start, page_ids.begin() + end))) {
+        return;
+      }
+    } catch (...) {
+      // Warming up is best effort, a failed read is retried by the fetch that actually needs the page.
+      return;
+    }
+  }
+}
+
+auto BufferPoolManagerInstance::PreloadPages(const std::vector<page_id_t> &page_ids) -> bool {
+  std::vector<page_id_t> read_ids;
+  std::vector<frame_id_t> read_frames;
+  std::vector<char *> read_buffers;
+  std::vector<std::pair<frame_id_t, page_id_t>> accessed;
+  bool out_of_frames = false;
+  std::unique_lock<std::mutex> lock(latch_);
+  for (auto page_id : page_ids) {
+    frame_id_t frame_id;
+    if (page_table_->Find(page_id, frame_id) || writing_back_.count(page_id) != 0) {
+      continue;
+    }
+    // Never evict: the pages queries loaded since startup are hotter than the ones of the last run.
+    if (free_list_.empty()) {
+      out_of_frames = true;
+      break;
+    }
+    frame_id = free_list_.front();
+    free_list_.pop_front();
+    frame_io_[frame_id].in_free_list_ = false;
+    frame_io_[frame_id].in_progress_ = true;
+    InstallPage(frame_id, page_id, false);
+    accessed.emplace_back(frame_id, page_id);
+    read_ids.push_back(page_id);
+    read_frames.push_back(frame_id);
+    read_buffers.push_back(pages_[frame_id].GetData());
+  }
+  replacer_->PinFrames(accessed);
+  lock.unlock();
+
+  try {
+    ReadPagesData(read_ids, read_buffers);
+  } catch (...) {
+    lock.lock();
+    for (auto frame_id : read_frames) {
+      AbortIo(frame_id, INVALID_PAGE_ID);
+    }
+    throw;
+  }
+
+  lock.lock();
+  // Preloaded pages are not pinned.
+  std::vector<frame_id_t> unpinned;
+  for (auto frame_id : read_frames) {
+    FinishIo(frame_id, INVALID_PAGE_ID);
+    if (--pages_[frame_id].pin_count_ == 0 && !frame_io_[frame_id].flushing_) {
+      unpinned.push_back(frame_id);
+    }
+  }
+  replacer_->UnpinFrames(unpinned);
+  warmed_up_pages_ += read_frames.size();
+  return !out_of_frames;
+}
+
+auto BufferPoolManagerInstance::FindRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) -> bool {
+  const auto &slot = strategy->CurrentSlot();
+  if (slot.page_ < pages_.Data() || slot.page_ >= pages_.Data() + pool_size_) {
+    return false;
+  }
+  *frame_id = static_cast<frame_id_t>(slot.page_ - pages_.Data());
+  const auto &page = pages_[*frame_id];
+  return page.page_id_ == slot.page_id_ && page.pin_count_ == 0 && !frame_io_[*frame_id].in_progress_ &&
+         !frame_io_[*frame_id].flushing_;
+}
+
+auto BufferPoolManagerInstance::AcquireFrame(frame_id_t *frame_id, page_id_t *victim_page_id,
+                                             BufferAccessStrategy *strategy, bool *reused) -> bool {
+  *victim_page_id = INVALID_PAGE_ID;
+  if (reused != nullptr) {
+    *reused = false;
+  }
+  if (strategy != nullptr && FindRingFrame(strategy, frame_id) && DetachFrame(*frame_id)) {
+    // Recycle the ring's own frame, which also drops its access history so the page doesn't look hot to LRU-K.
+    replacer_->SetEvictable(*frame_id, true);
+    replacer_->Remove(*frame_id);
+    if (reused != nullptr) {
+      *reused = true;
+    }
+  } else if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    frame_io_[*frame_id].in_free_list_ = false;
+    return true;
+  } else {
+    while (true) {
+      if (!replacer_->Evict(frame_id)) {
+        return false;
+      }
+      if (static_cast<size_t>(*frame_id) >= pool_size_) {
+        // A shrinking ResizeImp() is retiring the frame, leave it alone.
+        continue;
+      }
+      if (DetachFrame(*frame_id)) {
+        break;
+      }
+      // A cache hit pinned the frame after the replacer picked it. Track it again as a pinned frame.
+      replacer_->RecordAccess(*frame_id, pages_[*frame_id].page_id_);
+      replacer_->SetEvictable(*frame_id, false);
+    }
+  }
+  auto &victim = pages_[*frame_id];
+  auto stash = compressed_cache_ != nullptr && (reused == nullptr || !*reused);
+  frame_io_[*frame_id].victim_dirty_ = victim.IsDirty();
+  if (victim.IsDirty() || stash) {
+    // Until the write-back finishes, fetchers of the victim page must wait instead of reading a stale copy.
+    *victim_page_id = victim.GetPageId();
+    writing_back_.emplace(*victim_page_id, *frame_id);
+    if (victim.IsDirty()) {
+      victim.is_dirty_ = false;
+      sync_write_backs_++;
+    }
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::WriteBackVictim(frame_id_t frame_id, page_id_t victim_page_id) {
+  auto *data = pages_[frame_id].GetData();
+  if (frame_io_[frame_id].victim_dirty_) {
+    WritePageData(victim_page_id, data);
+  }
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Insert(victim_page_id, data);
+  }
+}
+
+void BufferPoolManagerInstance::WritePageData(page_id_t page_id, const char *page_data,
+                                              DiskRequestPriority priority) {
+  if (disk_scheduler_ != nullptr) {
+    disk_scheduler_->ScheduleWrite(page_id, page_data, priority).get();
+  } else {
+    disk_manager_->WritePage(page_id, page_data);
+  }
+}
+
+void BufferPoolManagerInstance::WritePagesData(const std::vector<page_id_t> &page_ids,
+                                               const std::vector<char *> &pages_data, DiskRequestPriority priority) {
+  if (disk_scheduler_ == nullptr) {
+    disk_manager_->WritePages(page_ids, pages_data);
+    return;
+  }
+  // Queue the whole batch at once, so that the scheduler can merge adjacent pages.
+  std::vector<std::future<bool>> writes;
+  writes.reserve(page_ids.size());
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    writes.push_back(disk_scheduler_->ScheduleWrite(page_ids[i], pages_data[i], priority));
+  }
+  DiskScheduler::WaitAll(&writes);
+}
+
+void BufferPoolManagerInstance::ReadPageData(page_id_t page_id, char *page_data) {
+  if (compressed_cache_ != nullptr && compressed_cache_->Take(page_id, page_data)) {
+    return;
+  }
+  if (disk_scheduler_ != nullptr) {
+    disk_scheduler_->ScheduleRead(page_id, page_data).get();
+  } else {
+    disk_manager_->ReadPage(page_id, page_data);
+  }
+}
+
+void BufferPoolManagerInstance::ReadPagesData(const std::vector<page_id_t> &page_ids,
+                                              const std::vector<char *> &pages_data) {
+  std::vector<page_id_t> disk_page_ids;
+  std::vector<char *> disk_pages_data;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    if (compressed_cache_ == nullptr || !compressed_cache_->Take(page_ids[i], pages_data[i])) {
+      disk_page_ids.push_back(page_ids[i]);
+      disk_pages_data.push_back(pages_data[i]);
+    }
+  }
+  if (disk_page_ids.empty()) {
+    return;
+  }
+  if (disk_scheduler_ != nullptr) {
+    std::vector<std::future<bool>> reads;
+    reads.reserve(disk_page_ids.size());
+    for (size_t i = 0; i < disk_page_ids.size(); i++) {
+      reads.push_back(disk_scheduler_->ScheduleRead(disk_page_ids[i], disk_pages_data[i]));
+    }
+    DiskScheduler::WaitAll(&reads);
+  } else {
+    disk_manager_->ReadPages(disk_page_ids, disk_pages_data);
+  }
+}
+
+void BufferPoolManagerInstance::InstallPage(frame_id_t frame_id, page_id_t page_id, bool record_access) {
+  auto &page = pages_[frame_id];
+  page.page_id_ = page_id;
+  // Increment rather than set: a failed TryPinResident() may still hold a transient pin that it will drop.
+  page.pin_count_++;
+  page.is_dirty_ = false;
+  if (record_access) {
+    replacer_->RecordAccess(frame_id, page_id);
+    replacer_->SetEvictable(frame_id, false);
+  }
+  // Publish the mapping last, cache hits may use the frame as soon as they see it.
+  page_table_->Insert(page_id, frame_id);
+}
+
+void BufferPoolManagerInstance::FinishIo(frame_id_t frame_id, page_id_t victim_page_id) {
+  if (victim_page_id != INVALID_PAGE_ID) {
+    writing_back_.erase(victim_page_id);
+  }
+  frame_io_[frame_id].in_progress_ = false;
+  frame_io_[frame_id].io_done_.notify_all();
+}
+
+void BufferPoolManagerInstance::AbortIo(frame_id_t frame_id, page_id_t victim_page_id) {
+  page_table_->Remove(pages_[frame_id].GetPageId());
+  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+  FinishIo(frame_id, victim_page_id);
+  ReleaseFailedFrame(frame_id);
+}
+
+void BufferPoolManagerInstance::ReleaseFailedFrame(frame_id_t frame_id) {
+  // The last pin on a frame whose read failed returns it to the free list, unless a shrink retires the frame.
+  if (--pages_[frame_id].pin_count_ == 0 && !frame_io_[frame_id].in_free_list_ &&
+      static_cast<size_t>(frame_id) < pool_size_) {
+    replacer_->SetEvictable(frame_id, true);
+    replacer_->Remove(frame_id);
+    free_list_.emplace_back(frame_id);
+    frame_io_[frame_id].in_free_list_ = true;
+  }
+}
+
+void BufferPoolManagerInstance::DropPins(frame_id_t frame_id, int count) {
+  if ((pages_[frame_id].pin_count_ -= count) == 0) {
+    replacer_->SetEvictable(frame_id, !frame_io_[frame_id].flushing_);
+    if (static_cast<size_t>(frame_id) >= pool_size_) {
+      retire_cv_.notify_all();
+    }
+  }
+}
+
+auto BufferPoolManagerInstance::TryPinResident(page_id_t page_id) -> Page * {
+  frame_id_t frame_id;
+  if (!page_table_->Find(page_id, frame_id)) {
+    return nullptr;
+  }
+  auto &page = pages_[frame_id];
+  page.pin_count_++;
+  frame_id_t current_frame_id;
+  if (page_table_->Find(page_id, current_frame_id) && current_frame_id == frame_id &&
+      !frame_io_[frame_id].in_progress_) {
+    replacer_->RecordAccess(frame_id, page_id);
+    replacer_->SetEvictable(frame_id, false);
+    return &page;
+  }
+  std::scoped_lock<std::mutex> lock(latch_);
+  UndoTransientPin(frame_id);
+  return nullptr;
+}
+
+void BufferPoolManagerInstance::UndoTransientPin(frame_id_t frame_id) {
+  auto &page = pages_[frame_id];
+  if (page.page_id_ == INVALID_PAGE_ID) {
+    // The frame's read failed or its page was deleted meanwhile, it may be waiting for this pin to be freed.
+    ReleaseFailedFrame(frame_id);
+    return;
+  }
+  frame_id_t current_frame_id;
+  if (--page.pin_count_ == 0 && page_table_->Find(page.page_id_, current_frame_id) && current_frame_id == frame_id &&
+      !frame_io_[frame_id].in_progress_) {
+    // An eviction that saw this pin may have made the frame non-evictable.
+    replacer_->SetEvictable(frame_id, !frame_io_[frame_id].flushing_);
+  }
+}
+
+void BufferPoolManagerInstance::DropStaleCopy(page_id_t page_id, std::unique_lock<std::mutex> *lock) {
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Erase(page_id);
+  }
+  frame_id_t frame_id;
+  while (page_table_->Find(page_id, frame_id) && frame_io_[frame_id].in_progress_) {
+    frame_io_[frame_id].io_done_.wait(*lock, [&] { return !frame_io_[frame_id].in_progress_; });
+  }
+  if (!page_table_->Find(page_id, frame_id) || !DetachFrame(frame_id)) {
+    return;
+  }
+  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+  replacer_->SetEvictable(frame_id, true);
+  replacer_->Remove(frame_id);
+  free_list_.emplace_back(frame_id);
+  frame_io_[frame_id].in_free_list_ = true;
+}
+
+auto BufferPoolManagerInstance::DetachFrame(frame_id_t frame_id) -> bool {
+  auto page_id = pages_[frame_id].page_id_;
+  page_table_->Remove(page_id);
+  if (pages_[frame_id].pin_count_ == 0) {
+    return true;
+  }
+  page_table_->Insert(page_id, frame_id);
+  return false;
+}
+
+void BufferPoolManagerInstance::SetAccessTraceImp(std::shared_ptr<AccessTraceWriter> trace) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  access_trace_.store(trace.get(), std::memory_order_release);
+  if (trace != nullptr) {
+    access_traces_.push_back(std::move(trace));
+  }
+}
+
+auto BufferPoolManagerInstance::ResizeImp(size_t new_pool_size) -> bool {
+  if (new_pool_size == 0 || new_pool_size > max_pool_size_) {
+    return false;
+  }
+  std::scoped_lock<std::mutex> resize_lock(resize_latch_);
+  std::unique_lock<std::mutex> lock(latch_);
+  size_t old_pool_size = pool_size_;
+  if (new_pool_size >= old_pool_size) {
+    arena_->Resize(new_pool_size);
+    pages_.Grow(new_pool_size);
+    frame_io_.Grow(new_pool_size);
+    replacer_->Resize(new_pool_size);
+    page_table_->Reserve(new_pool_size);
+    for (size_t i = old_pool_size; i < new_pool_size; ++i) {
+      pages_[i].data_ = arena_->GetFrameData(static_cast<frame_id_t>(i));
+      free_list_.emplace_back(static_cast<frame_id_t>(i));
+      frame_io_[i].in_free_list_ = true;
+    }
+    pool_size_ = new_pool_size;
+    return true;
+  }
+
+  // From here on, the frames that go away are neither taken from the free list nor evicted for other pages.
+  pool_size_ = new_pool_size;
+  free_list_.remove_if([&](frame_id_t frame_id) {
+    if (static_cast<size_t>(frame_id) < new_pool_size) {
+      return false;
+    }
+    frame_io_[frame_id].in_free_list_ = false;
+    return true;
+  });
+  while (true) {
+    bool retired_all = true;
+    for (size_t i = new_pool_size; i < old_pool_size; ++i) {
+      if (!RetireFrame(static_cast<frame_id_t>(i), &lock)) {
+        retired_all = false;
+      }
+    }
+    if (retired_all) {
+      break;
+    }
+    // Unpinning a retiring frame wakes us up, the timeout covers the rarer ways a frame becomes unpinned.
+    retire_cv_.wait_for(lock, bg_flush_interval);
+  }
+  replacer_->Resize(new_pool_size);
+  arena_->Resize(new_pool_size);
+  return true;
+}
+
+auto BufferPoolManagerInstance::RetireFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock) -> bool {
+  auto &page = pages_[frame_id];
+  auto &io = frame_io_[frame_id];
+  if (page.pin_count_ > 0 || io.in_progress_ || io.flushing_) {
+    return false;
+  }
+  auto page_id = page.page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    // Free, or retired already.
+    return true;
+  }
+  if (!DetachFrame(frame_id)) {
+    return false;
+  }
+  replacer_->SetEvictable(frame_id, true);
+  replacer_->Remove(frame_id);
+  page.page_id_ = INVALID_PAGE_ID;
+  if (!page.is_dirty_) {
+    return true;
+  }
+
+  // Write the page back like an eviction would, so that fetchers of the page wait for it instead of reading a stale
+  // copy from disk.
+  page.is_dirty_ = false;
+  writing_back_.emplace(page_id, frame_id);
+  io.in_progress_ = true;
+  lock->unlock();
+  try {
+    WritePageData(page_id, page.GetData());
+  } catch (...) {
+    lock->lock();
+    FinishIo(frame_id, page_id);
+    throw;
+  }
+  lock->lock();
+  FinishIo(frame_id, page_id);
   return true;
 }
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManagerInstance::AllocatePage(bool *recycled) -> page_id_t {
+  // Fill the holes left by deleted pages before growing the file.
+  auto page_id = disk_manager_->AllocateFreePage(num_instances_, instance_index_);
+  *recycled = page_id != INVALID_PAGE_ID;
+  if (!*recycled) {
+    // Past the default tablespace, the ids belong to the other tablespaces.
+    if (static_cast<size_t>(next_page_id_) >= TABLESPACE_MAX_PAGES) {
+      return INVALID_PAGE_ID;
+    }
+    page_id = next_page_id_.fetch_add(static_cast<page_id_t>(num_instances_));
+  } else if (page_id >= next_page_id_) {
+    next_page_id_ = page_id + static_cast<page_id_t>(num_instances_);
+  }
+  ValidatePageId(page_id);
+  return page_id;
+}
+
+void BufferPoolManagerInstance::ReturnPage(page_id_t page_id, bool recycled) {
+  // DropStaleCopy() may have let another thread allocate a page since, the id is then kept in the free page map.
+  if (!recycled && next_page_id_ == page_id + static_cast<page_id_t>(num_instances_)) {
+    next_page_id_ = page_id;
+  } else {
+    DeallocatePage(page_id);
+  }
+}
+
+auto BufferPoolManagerInstance::FirstUnusedPageId(DiskManager *disk_manager, uint32_t num_instances,
+                                                  uint32_t instance_index) -> page_id_t {
+  auto num_pages = static_cast<uint32_t>(disk_manager->GetNumPages());
+  auto first = num_pages - num_pages % num_instances + instance_index;
+  return static_cast<page_id_t>(first < num_pages ? first + num_instances : first);
+}
+
+auto BufferPoolManagerInstance::IsAllocated(page_id_t page_id) const -> bool {
+  if (page_id < 0) {
+    return false;
+  }
+  auto tablespace = DiskManager::TablespaceOf(page_id);
+  if (tablespace == DEFAULT_TABLESPACE) {
+    return page_id < next_page_id_;
+  }
+  return page_id < disk_manager_->GetTablespaceEnd(tablespace);
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  // allocated pages mod back to this BPI
+  BUSTUB_ASSERT(page_id % num_instances_ == instance_index_, "page is routed to the wrong buffer pool instance");
+}
 
 }  // namespace bustub
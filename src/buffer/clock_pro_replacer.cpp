@@ -0,0 +1,303 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer.cpp
+//
+// Identification: src/buffer/clock_pro_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/clock_pro_replacer.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ClockProReplacer::ClockProReplacer(size_t num_frames)
+    : replacer_size_(num_frames),
+      cold_target_(std::max<size_t>(1, num_frames / 4)),
+      hand_hot_(clock_.end()),
+      hand_cold_(clock_.end()),
+      hand_test_(clock_.end()) {}
+
+auto ClockProReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (evictable_count_ == 0) {
+    return false;
+  }
+  while (true) {
+    if (cold_evictable_count_ == 0) {
+      // Every evictable page is hot: demote some of them.
+      RunHandHot();
+      continue;
+    }
+    auto it = hand_cold_;
+    hand_cold_ = Next(it);
+    auto &entry = *it;
+    if (entry.hot_ || !entry.resident_ || !entry.evictable_) {
+      continue;
+    }
+    if (entry.referenced_) {
+      entry.referenced_ = false;
+      if (entry.in_test_) {
+        // Reused within its test period: the page has a small reuse distance.
+        entry.hot_ = true;
+        entry.in_test_ = false;
+        hot_count_++;
+        cold_evictable_count_--;
+        MoveToHead(it);
+        BalanceHot();
+      } else {
+        entry.in_test_ = true;
+        MoveToHead(it);
+      }
+      continue;
+    }
+
+    *frame_id = entry.frame_id_;
+    resident_.erase(entry.frame_id_);
+    evictable_count_--;
+    cold_evictable_count_--;
+    if (entry.in_test_ && entry.page_id_ != INVALID_PAGE_ID) {
+      // Keep the entry until its test period ends, to notice if the page comes back quickly.
+      entry.resident_ = false;
+      non_resident_[entry.page_id_] = it;
+      while (non_resident_.size() > replacer_size_) {
+        RunHandTest();
+      }
+    } else {
+      Erase(it);
+    }
+    return true;
+  }
+}
+
+void ClockProReplacer::RecordAccess(frame_id_t frame_id) { RecordAccess(frame_id, INVALID_PAGE_ID); }
+
+void ClockProReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = resident_.find(frame_id);
+  if (it != resident_.end()) {
+    it->second->referenced_ = true;
+    return;
+  }
+
+  BUSTUB_ENSURE(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "frame id is invalid");
+  ClockEntry entry;
+  entry.page_id_ = page_id;
+  entry.frame_id_ = frame_id;
+  auto non_resident = page_id == INVALID_PAGE_ID ? non_resident_.end() : non_resident_.find(page_id);
+  if (non_resident != non_resident_.end()) {
+    // The page came back during its test period, it would have been a hit with more room for cold pages.
+    cold_target_ = std::min(cold_target_ + 1, MaxColdTarget());
+    Erase(non_resident->second);
+    non_resident_.erase(non_resident);
+    entry.hot_ = true;
+    hot_count_++;
+  } else {
+    entry.in_test_ = true;
+    cold_evictable_count_++;
+  }
+  evictable_count_++;
+  resident_[frame_id] = InsertAtHead(entry);
+  if (entry.hot_) {
+    BalanceHot();
+  }
+}
+
+void ClockProReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = resident_.find(frame_id);
+  if (it == resident_.end() || it->second->evictable_ == set_evictable) {
+    return;
+  }
+  auto &entry = *it->second;
+  if (set_evictable) {
+    evictable_count_++;
+    cold_evictable_count_ += entry.hot_ ? 0 : 1;
+  } else {
+    evictable_count_--;
+    cold_evictable_count_ -= entry.hot_ ? 0 : 1;
+  }
+  entry.evictable_ = set_evictable;
+}
+
+void ClockProReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = resident_.find(frame_id);
+  if (it == resident_.end()) {
+    return;
+  }
+  BUSTUB_ENSURE(it->second->evictable_, "frame not evictable, can't remove!");
+  Untrack(it->second);
+}
+
+auto ClockProReplacer::EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> frames;
+  if (clock_.empty()) {
+    return frames;
+  }
+  // A guess: unreferenced cold pages from HAND_cold on, then the referenced ones that stay cold, then the hot pages and
+  // the cold pages about to be promoted, from HAND_hot on, which would have to be demoted first.
+  auto collect = [&](ClockIterator start, auto &&wanted) {
+    auto it = start;
+    do {
+      if (frames.size() >= max_frames) {
+        return;
+      }
+      if (it->resident_ && it->evictable_ && wanted(*it)) {
+        frames.push_back(it->frame_id_);
+      }
+      it = Next(it);
+    } while (it != start);
+  };
+  collect(hand_cold_, [](const ClockEntry &e) { return !e.hot_ && !e.referenced_; });
+  collect(hand_cold_, [](const ClockEntry &e) { return !e.hot_ && e.referenced_ && !e.in_test_; });
+  collect(hand_hot_, [](const ClockEntry &e) { return e.hot_ || (e.referenced_ && e.in_test_); });
+  return frames;
+}
+
+void ClockProReplacer::Resize(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (auto it = resident_.begin(); it != resident_.end();) {
+    auto next = std::next(it);
+    if (static_cast<size_t>(it->first) >= num_frames) {
+      Untrack(it->second);
+    }
+    it = next;
+  }
+  replacer_size_ = num_frames;
+  cold_target_ = std::clamp<size_t>(cold_target_, 1, MaxColdTarget());
+  while (non_resident_.size() > replacer_size_) {
+    RunHandTest();
+  }
+  BalanceHot();
+}
+
+auto ClockProReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return evictable_count_;
+}
+
+auto ClockProReplacer::GetColdTarget() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return cold_target_;
+}
+
+auto ClockProReplacer::Next(ClockIterator it) -> ClockIterator {
+  ++it;
+  return it == clock_.end() ? clock_.begin() : it;
+}
+
+auto ClockProReplacer::InsertAtHead(const ClockEntry &entry) -> ClockIterator {
+  if (clock_.empty()) {
+    auto it = clock_.insert(clock_.end(), entry);
+    hand_hot_ = hand_cold_ = hand_test_ = it;
+    return it;
+  }
+  // HAND_hot points at the oldest entry, so the head is right behind it.
+  return clock_.insert(hand_hot_, entry);
+}
+
+void ClockProReplacer::MoveToHead(ClockIterator it) {
+  auto next = Next(it);
+  if (next == it) {
+    return;
+  }
+  for (auto *hand : {&hand_hot_, &hand_cold_, &hand_test_}) {
+    if (*hand == it) {
+      *hand = next;
+    }
+  }
+  clock_.splice(hand_hot_, clock_, it);
+}
+
+void ClockProReplacer::Erase(ClockIterator it) {
+  auto next = Next(it);
+  for (auto *hand : {&hand_hot_, &hand_cold_, &hand_test_}) {
+    if (*hand == it) {
+      *hand = next == it ? clock_.end() : next;
+    }
+  }
+  clock_.erase(it);
+}
+
+void ClockProReplacer::Untrack(ClockIterator it) {
+  auto &entry = *it;
+  if (entry.hot_) {
+    hot_count_--;
+  }
+  if (entry.evictable_) {
+    evictable_count_--;
+    cold_evictable_count_ -= entry.hot_ ? 0 : 1;
+  }
+  resident_.erase(entry.frame_id_);
+  Erase(it);
+}
+
+void ClockProReplacer::RunHandHot() {
+  if (hot_count_ == 0) {
+    return;
+  }
+  while (true) {
+    auto it = hand_hot_;
+    hand_hot_ = Next(it);
+    auto &entry = *it;
+    if (entry.hot_) {
+      if (entry.referenced_) {
+        entry.referenced_ = false;
+        continue;
+      }
+      entry.hot_ = false;
+      hot_count_--;
+      cold_evictable_count_ += entry.evictable_ ? 1 : 0;
+      return;
+    }
+    // HAND_hot passing a cold page ends its test period.
+    if (!entry.resident_) {
+      non_resident_.erase(entry.page_id_);
+      Erase(it);
+      cold_target_ = std::max<size_t>(1, cold_target_ - 1);
+    } else if (entry.in_test_) {
+      entry.in_test_ = false;
+      cold_target_ = std::max<size_t>(1, cold_target_ - 1);
+    }
+  }
+}
+
+void ClockProReplacer::RunHandTest() {
+  if (non_resident_.empty()) {
+    return;
+  }
+  while (true) {
+    auto it = hand_test_;
+    hand_test_ = Next(it);
+    auto &entry = *it;
+    if (entry.hot_ || !entry.in_test_) {
+      continue;
+    }
+    // The test period ended without the page being reused.
+    cold_target_ = std::max<size_t>(1, cold_target_ - 1);
+    if (!entry.resident_) {
+      non_resident_.erase(entry.page_id_);
+      Erase(it);
+      return;
+    }
+    entry.in_test_ = false;
+  }
+}
+
+void ClockProReplacer::BalanceHot() {
+  auto max_hot = replacer_size_ > cold_target_ ? replacer_size_ - cold_target_ : 0;
+  while (hot_count_ > max_hot) {
+    RunHandHot();
+  }
+}
+
+}  // namespace bustub
@@ -12,18 +12,121 @@
 
 #include "buffer/clock_replacer.h"
 
+#include "common/macros.h"
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : frames_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+  // Two rounds are enough: the first one clears every reference bit it passes.
+  while (true) {
+    auto &entry = frames_[hand_];
+    auto current = hand_;
+    hand_ = (hand_ + 1) % frames_.size();
+    if (!entry.tracked_ || !entry.evictable_) {
+      continue;
+    }
+    if (entry.referenced_) {
+      entry.referenced_ = false;
+      continue;
+    }
+    entry = FrameEntry{};
+    curr_size_--;
+    *frame_id = static_cast<frame_id_t>(current);
+    return true;
+  }
+}
+
+void ClockReplacer::RecordAccess(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ENSURE(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size(), "frame id is invalid");
+  auto &entry = frames_[frame_id];
+  if (!entry.tracked_) {
+    entry.tracked_ = true;
+    entry.evictable_ = true;
+    curr_size_++;
+  }
+  entry.referenced_ = true;
+}
+
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= frames_.size()) {
+    return;
+  }
+  auto &entry = frames_[frame_id];
+  if (!entry.tracked_ || entry.evictable_ == set_evictable) {
+    return;
+  }
+  entry.evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= frames_.size() || !frames_[frame_id].tracked_) {
+    return;
+  }
+  BUSTUB_ENSURE(frames_[frame_id].evictable_, "frame not evictable, can't remove!");
+  frames_[frame_id] = FrameEntry{};
+  curr_size_--;
+}
+
+auto ClockReplacer::EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // The first sweep evicts the frames whose bit is clear, in hand order; the second one takes the rest.
+  std::vector<frame_id_t> frames;
+  for (bool referenced : {false, true}) {
+    for (size_t i = 0; i < frames_.size() && frames.size() < max_frames; i++) {
+      auto index = (hand_ + i) % frames_.size();
+      const auto &entry = frames_[index];
+      if (entry.tracked_ && entry.evictable_ && entry.referenced_ == referenced) {
+        frames.push_back(static_cast<frame_id_t>(index));
+      }
+    }
+  }
+  return frames;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Resize(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (size_t i = num_frames; i < frames_.size(); i++) {
+    if (frames_[i].tracked_ && frames_[i].evictable_) {
+      curr_size_--;
+    }
+  }
+  frames_.resize(num_frames);
+  if (hand_ >= num_frames) {
+    hand_ = 0;
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+auto ClockReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size() && frames_[frame_id].tracked_ &&
+        frames_[frame_id].evictable_) {
+      return;
+    }
+  }
+  RecordAccess(frame_id);
+  SetEvictable(frame_id, true);
+}
 
 }  // namespace bustub
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "buffer/page_codec.h"
+#include "common/exception.h"
+
+namespace bustub {
+
+CompressedPageCache::CompressedPageCache(size_t memory_budget, size_t max_compressed_size)
+    : max_compressed_size_(std::min(max_compressed_size, memory_budget)) {
+  stats_.memory_budget_ = memory_budget;
+}
+
+auto CompressedPageCache::Insert(page_id_t page_id, const char *page_data) -> bool {
+  // Compress before taking the latch, it is by far the most expensive part.
+  std::string compressed;
+  PageCodec::Compress(page_data, BUSTUB_PAGE_SIZE, &compressed);
+  compressed.shrink_to_fit();
+
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (auto it = entries_.find(page_id); it != entries_.end()) {
+    EraseLocked(it);
+  }
+  if (compressed.size() > max_compressed_size_) {
+    stats_.rejections_++;
+    return false;
+  }
+  while (stats_.bytes_used_ + compressed.size() > stats_.memory_budget_) {
+    EraseLocked(entries_.find(lru_.front()));
+    stats_.evictions_++;
+  }
+  stats_.bytes_used_ += compressed.size();
+  stats_.num_pages_++;
+  stats_.insertions_++;
+  lru_.push_back(page_id);
+  entries_.emplace(page_id, Entry{std::move(compressed), std::prev(lru_.end())});
+  return true;
+}
+
+auto CompressedPageCache::Take(page_id_t page_id, char *page_data) -> bool {
+  std::string compressed;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    auto it = entries_.find(page_id);
+    if (it == entries_.end()) {
+      stats_.misses_++;
+      return false;
+    }
+    stats_.hits_++;
+    compressed = EraseLocked(it);
+  }
+  if (!PageCodec::Decompress(compressed.data(), compressed.size(), page_data, BUSTUB_PAGE_SIZE)) {
+    throw Exception(ExceptionType::INVALID, "corrupt page in the compressed page cache");
+  }
+  return true;
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (auto it = entries_.find(page_id); it != entries_.end()) {
+    EraseLocked(it);
+  }
+}
+
+auto CompressedPageCache::GetStats() -> CompressedPageCacheStats {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return stats_;
+}
+
+auto CompressedPageCache::EraseLocked(std::unordered_map<page_id_t, Entry>::iterator it) -> std::string {
+  auto data = std::move(it->second.data_);
+  stats_.bytes_used_ -= data.size();
+  stats_.num_pages_--;
+  lru_.erase(it->second.position_);
+  entries_.erase(it);
+  return data;
+}
+
+}  // namespace bustub
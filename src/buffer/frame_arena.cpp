@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <cstdint>
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames, size_t max_frames) : max_frames_(max_frames) {
+  BUSTUB_ASSERT(num_frames <= max_frames, "FrameArena can't hold more than max_frames frames");
+  auto size = max_frames_ * BUSTUB_PAGE_SIZE;
+  // Only arenas that can hold at least one huge page are worth aligning to one.
+  size_t alignment = size >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : BUSTUB_PAGE_SIZE;
+  // mmap() only guarantees alignment to the OS page size, so over-allocate and align the frames inside the mapping.
+  // The address space is only reserved here, Resize() makes the frames in use accessible.
+  mapping_size_ = size + alignment;
+  mapping_ = mmap(nullptr, mapping_size_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mapping_ == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  auto address = reinterpret_cast<uintptr_t>(mapping_);
+  data_ = reinterpret_cast<char *>((address + alignment - 1) / alignment * alignment);
+
+  Resize(num_frames);
+}
+
+FrameArena::~FrameArena() { munmap(mapping_, mapping_size_); }
+
+void FrameArena::Resize(size_t num_frames) {
+  BUSTUB_ASSERT(num_frames <= max_frames_, "FrameArena can't grow beyond max_frames frames");
+  if (num_frames > num_frames_) {
+    auto size = num_frames * BUSTUB_PAGE_SIZE;
+    if (mprotect(data_, size, PROT_READ | PROT_WRITE) != 0) {
+      throw std::bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    if (size >= HUGE_PAGE_SIZE && enable_huge_pages) {
+      // Best effort: the kernel may not support transparent huge pages, in which case the arena uses regular pages.
+      // Small pools are left alone, a huge page would mostly hold frames they don't have.
+      huge_pages_ = madvise(data_, size / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE, MADV_HUGEPAGE) == 0;
+    }
+#endif
+  } else if (num_frames < num_frames_) {
+    auto *first = GetFrameData(static_cast<frame_id_t>(num_frames));
+    auto length = (num_frames_ - num_frames) * BUSTUB_PAGE_SIZE;
+    // Drop the pages, so that the memory goes back to the OS and the frames read as zeros when they come back.
+    madvise(first, length, MADV_DONTNEED);
+    mprotect(first, length, PROT_NONE);
+  }
+  num_frames_ = num_frames;
+}
+
+}  // namespace bustub
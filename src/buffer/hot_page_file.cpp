@@ -0,0 +1,40 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hot_page_file.cpp
+//
+// Identification: src/buffer/hot_page_file.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/hot_page_file.h"
+
+#include "storage/disk/page_id_file.h"
+
+namespace bustub {
+
+namespace {
+
+constexpr char HOT_PAGE_FILE_MAGIC[8] = "BTHOTPG";
+constexpr uint32_t HOT_PAGE_FILE_VERSION = 1;
+
+}  // namespace
+
+auto HotPageFile::Write(const std::string &file_name, const std::vector<page_id_t> &page_ids) -> bool {
+  return PageIdFile::Write(file_name, HOT_PAGE_FILE_MAGIC, HOT_PAGE_FILE_VERSION, page_ids);
+}
+
+auto HotPageFile::Read(const std::string &file_name) -> std::optional<std::vector<page_id_t>> {
+  return PageIdFile::Read(file_name, HOT_PAGE_FILE_MAGIC, HOT_PAGE_FILE_VERSION);
+}
+
+auto HotPageFile::FileNameFor(const std::string &db_file_name) -> std::string {
+  // Like the log file, the hot page file replaces the extension of the database file.
+  auto n = db_file_name.rfind('.');
+  return (n == std::string::npos ? db_file_name : db_file_name.substr(0, n)) + ".hot";
+}
+
+}  // namespace bustub
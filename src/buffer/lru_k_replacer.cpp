@@ -11,130 +11,142 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/lru_k_replacer.h"
-#include <algorithm>
-#include "common/logger.h"
 
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {}
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {
+  BUSTUB_ASSERT(k > 0, "lookback constant k must be positive");
+}
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
   std::scoped_lock<std::mutex> lock(latch_);
-  std::vector<frame_id_t> inf_frames;
-  size_t evict_frame_time = __INT_MAX__;
-  frame_id_t evict_frame_id = __INT_MAX__;
-
-  for (auto f : id_to_frames_) {
-    if (f.second.evictable_) {
-      if (f.second.k_value_ == __INT_MAX__) {
-        inf_frames.push_back(f.first);
-      }
-      if (evict_frame_time > f.second.timestamps_.front()) {
-        evict_frame_time = f.second.timestamps_.front();
-        evict_frame_id = f.first;
-      }
-    }
-  }
-  if (inf_frames.size() == 1) {
-    *frame_id = inf_frames[0];
-    // LOG_INFO("# [Evict]There is only one inf frame %d, now evict it", *frame_id);
-    // id_to_frames_[inf_frames[0]].evictable = false;
-    id_to_frames_.erase(inf_frames[0]);
-    // curr_size_--;
-  } else if (inf_frames.size() > 1) {
-    size_t earliest_time = __INT_MAX__;
-    frame_id_t earliest_time_id = inf_frames[0];
-    for (auto i : inf_frames) {
-      if (earliest_time > id_to_frames_[i].timestamps_.front()) {
-        earliest_time_id = i;
-        earliest_time = id_to_frames_[i].timestamps_.front();
-      }
-    }
-    *frame_id = earliest_time_id;
-    // LOG_INFO("# [Evict]There are many inf frames, now evict the oldest one with id:%d", *frame_id);
-    // id_to_frames_[*frame_id].evictable = false;
-    id_to_frames_.erase(*frame_id);
-    // curr_size_--;
-  } else if (evict_frame_id != __INT_MAX__) {
-    *frame_id = evict_frame_id;
-    // LOG_INFO("# [Evict]There is no inf frame, now evict the largest k-distance frame with id:%d", *frame_id);
-    // id_to_frames_[*frame_id].evictable = false;
-    id_to_frames_.erase(*frame_id);
-    // curr_size_--;
-  } else {
+  // Frames with +inf backward k-distance go first, earliest access first. Otherwise pick the frame whose k-th most
+  // recent access is the oldest, which is the one with the largest backward k-distance.
+  auto &frames = history_frames_.empty() ? cache_frames_ : history_frames_;
+  if (frames.empty()) {
     return false;
   }
-
+  *frame_id = frames.begin()->second;
+  frames.erase(frames.begin());
+  id_to_frames_.erase(*frame_id);
+  curr_size_--;
   return true;
 }
 
 void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
   std::scoped_lock<std::mutex> lock(latch_);
-  current_timestamp_++;
+  RecordAccessLocked(frame_id);
+}
 
-  if (id_to_frames_.find(frame_id) == id_to_frames_.end()) {
-    // LOG_INFO("# [RecordAccess]No frame %d, now make one new entry for it", frame_id);
+void LRUKReplacer::RecordAccessLocked(frame_id_t frame_id) {
+  current_timestamp_++;
 
-    if (static_cast<int>(replacer_size_) < frame_id) {
+  auto it = id_to_frames_.find(frame_id);
+  if (it == id_to_frames_.end()) {
+    if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
       throw "frame id is INVALID";
     }
-    std::queue<size_t> time_queue({current_timestamp_});
-    struct Frame curr_frame = {true, time_queue, __INT_MAX__};
-    id_to_frames_.emplace(frame_id, curr_frame);
-    // curr_size_++;
-    // LOG_DEBUG("# [RecordAccess]Frame %d's timestamps_nums is %lu", frame_id,
-    // id_to_frames_[frame_id].timestamps_.size());
-  } else if (id_to_frames_[frame_id].timestamps_.size() < k_ - 1) {
-    // LOG_DEBUG("# [RecordAccess]Frame %d's timestamps_nums less than k-1", frame_id);
-    id_to_frames_[frame_id].timestamps_.push(current_timestamp_);
-  } else if (id_to_frames_[frame_id].timestamps_.size() == k_ - 1) {
-    // LOG_DEBUG("# [RecordAccess]Frame %d's timestamps_nums is k-1", frame_id);
-    id_to_frames_[frame_id].timestamps_.push(current_timestamp_);
-    id_to_frames_[frame_id].k_value_ = id_to_frames_[frame_id].timestamps_.front();
-  } else {
-    // LOG_DEBUG("# [RecordAccess]Frame %d's timestamps_nums is k", frame_id);
-    id_to_frames_[frame_id].timestamps_.pop();
-    id_to_frames_[frame_id].timestamps_.push(current_timestamp_);
-    id_to_frames_[frame_id].k_value_ = id_to_frames_[frame_id].timestamps_.front();
+    // A new frame starts out evictable, as it did before it was tracked.
+    auto &entry = id_to_frames_[frame_id];
+    entry.history_.push_back(current_timestamp_);
+    Link(frame_id, entry);
+    curr_size_++;
+    return;
+  }
+
+  auto &entry = it->second;
+  if (entry.evictable_) {
+    Unlink(frame_id, entry);
+  }
+  entry.history_.push_back(current_timestamp_);
+  if (entry.history_.size() > k_) {
+    entry.history_.pop_front();
+  }
+  if (entry.evictable_) {
+    Link(frame_id, entry);
   }
-  // LOG_INFO("# [RecordAccess]Frame %d got one new record at %ld", frame_id, current_timestamp_);
 }
 
 void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
   std::scoped_lock<std::mutex> lock(latch_);
-  if (id_to_frames_.find(frame_id) == id_to_frames_.end()) {
-    // LOG_INFO("# [SetEvictable]No frame %d", frame_id);
+  SetEvictableLocked(frame_id, set_evictable);
+}
+
+void LRUKReplacer::SetEvictableLocked(frame_id_t frame_id, bool set_evictable) {
+  auto it = id_to_frames_.find(frame_id);
+  if (it == id_to_frames_.end() || it->second.evictable_ == set_evictable) {
     return;
   }
-  // LOG_INFO("# [SetEvictable]Set frame %d as %d", frame_id, set_evictable);
-  id_to_frames_[frame_id].evictable_ = set_evictable;
+  auto &entry = it->second;
+  if (set_evictable) {
+    Link(frame_id, entry);
+    curr_size_++;
+  } else {
+    Unlink(frame_id, entry);
+    curr_size_--;
+  }
+  entry.evictable_ = set_evictable;
+}
+
+void LRUKReplacer::PinFrames(const std::vector<std::pair<frame_id_t, page_id_t>> &frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (const auto &[frame_id, page_id] : frames) {
+    RecordAccessLocked(frame_id);
+    SetEvictableLocked(frame_id, false);
+  }
+}
+
+void LRUKReplacer::UnpinFrames(const std::vector<frame_id_t> &frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (auto frame_id : frames) {
+    SetEvictableLocked(frame_id, true);
+  }
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
   std::scoped_lock<std::mutex> lock(latch_);
-  if (id_to_frames_.find(frame_id) == id_to_frames_.end()) {
-    // LOG_INFO("# [Remove]Can't find the frame %d", frame_id);
+  auto it = id_to_frames_.find(frame_id);
+  if (it == id_to_frames_.end()) {
     return;
   }
-  if (!id_to_frames_[frame_id].evictable_) {
+  if (!it->second.evictable_) {
     throw "frame not evictable, can't remove!";
   }
-  // LOG_INFO("# [Remove]find the frame %d, now remove it!", frame_id);
-  id_to_frames_.erase(frame_id);
-  // curr_size_--;
+  Unlink(frame_id, it->second);
+  id_to_frames_.erase(it);
+  curr_size_--;
 }
 
-auto LRUKReplacer::Size() -> size_t {
+auto LRUKReplacer::EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> {
   std::scoped_lock<std::mutex> lock(latch_);
-  size_t count = 0;
-  for (auto const &frame : id_to_frames_) {
-    if (frame.second.evictable_) {
-      // LOG_INFO("# [Size]Now we have one %d with k-value %d", frame.first, frame.second.k_value_);
-      count++;
+  std::vector<frame_id_t> frames;
+  for (const auto *set : {&history_frames_, &cache_frames_}) {
+    for (auto it = set->begin(); it != set->end() && frames.size() < max_frames; ++it) {
+      frames.push_back(it->second);
     }
   }
-  // LOG_INFO("# [Size]Now size is %ld", count);
-  return count;
+  return frames;
+}
+
+void LRUKReplacer::Resize(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (auto it = id_to_frames_.begin(); it != id_to_frames_.end();) {
+    if (static_cast<size_t>(it->first) < num_frames) {
+      ++it;
+      continue;
+    }
+    if (it->second.evictable_) {
+      Unlink(it->first, it->second);
+      curr_size_--;
+    }
+    it = id_to_frames_.erase(it);
+  }
+  replacer_size_ = num_frames;
+}
+
+auto LRUKReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
 }
 
 }  // namespace bustub
@@ -12,18 +12,104 @@
 
 #include "buffer/lru_replacer.h"
 
+#include "common/macros.h"
+
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages) : replacer_size_(num_pages) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto LRUReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (evictable_.empty()) {
+    return false;
+  }
+  *frame_id = evictable_.begin()->second;
+  evictable_.erase(evictable_.begin());
+  frames_.erase(*frame_id);
+  return true;
+}
+
+void LRUReplacer::RecordAccess(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ENSURE(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "frame id is invalid");
+  auto [it, inserted] = frames_.try_emplace(frame_id);
+  auto &entry = it->second;
+  if (!inserted && entry.evictable_) {
+    evictable_.erase({entry.last_access_, frame_id});
+  }
+  entry.last_access_ = ++current_timestamp_;
+  if (entry.evictable_) {
+    evictable_.emplace(entry.last_access_, frame_id);
+  }
+}
+
+void LRUReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end() || it->second.evictable_ == set_evictable) {
+    return;
+  }
+  auto &entry = it->second;
+  if (set_evictable) {
+    evictable_.emplace(entry.last_access_, frame_id);
+  } else {
+    evictable_.erase({entry.last_access_, frame_id});
+  }
+  entry.evictable_ = set_evictable;
+}
+
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    return;
+  }
+  BUSTUB_ENSURE(it->second.evictable_, "frame not evictable, can't remove!");
+  evictable_.erase({it->second.last_access_, frame_id});
+  frames_.erase(it);
+}
+
+auto LRUReplacer::EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> frames;
+  for (auto it = evictable_.begin(); it != evictable_.end() && frames.size() < max_frames; ++it) {
+    frames.push_back(it->second);
+  }
+  return frames;
+}
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+void LRUReplacer::Resize(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (auto it = frames_.begin(); it != frames_.end();) {
+    if (static_cast<size_t>(it->first) < num_frames) {
+      ++it;
+      continue;
+    }
+    if (it->second.evictable_) {
+      evictable_.erase({it->second.last_access_, it->first});
+    }
+    it = frames_.erase(it);
+  }
+  replacer_size_ = num_frames;
+}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+auto LRUReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return evictable_.size();
+}
 
-auto LRUReplacer::Size() -> size_t { return 0; }
+void LRUReplacer::Unpin(frame_id_t frame_id) {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    auto it = frames_.find(frame_id);
+    if (it != frames_.end() && it->second.evictable_) {
+      return;
+    }
+  }
+  RecordAccess(frame_id);
+  SetEvictable(frame_id, true);
+}
 
 }  // namespace bustub
@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_codec.cpp
+//
+// Identification: src/buffer/page_codec.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+auto Load32(const char *p) -> uint32_t {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+void EmitLiterals(const char *src, size_t size, size_t max_literals, std::string *dst) {
+  while (size > 0) {
+    auto run = std::min(size, max_literals);
+    dst->push_back(static_cast<char>(run - 1));
+    dst->append(src, run);
+    src += run;
+    size -= run;
+  }
+}
+
+}  // namespace
+
+void PageCodec::Compress(const char *src, size_t size, std::string *dst) {
+  dst->clear();
+  dst->reserve(size);
+  // Last position seen for each hash of 4 bytes. Positions are stored plus one, so that 0 means empty.
+  std::array<uint32_t, 1 << HASH_BITS> last_position{};
+  size_t pos = 0;
+  size_t literal_start = 0;
+  while (pos + MIN_MATCH <= size) {
+    auto sequence = Load32(src + pos);
+    auto hash = (sequence * 2654435761U) >> (32 - HASH_BITS);
+    size_t candidate = last_position[hash];
+    last_position[hash] = static_cast<uint32_t>(pos + 1);
+    if (candidate == 0 || pos - (candidate - 1) > MAX_DISTANCE || Load32(src + candidate - 1) != sequence) {
+      pos++;
+      continue;
+    }
+    candidate--;
+    size_t length = MIN_MATCH;
+    while (pos + length < size && length < MAX_MATCH && src[candidate + length] == src[pos + length]) {
+      length++;
+    }
+    EmitLiterals(src + literal_start, pos - literal_start, MAX_LITERALS, dst);
+    auto distance = pos - candidate;
+    dst->push_back(static_cast<char>(0x80 | (length - MIN_MATCH)));
+    dst->push_back(static_cast<char>(distance & 0xff));
+    dst->push_back(static_cast<char>(distance >> 8));
+    pos += length;
+    literal_start = pos;
+  }
+  EmitLiterals(src + literal_start, size - literal_start, MAX_LITERALS, dst);
+}
+
+auto PageCodec::Decompress(const char *src, size_t src_size, char *dst, size_t size) -> bool {
+  size_t in = 0;
+  size_t out = 0;
+  while (in < src_size) {
+    auto token = static_cast<uint8_t>(src[in++]);
+    if ((token & 0x80) == 0) {
+      size_t run = token + 1;
+      if (in + run > src_size || out + run > size) {
+        return false;
+      }
+      memcpy(dst + out, src + in, run);
+      in += run;
+      out += run;
+      continue;
+    }
+    size_t length = (token & 0x7f) + MIN_MATCH;
+    if (in + 2 > src_size) {
+      return false;
+    }
+    size_t distance = static_cast<uint8_t>(src[in]) | (static_cast<size_t>(static_cast<uint8_t>(src[in + 1])) << 8);
+    in += 2;
+    if (distance == 0 || distance > out || out + length > size) {
+      return false;
+    }
+    // The match may overlap the bytes it produces, so copy byte by byte.
+    for (size_t i = 0; i < length; i++, out++) {
+      dst[out] = dst[out - distance];
+    }
+  }
+  return out == size;
+}
+
+}  // namespace bustub
@@ -0,0 +1,308 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+#include <tuple>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     size_t replacer_k, LogManager *log_manager,
+                                                     ReplacerPolicy replacer_policy)
+    : num_instances_(num_instances), pool_size_(pool_size) {
+  BUSTUB_ASSERT(num_instances > 0, "parallel buffer pool needs at least one instance");
+  instances_.reserve(num_instances_);
+  for (size_t i = 0; i < num_instances_; i++) {
+    instances_.push_back(new BufferPoolManagerInstance(pool_size_, static_cast<uint32_t>(num_instances_),
+                                                       static_cast<uint32_t>(i), disk_manager, replacer_k,
+                                                       log_manager, replacer_policy));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto *instance : instances_) {
+    delete instance;
+  }
+}
+
+auto ParallelBufferPoolManager::GetPoolSize() -> size_t { return num_instances_ * pool_size_; }
+
+void ParallelBufferPoolManager::StartBackgroundFlusher(double target_clean_ratio, size_t pages_per_second) {
+  // Each instance flushes its share of the write rate.
+  auto instance_rate = std::max<size_t>(1, pages_per_second / num_instances_);
+  for (auto *instance : instances_) {
+    instance->StartBackgroundFlusher(target_clean_ratio, instance_rate);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundFlusher() {
+  for (auto *instance : instances_) {
+    instance->StopBackgroundFlusher();
+  }
+}
+
+void ParallelBufferPoolManager::SetCompressedCache(const std::shared_ptr<CompressedPageCache> &cache) {
+  for (auto *instance : instances_) {
+    instance->SetCompressedCache(cache);
+  }
+}
+
+void ParallelBufferPoolManager::SetDiskScheduler(const std::shared_ptr<DiskScheduler> &scheduler) {
+  for (auto *instance : instances_) {
+    instance->SetDiskScheduler(scheduler);
+  }
+}
+
+void ParallelBufferPoolManager::WaitForWarmUp() {
+  for (auto *instance : instances_) {
+    instance->WaitForWarmUp();
+  }
+}
+
+auto ParallelBufferPoolManager::GetWarmUpCount() const -> size_t {
+  size_t count = 0;
+  for (auto *instance : instances_) {
+    count += instance->GetWarmUpCount();
+  }
+  return count;
+}
+
+auto ParallelBufferPoolManager::GetSyncWriteBackCount() const -> size_t {
+  size_t count = 0;
+  for (auto *instance : instances_) {
+    count += instance->GetSyncWriteBackCount();
+  }
+  return count;
+}
+
+auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance * {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "INVALID_PAGE_ID is not owned by any instance");
+  return instances_[static_cast<size_t>(page_id) % num_instances_];
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * { return FetchPgImp(page_id, nullptr); }
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  auto *instance = GetBufferPoolManager(page_id);
+  return strategy == nullptr ? instance->FetchPage(page_id) : instance->FetchPage(page_id, *strategy);
+}
+
+auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+auto ParallelBufferPoolManager::FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> {
+  // positions[i] are the indexes in page_ids of the pages owned by instance i.
+  std::vector<std::vector<page_id_t>> batches(num_instances_);
+  std::vector<std::vector<size_t>> positions(num_instances_);
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    auto instance = static_cast<size_t>(page_ids[i]) % num_instances_;
+    batches[instance].push_back(page_ids[i]);
+    positions[instance].push_back(i);
+  }
+  std::vector<Page *> pages(page_ids.size());
+  for (size_t i = 0; i < num_instances_; i++) {
+    if (batches[i].empty()) {
+      continue;
+    }
+    auto fetched = instances_[i]->FetchPages(batches[i]);
+    if (fetched.empty()) {
+      // Unpin what the previous instances fetched.
+      for (size_t j = 0; j < i; j++) {
+        if (!batches[j].empty()) {
+          instances_[j]->UnpinPages(batches[j], false);
+        }
+      }
+      return {};
+    }
+    for (size_t j = 0; j < fetched.size(); j++) {
+      pages[positions[i][j]] = fetched[j];
+    }
+  }
+  return pages;
+}
+
+auto ParallelBufferPoolManager::UnpinPgsImp(const std::vector<page_id_t> &page_ids, bool is_dirty) -> bool {
+  std::vector<std::vector<page_id_t>> batches(num_instances_);
+  for (auto page_id : page_ids) {
+    batches[static_cast<size_t>(page_id) % num_instances_].push_back(page_id);
+  }
+  bool all_unpinned = true;
+  for (size_t i = 0; i < num_instances_; i++) {
+    if (!batches[i].empty()) {
+      all_unpinned = instances_[i]->UnpinPages(batches[i], is_dirty) && all_unpinned;
+    }
+  }
+  return all_unpinned;
+}
+
+auto ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * { return NewPgImp(page_id, nullptr); }
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) -> Page * {
+  // Start from a different instance on every call so that allocations are spread evenly, and fall through to the
+  // following instances when the starting one has every frame pinned.
+  size_t start = next_instance_.fetch_add(1) % num_instances_;
+  for (size_t i = 0; i < num_instances_; i++) {
+    auto *instance = instances_[(start + i) % num_instances_];
+    auto *page = strategy == nullptr ? instance->NewPage(page_id) : instance->NewPage(page_id, *strategy);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::AllocateExtentImp(tablespace_id_t tablespace, size_t num_pages) -> page_id_t {
+  if (tablespace != DEFAULT_TABLESPACE) {
+    return instances_[0]->AllocateExtentImp(tablespace, num_pages);
+  }
+  std::vector<std::unique_lock<std::mutex>> locks;
+  locks.reserve(num_instances_);
+  for (auto *instance : instances_) {
+    locks.emplace_back(instance->latch_);
+  }
+  // The range starts right after the highest id handed out by any instance, i.e. the next id of an instance minus
+  // the stride.
+  page_id_t first_page_id = 0;
+  for (auto *instance : instances_) {
+    first_page_id =
+        std::max<page_id_t>(first_page_id, instance->next_page_id_ - static_cast<page_id_t>(num_instances_) + 1);
+  }
+  auto end = static_cast<size_t>(first_page_id) + num_pages;
+  if (end > TABLESPACE_MAX_PAGES) {
+    return INVALID_PAGE_ID;
+  }
+  for (size_t i = 0; i < num_instances_; i++) {
+    // The first id of instance i at or past the end of the range.
+    auto next_page_id = end - end % num_instances_ + i;
+    instances_[i]->next_page_id_ = static_cast<page_id_t>(next_page_id < end ? next_page_id + num_instances_
+                                                                             : next_page_id);
+  }
+  return first_page_id;
+}
+
+auto ParallelBufferPoolManager::NewReservedPgImp(page_id_t page_id) -> Page * {
+  return GetBufferPoolManager(page_id)->NewReservedPgImp(page_id);
+}
+
+auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPgsImp() {
+  std::vector<BufferPoolManagerInstance::FlushList> frames(num_instances_);
+  // (page id, data, instance) of every page to write.
+  std::vector<std::tuple<page_id_t, char *, size_t>> pages;
+  for (size_t i = 0; i < num_instances_; i++) {
+    frames[i] = instances_[i]->CollectDirtyFrames();
+    for (const auto &[frame_id, page_id] : frames[i]) {
+      pages.emplace_back(page_id, instances_[i]->pages_[frame_id].GetData(), i);
+    }
+  }
+  if (pages.empty()) {
+    return;
+  }
+  std::sort(pages.begin(), pages.end());
+  std::vector<page_id_t> page_ids;
+  std::vector<char *> pages_data;
+  page_ids.reserve(pages.size());
+  pages_data.reserve(pages.size());
+  for (const auto &[page_id, data, instance] : pages) {
+    page_ids.push_back(page_id);
+    pages_data.push_back(data);
+  }
+
+  // The instances share the disk manager and the disk scheduler, so any of them can write the whole batch.
+  try {
+    instances_[0]->WritePagesData(page_ids, pages_data, DiskRequestPriority::FOREGROUND);
+  } catch (...) {
+    for (size_t i = 0; i < num_instances_; i++) {
+      instances_[i]->EndFlush(frames[i], false);
+    }
+    throw;
+  }
+  for (size_t i = 0; i < num_instances_; i++) {
+    instances_[i]->EndFlush(frames[i], true);
+  }
+}
+
+void ParallelBufferPoolManager::SyncAllPgsImp() {
+  FlushAllPgsImp();
+  instances_[0]->GetDiskManager()->Sync();
+}
+
+void ParallelBufferPoolManager::PrefetchPgsImp(page_id_t first_page_id, size_t num_pages) {
+  for (size_t i = 0; i < num_pages; i++) {
+    auto page_id = first_page_id + static_cast<page_id_t>(i);
+    if (page_id != INVALID_PAGE_ID) {
+      GetBufferPoolManager(page_id)->PrefetchPage(page_id);
+    }
+  }
+}
+
+auto ParallelBufferPoolManager::HotPagesImp() -> std::vector<page_id_t> {
+  std::vector<std::vector<page_id_t>> instance_pages;
+  size_t num_pages = 0;
+  for (auto *instance : instances_) {
+    instance_pages.push_back(instance->GetHotPages());
+    num_pages += instance_pages.back().size();
+  }
+  std::vector<page_id_t> page_ids;
+  page_ids.reserve(num_pages);
+  for (size_t rank = 0; page_ids.size() < num_pages; rank++) {
+    for (const auto &pages : instance_pages) {
+      if (rank < pages.size()) {
+        page_ids.push_back(pages[rank]);
+      }
+    }
+  }
+  return page_ids;
+}
+
+void ParallelBufferPoolManager::WarmUpImp(const std::vector<page_id_t> &page_ids) {
+  for (auto *instance : instances_) {
+    instance->WarmUp(page_ids);
+  }
+}
+
+auto ParallelBufferPoolManager::ResizeImp(size_t new_pool_size) -> bool {
+  auto instance_size = (new_pool_size + num_instances_ - 1) / num_instances_;
+  if (instance_size == 0 || instance_size > instances_[0]->GetMaxPoolSize()) {
+    return false;
+  }
+  for (auto *instance : instances_) {
+    instance->Resize(instance_size);
+  }
+  pool_size_ = instance_size;
+  return true;
+}
+
+void ParallelBufferPoolManager::SetAccessTraceImp(std::shared_ptr<AccessTraceWriter> trace) {
+  for (auto *instance : instances_) {
+    if (trace == nullptr) {
+      instance->StopAccessTrace();
+    } else {
+      instance->StartAccessTrace(trace);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,44 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead.cpp
+//
+// Identification: src/buffer/read_ahead.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_ahead.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+void ReadAhead::OnPageAccess(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID || bpm_ == nullptr) {
+    return;
+  }
+  bool sequential = last_page_id_ != INVALID_PAGE_ID && page_id == last_page_id_ + 1;
+  last_page_id_ = page_id;
+  if (!sequential) {
+    prefetched_until_ = INVALID_PAGE_ID;
+    return;
+  }
+
+  int window = read_ahead_window;
+  if (window <= 0) {
+    return;
+  }
+  auto start = std::max(prefetched_until_, page_id + 1);
+  // Only issue the next batch once half of the pages in flight have been consumed.
+  if (start - page_id > window / 2) {
+    return;
+  }
+  auto end = page_id + 1 + window;
+  bpm_->PrefetchRange(start, static_cast<size_t>(end - start));
+  prefetched_until_ = end;
+}
+
+}  // namespace bustub
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trace_replayer.cpp
+//
+// Identification: src/buffer/trace_replayer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/trace_replayer.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <numeric>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+TraceReplayer::TraceReplayer(ReplacerPolicy policy, size_t num_frames, size_t k)
+    : policy_(policy),
+      num_frames_(num_frames),
+      replacer_(MakeReplacer(policy, num_frames, k)),
+      frame_pages_(num_frames, INVALID_PAGE_ID) {
+  for (size_t i = 0; i < num_frames_; i++) {
+    free_list_.emplace_back(static_cast<frame_id_t>(i));
+  }
+}
+
+void TraceReplayer::Access(page_id_t page_id) {
+  auto start = std::chrono::steady_clock::now();
+  frame_id_t frame_id;
+  auto it = page_table_.find(page_id);
+  if (it != page_table_.end()) {
+    frame_id = it->second;
+    hits_++;
+  } else {
+    if (!free_list_.empty()) {
+      frame_id = free_list_.front();
+      free_list_.pop_front();
+    } else if (replacer_->Evict(&frame_id)) {
+      page_table_.erase(frame_pages_[frame_id]);
+    } else {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "replayed pool has no frame to evict");
+    }
+    frame_pages_[frame_id] = page_id;
+    page_table_.emplace(page_id, frame_id);
+  }
+  replacer_->RecordAccess(frame_id, page_id);
+  replacer_->SetEvictable(frame_id, false);
+  replacer_->SetEvictable(frame_id, true);
+  auto end = std::chrono::steady_clock::now();
+  latencies_ns_.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+void TraceReplayer::Delete(page_id_t page_id) {
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return;
+  }
+  replacer_->Remove(it->second);
+  frame_pages_[it->second] = INVALID_PAGE_ID;
+  free_list_.push_back(it->second);
+  page_table_.erase(it);
+}
+
+void TraceReplayer::Replay(const AccessTraceRecord &record) {
+  switch (record.type_) {
+    case AccessType::FETCH:
+    case AccessType::NEW:
+      Access(record.page_id_);
+      break;
+    case AccessType::DELETE:
+      Delete(record.page_id_);
+      break;
+    case AccessType::UNPIN:
+      break;
+  }
+}
+
+auto TraceReplayer::GetStats() const -> ReplayStats {
+  ReplayStats stats{policy_, num_frames_};
+  stats.accesses_ = latencies_ns_.size();
+  stats.hits_ = hits_;
+  if (latencies_ns_.empty()) {
+    return stats;
+  }
+  auto sorted = latencies_ns_;
+  std::sort(sorted.begin(), sorted.end());
+  stats.mean_latency_ns_ = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+  stats.p99_latency_ns_ = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+  stats.max_latency_ns_ = sorted.back();
+  return stats;
+}
+
+auto TraceReplayer::Replay(ReplacerPolicy policy, size_t num_frames, const std::vector<page_id_t> &trace, size_t k)
+    -> ReplayStats {
+  TraceReplayer replayer(policy, num_frames, k);
+  for (auto page_id : trace) {
+    replayer.Access(page_id);
+  }
+  return replayer.GetStats();
+}
+
+}  // namespace bustub
@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_frames) : replacer_size_(num_frames) { SetQueueSizes(); }
+
+void TwoQueueReplacer::SetQueueSizes() {
+  // The sizes the paper recommends: Kin = 25% and Kout = 50% of the frames.
+  kin_ = std::max<size_t>(1, replacer_size_ / 4);
+  kout_ = std::max<size_t>(1, replacer_size_ / 2);
+}
+
+auto TwoQueueReplacer::ShouldEvictFromA1in() -> bool {
+  if (a1in_evictable_.empty()) {
+    return false;
+  }
+  return am_evictable_.empty() || a1in_size_ > kin_;
+}
+
+auto TwoQueueReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (a1in_evictable_.empty() && am_evictable_.empty()) {
+    return false;
+  }
+  auto from_a1in = ShouldEvictFromA1in();
+  auto &evictable = from_a1in ? a1in_evictable_ : am_evictable_;
+  *frame_id = evictable.begin()->second;
+  auto it = frames_.find(*frame_id);
+  auto page_id = it->second.page_id_;
+  Untrack(it);
+  if (from_a1in && page_id != INVALID_PAGE_ID) {
+    a1out_.PushBack(page_id);
+    a1out_.TrimTo(kout_);
+  }
+  return true;
+}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id) { RecordAccess(frame_id, INVALID_PAGE_ID); }
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  current_timestamp_++;
+
+  auto it = frames_.find(frame_id);
+  if (it != frames_.end()) {
+    auto &entry = it->second;
+    // Hits in A1in are correlated references and leave the FIFO order alone.
+    if (!entry.in_am_) {
+      return;
+    }
+    if (entry.evictable_) {
+      am_evictable_.erase({entry.timestamp_, frame_id});
+    }
+    entry.timestamp_ = current_timestamp_;
+    if (entry.evictable_) {
+      am_evictable_.emplace(entry.timestamp_, frame_id);
+    }
+    return;
+  }
+
+  BUSTUB_ENSURE(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "frame id is invalid");
+  FrameEntry entry;
+  entry.page_id_ = page_id;
+  entry.timestamp_ = current_timestamp_;
+  entry.in_am_ = page_id != INVALID_PAGE_ID && a1out_.Erase(page_id);
+  if (!entry.in_am_) {
+    a1in_size_++;
+  }
+  EvictableSetOf(entry).emplace(entry.timestamp_, frame_id);
+  frames_.emplace(frame_id, entry);
+}
+
+void TwoQueueReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end() || it->second.evictable_ == set_evictable) {
+    return;
+  }
+  auto &entry = it->second;
+  if (set_evictable) {
+    EvictableSetOf(entry).emplace(entry.timestamp_, frame_id);
+  } else {
+    EvictableSetOf(entry).erase({entry.timestamp_, frame_id});
+  }
+  entry.evictable_ = set_evictable;
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    return;
+  }
+  BUSTUB_ENSURE(it->second.evictable_, "frame not evictable, can't remove!");
+  Untrack(it);
+}
+
+auto TwoQueueReplacer::EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> frames;
+  if (a1in_evictable_.empty() && am_evictable_.empty()) {
+    return frames;
+  }
+  // Evict() drains A1in down to Kin before it touches Am, and only goes back to A1in once Am is empty.
+  auto a1in_it = a1in_evictable_.begin();
+  auto am_it = am_evictable_.begin();
+  auto a1in_size = a1in_size_;
+  while (frames.size() < max_frames && (a1in_it != a1in_evictable_.end() || am_it != am_evictable_.end())) {
+    if (a1in_it != a1in_evictable_.end() && (am_it == am_evictable_.end() || a1in_size > kin_)) {
+      frames.push_back((a1in_it++)->second);
+      a1in_size--;
+    } else {
+      frames.push_back((am_it++)->second);
+    }
+  }
+  return frames;
+}
+
+void TwoQueueReplacer::Resize(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (auto it = frames_.begin(); it != frames_.end();) {
+    if (static_cast<size_t>(it->first) < num_frames) {
+      ++it;
+      continue;
+    }
+    auto next = std::next(it);
+    Untrack(it);
+    it = next;
+  }
+  replacer_size_ = num_frames;
+  SetQueueSizes();
+  a1out_.TrimTo(kout_);
+}
+
+auto TwoQueueReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return a1in_evictable_.size() + am_evictable_.size();
+}
+
+void TwoQueueReplacer::Untrack(std::unordered_map<frame_id_t, FrameEntry>::iterator it) {
+  auto &entry = it->second;
+  if (entry.evictable_) {
+    EvictableSetOf(entry).erase({entry.timestamp_, it->first});
+  }
+  if (!entry.in_am_) {
+    a1in_size_--;
+  }
+  frames_.erase(it);
+}
+
+}  // namespace bustub
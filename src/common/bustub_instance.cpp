@@ -1,3 +1,6 @@
+#include <sys/stat.h>
+
+#include <algorithm>
 #include <optional>
 #include <shared_mutex>
 #include <string>
@@ -12,6 +15,8 @@
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/hot_page_file.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
 #include "common/bustub_instance.h"
@@ -33,6 +38,8 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/tablespace_disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -41,11 +48,28 @@ auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<Ex
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
 }
 
-BustubInstance::BustubInstance(const std::string &db_file_name) {
+auto BustubInstance::MakeBufferPoolManager(size_t bpm_instances) -> BufferPoolManager * {
+  if (bpm_instances <= 1) {
+    auto *bpm = new BufferPoolManagerInstance(BUSTUB_INSTANCE_POOL_SIZE, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    bpm->SetDiskScheduler(disk_scheduler_);
+    return bpm;
+  }
+  // Keep the total number of frames about the same no matter how many shards the pool is split into: the shards are of
+  // the same size, so the total is rounded up to a multiple of their number.
+  size_t shard_size = (BUSTUB_INSTANCE_POOL_SIZE + bpm_instances - 1) / bpm_instances;
+  auto *bpm = new ParallelBufferPoolManager(bpm_instances, shard_size, disk_manager_, LRUK_REPLACER_K, log_manager_);
+  bpm->SetDiskScheduler(disk_scheduler_);
+  return bpm;
+}
+
+BustubInstance::BustubInstance(const std::string &db_file_name, size_t bpm_instances, DiskIoMode io_mode) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  tablespaces_ = new TablespaceDiskManager(db_file_name, io_mode);
+  disk_manager_ = tablespaces_;
+  disk_scheduler_ = std::make_shared<DiskScheduler>(disk_manager_);
+  hot_page_file_name_ = HotPageFile::FileNameFor(db_file_name);
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
@@ -53,7 +77,7 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
   // buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = MakeBufferPoolManager(bpm_instances);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -71,9 +95,12 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
 
   // Execution engine.
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
+
+  // Preload the pages that were hot when the database was last shut down, while queries already run.
+  WarmUpBufferPool();
 }
 
-BustubInstance::BustubInstance() {
+BustubInstance::BustubInstance(size_t bpm_instances) {
   enable_logging = false;
 
   // Storage related.
@@ -85,7 +112,7 @@ BustubInstance::BustubInstance() {
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
   // buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = MakeBufferPoolManager(bpm_instances);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -146,6 +173,87 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+void BustubInstance::CmdResizeBufferPool(const std::string &arg, ResultWriter &writer) {
+  size_t new_pool_size;
+  try {
+    new_pool_size = std::stoul(arg);
+  } catch (const std::logic_error &) {
+    throw Exception(fmt::format("invalid number of frames: {}", arg));
+  }
+  if (!buffer_pool_manager_->Resize(new_pool_size)) {
+    throw Exception(fmt::format("failed to resize the buffer pool to {} frames", new_pool_size));
+  }
+  WriteOneCell(fmt::format("Buffer pool resized to {} frames", buffer_pool_manager_->GetPoolSize()), writer);
+}
+
+void BustubInstance::CmdSaveHotPages(ResultWriter &writer) {
+  if (hot_page_file_name_.empty()) {
+    throw Exception("an instance backed by memory has no hot page file");
+  }
+  if (!SaveHotPages()) {
+    throw Exception(fmt::format("failed to write {}", hot_page_file_name_));
+  }
+  WriteOneCell(fmt::format("Hot page set saved to {}", hot_page_file_name_), writer);
+}
+
+void BustubInstance::CmdAddTablespace(const std::string &arg, ResultWriter &writer) {
+  auto args = StringUtil::Split(arg, ' ');
+  args.erase(std::remove(args.begin(), args.end(), ""), args.end());
+  if (args.size() != 2) {
+    throw Exception("usage: \\tablespace <name> <file>");
+  }
+  auto tablespace = AddTablespace(args[0], args[1]);
+  WriteOneCell(fmt::format("Tablespace {} created with id = {}", args[0], tablespace), writer);
+}
+
+auto BustubInstance::AddTablespace(const std::string &name, const std::string &file_name) -> tablespace_id_t {
+  if (tablespaces_ == nullptr) {
+    throw Exception("an instance backed by memory has no tablespaces");
+  }
+  return tablespaces_->AddTablespace(name, file_name, tablespaces_->GetIoMode());
+}
+
+auto BustubInstance::GetDefaultTablespace() -> tablespace_id_t {
+  auto name = GetSessionVariable("default_tablespace");
+  if (name.empty() || name == TablespaceDiskManager::DEFAULT_TABLESPACE_NAME) {
+    return DEFAULT_TABLESPACE;
+  }
+  auto tablespace = tablespaces_ == nullptr ? std::nullopt : tablespaces_->GetTablespace(name);
+  if (!tablespace.has_value()) {
+    throw Exception(fmt::format("tablespace {} does not exist", name));
+  }
+  return *tablespace;
+}
+
+auto BustubInstance::SaveHotPages() -> bool {
+  if (hot_page_file_name_.empty() || buffer_pool_manager_ == nullptr) {
+    return true;
+  }
+  return HotPageFile::Write(hot_page_file_name_, buffer_pool_manager_->GetHotPages());
+}
+
+void BustubInstance::WarmUpBufferPool() {
+  if (buffer_pool_manager_ == nullptr) {
+    return;
+  }
+  auto page_ids = HotPageFile::Read(hot_page_file_name_);
+  if (!page_ids.has_value()) {
+    return;
+  }
+  // The hot page file may have outlived its database. Only preload pages that exist. Those of the other tablespaces
+  // can't be read yet: the tablespaces are added again by \tablespace commands, once the instance is running.
+  struct stat stat_buf;
+  auto num_db_pages =
+      stat(disk_manager_->GetFileName().c_str(), &stat_buf) == 0 ? stat_buf.st_size / BUSTUB_PAGE_SIZE : 0;
+  page_ids->erase(std::remove_if(page_ids->begin(), page_ids->end(),
+                                 [&](page_id_t page_id) {
+                                   return DiskManager::TablespaceOf(page_id) != DEFAULT_TABLESPACE ||
+                                          page_id >= num_db_pages;
+                                 }),
+                  page_ids->end());
+  buffer_pool_manager_->WarmUp(*page_ids);
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -159,6 +267,9 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 
 \dt: show all tables
 \di: show all indices
+\resize <frames>: resize the buffer pool while it is in use
+\savehot: save the hot page set, preloaded when the database is opened again
+\tablespace <name> <file>: add a tablespace, used by `set default_tablespace = <name>`
 \help: show this message again
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
@@ -195,6 +306,18 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       CmdDisplayHelp(writer);
       return true;
     }
+    if (sql == "\\savehot") {
+      CmdSaveHotPages(writer);
+      return true;
+    }
+    if (StringUtil::StartsWith(sql, "\\tablespace ")) {
+      CmdAddTablespace(sql.substr(std::string("\\tablespace ").size()), writer);
+      return true;
+    }
+    if (StringUtil::StartsWith(sql, "\\resize ")) {
+      CmdResizeBufferPool(sql.substr(std::string("\\resize ").size()), writer);
+      return true;
+    }
     throw Exception(fmt::format("unsupported internal command: {}", sql));
   }
 
@@ -211,8 +334,9 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       case StatementType::CREATE_STATEMENT: {
         const auto &create_stmt = dynamic_cast<const CreateStatement &>(*statement);
 
+        auto tablespace = GetDefaultTablespace();
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
-        auto info = catalog_->CreateTable(txn, create_stmt.table_, Schema(create_stmt.columns_));
+        auto info = catalog_->CreateTable(txn, create_stmt.table_, Schema(create_stmt.columns_), true, tablespace);
         l.unlock();
 
         if (info == nullptr) {
@@ -237,10 +361,11 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
         }
         auto key_schema = Schema::CopySchema(&index_stmt.table_->schema_, col_ids);
 
+        auto tablespace = GetDefaultTablespace();
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
         auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
             txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
-            INTEGER_SIZE, IntegerHashFunctionType{});
+            INTEGER_SIZE, IntegerHashFunctionType{}, tablespace);
         l.unlock();
 
         if (info == nullptr) {
@@ -391,6 +516,11 @@ BustubInstance::~BustubInstance() {
   if (enable_logging) {
     log_manager_->StopFlushThread();
   }
+  SaveHotPages();
+  // Shutdown is a durability point: write back the dirty pages and sync them once.
+  if (buffer_pool_manager_ != nullptr) {
+    buffer_pool_manager_->SyncAllPages();
+  }
   delete execution_engine_;
   delete catalog_;
   delete checkpoint_manager_;
@@ -398,6 +528,9 @@ BustubInstance::~BustubInstance() {
   delete buffer_pool_manager_;
   delete lock_manager_;
   delete txn_manager_;
+  // The buffer pool held the other references, this completes the queued I/O before the disk manager goes away.
+  disk_scheduler_.reset();
+  disk_manager_->ShutDown();
   delete disk_manager_;
 }
 
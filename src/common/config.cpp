@@ -20,4 +20,10 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds bg_flush_interval = std::chrono::milliseconds(10);
+
+std::atomic<int> read_ahead_window(8);
+
+std::atomic<bool> enable_huge_pages(true);
+
 }  // namespace bustub
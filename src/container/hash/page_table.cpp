@@ -0,0 +1,201 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/container/hash/page_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "container/hash/page_table.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+
+#include "common/macros.h"
+
+namespace bustub {
+
+PageTable::Slots::Slots(size_t num_lines)
+    : lines_(new Line[num_lines]), slot_mask_(num_lines * SLOTS_PER_LINE - 1) {
+  for (size_t i = 0; i < num_lines; i++) {
+    for (auto &slot : lines_[i].slots_) {
+      slot.store(Pack(EMPTY_SLOT, 0), std::memory_order_relaxed);
+    }
+  }
+}
+
+PageTable::PageTable(size_t capacity) {
+  all_slots_.push_back(std::make_unique<Slots>(LinesFor(capacity)));
+  slots_.store(all_slots_.back().get());
+}
+
+auto PageTable::LinesFor(size_t capacity) -> size_t {
+  // Keep the table at most half full, with a power-of-two number of lines.
+  size_t num_lines = 1;
+  while (num_lines * SLOTS_PER_LINE < 2 * capacity) {
+    num_lines *= 2;
+  }
+  return num_lines;
+}
+
+auto PageTable::HomeSlot(page_id_t page_id, size_t slot_mask) -> size_t {
+  // Fibonacci hashing spreads both consecutive page ids and the strided ids of a sharded pool.
+  auto hash = (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >> 32;
+  return (hash * SLOTS_PER_LINE) & slot_mask;
+}
+
+auto PageTable::Find(const page_id_t &page_id, frame_id_t &frame_id) -> bool {
+  while (true) {
+    auto version = version_.load();
+    if ((version & 1) != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    auto *slots = slots_.load();
+    bool found = false;
+    frame_id_t value = 0;
+    auto index = HomeSlot(page_id, slots->slot_mask_);
+    for (size_t probes = 0; probes <= slots->slot_mask_; probes++) {
+      auto slot = SlotAt(slots, index).load();
+      auto key = KeyOf(slot);
+      if (key == page_id) {
+        found = true;
+        value = ValueOf(slot);
+        break;
+      }
+      if (key == EMPTY_SLOT) {
+        break;
+      }
+      index = (index + 1) & slots->slot_mask_;
+    }
+    if (version_.load() == version) {
+      if (found) {
+        frame_id = value;
+      }
+      return found;
+    }
+  }
+}
+
+void PageTable::Insert(const page_id_t &page_id, const frame_id_t &frame_id) {
+  BUSTUB_ASSERT(page_id >= 0, "PageTable keys must be valid page ids");
+  std::scoped_lock<std::mutex> lock(latch_);
+  version_++;
+  auto *slots = slots_.load();
+  auto index = HomeSlot(page_id, slots->slot_mask_);
+  for (size_t probes = 0; probes <= slots->slot_mask_; probes++) {
+    auto &slot = SlotAt(slots, index);
+    auto key = KeyOf(slot.load());
+    if (key == page_id) {
+      slot.store(Pack(page_id, frame_id));
+      version_++;
+      return;
+    }
+    if (key == EMPTY_SLOT) {
+      break;
+    }
+    index = (index + 1) & slots->slot_mask_;
+  }
+
+  auto num_slots = slots->slot_mask_ + 1;
+  if (2 * (size_ + 1) > num_slots) {
+    Rebuild(2 * num_slots / SLOTS_PER_LINE);
+  } else if (4 * (size_ + tombstones_ + 1) > 3 * num_slots) {
+    // Mostly tombstones: rebuild at the same size to shorten the probe sequences.
+    Rebuild(num_slots / SLOTS_PER_LINE);
+  }
+  InsertFresh(slots_.load(), page_id, frame_id);
+  size_++;
+  version_++;
+}
+
+auto PageTable::Remove(const page_id_t &page_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto *slots = slots_.load();
+  auto index = HomeSlot(page_id, slots->slot_mask_);
+  for (size_t probes = 0; probes <= slots->slot_mask_; probes++) {
+    auto &slot = SlotAt(slots, index);
+    auto key = KeyOf(slot.load());
+    if (key == page_id) {
+      version_++;
+      slot.store(Pack(TOMBSTONE, 0));
+      version_++;
+      size_--;
+      tombstones_++;
+      return true;
+    }
+    if (key == EMPTY_SLOT) {
+      return false;
+    }
+    index = (index + 1) & slots->slot_mask_;
+  }
+  return false;
+}
+
+void PageTable::Reserve(size_t capacity) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto num_lines = LinesFor(capacity);
+  if (num_lines * SLOTS_PER_LINE <= slots_.load()->slot_mask_ + 1) {
+    return;
+  }
+  version_++;
+  Rebuild(num_lines);
+  version_++;
+}
+
+auto PageTable::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return size_;
+}
+
+auto PageTable::GetNumSlots() -> size_t { return slots_.load()->slot_mask_ + 1; }
+
+void PageTable::InsertFresh(Slots *slots, page_id_t page_id, frame_id_t frame_id) {
+  auto index = HomeSlot(page_id, slots->slot_mask_);
+  while (true) {
+    auto &slot = SlotAt(slots, index);
+    auto key = KeyOf(slot.load());
+    if (key == EMPTY_SLOT || key == TOMBSTONE) {
+      if (key == TOMBSTONE) {
+        tombstones_--;
+      }
+      slot.store(Pack(page_id, frame_id));
+      return;
+    }
+    index = (index + 1) & slots->slot_mask_;
+  }
+}
+
+void PageTable::Rebuild(size_t num_lines) {
+  auto *old_slots = slots_.load();
+  std::vector<uint64_t> live;
+  live.reserve(size_);
+  for (size_t i = 0; i <= old_slots->slot_mask_; i++) {
+    auto slot = SlotAt(old_slots, i).load();
+    if (KeyOf(slot) >= 0) {
+      live.push_back(slot);
+    }
+  }
+
+  auto *new_slots = old_slots;
+  if (num_lines * SLOTS_PER_LINE != old_slots->slot_mask_ + 1) {
+    all_slots_.push_back(std::make_unique<Slots>(num_lines));
+    new_slots = all_slots_.back().get();
+  } else {
+    // Same size, so the tombstones are cleared in place. Readers see an odd version and retry.
+    for (size_t i = 0; i <= old_slots->slot_mask_; i++) {
+      SlotAt(old_slots, i).store(Pack(EMPTY_SLOT, 0));
+    }
+  }
+  tombstones_ = 0;
+  for (auto slot : live) {
+    InsertFresh(new_slots, KeyOf(slot), ValueOf(slot));
+  }
+  slots_.store(new_slots);
+}
+
+}  // namespace bustub
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// access_trace.h
+//
+// Identification: src/include/buffer/access_trace.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <fstream>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** The buffer pool calls an access trace records. */
+enum class AccessType : uint8_t { FETCH, NEW, UNPIN, DELETE };
+
+/** Flag of a FETCH record: the page was already in the buffer pool. */
+static constexpr uint8_t ACCESS_TRACE_HIT = 1;
+/** Flag of an UNPIN record: the caller dirtied the page. */
+static constexpr uint8_t ACCESS_TRACE_DIRTY = 2;
+
+/** One event of an access trace, as it is laid out in the trace file. */
+struct AccessTraceRecord {
+  /** Nanoseconds since the trace was started. */
+  uint64_t timestamp_ns_;
+  page_id_t page_id_;
+  /** Small id of the calling thread, numbered in the order threads first showed up in the process. */
+  uint16_t thread_id_;
+  AccessType type_;
+  uint8_t flags_;
+};
+
+static_assert(sizeof(AccessTraceRecord) == 16, "access trace records must stay compact");
+
+/** The header at the start of a trace file. */
+struct AccessTraceHeader {
+  char magic_[8];
+  uint32_t version_;
+  uint32_t record_size_;
+};
+
+/**
+ * AccessTraceWriter appends access trace records to a file.
+ *
+ * Records are collected in memory and written in blocks, so that tracing stays cheap enough to leave on during a
+ * benchmark. Record() may be called from any thread. Once the writer is closed, further records are dropped.
+ */
+class AccessTraceWriter {
+ public:
+  /**
+   * @brief Create the trace file, truncating it if it exists.
+   * @param file_name path of the trace file
+   */
+  explicit AccessTraceWriter(const std::string &file_name);
+
+  ~AccessTraceWriter();
+
+  DISALLOW_COPY_AND_MOVE(AccessTraceWriter);
+
+  /** Record a buffer pool call. */
+  void Record(AccessType type, page_id_t page_id, uint8_t flags = 0);
+
+  /** Write out the buffered records and close the file. */
+  void Close();
+
+  /** @return the number of records taken so far */
+  auto GetNumRecords() -> uint64_t;
+
+ private:
+  /** Write out the buffered records. Caller must hold latch_. */
+  void FlushBuffer();
+
+  std::chrono::steady_clock::time_point start_;
+  std::ofstream file_;
+  std::vector<AccessTraceRecord> buffer_;
+  uint64_t num_records_{0};
+  bool closed_{false};
+  std::mutex latch_;
+};
+
+/** AccessTraceReader reads the records of a trace file back, in the order they were taken. */
+class AccessTraceReader {
+ public:
+  /**
+   * @brief Open a trace file and check its header.
+   * @param file_name path of the trace file
+   */
+  explicit AccessTraceReader(const std::string &file_name);
+
+  /**
+   * Read the next record.
+   * @param[out] record the record read
+   * @return false at the end of the trace
+   */
+  auto Next(AccessTraceRecord *record) -> bool;
+
+ private:
+  std::ifstream file_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha, FAST 2003).
+ *
+ * Resident frames are split between T1, the pages seen once recently, and T2, the pages seen at least twice. The
+ * ghost lists B1 and B2 remember the pages recently evicted from T1 and T2. A page read back while in B1 means T1 is
+ * too small, one in B2 means T2 is: either hit moves the target size p of T1, so the cache adapts between recency
+ * (scans stay in T1 and flow through it) and frequency (hot pages stay in T2).
+ *
+ * Evictable frames of each list are kept in sets ordered by last access, so every operation runs in O(log n).
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new ARCReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ARCReplacer);
+
+  ~ARCReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  void Resize(size_t num_frames) override;
+
+  auto Size() -> size_t override;
+
+  /** @return the current target size of T1 */
+  auto GetTargetT1Size() -> size_t;
+
+ private:
+  struct FrameEntry {
+    page_id_t page_id_{INVALID_PAGE_ID};
+    bool in_t2_{false};
+    bool evictable_{true};
+    size_t last_access_{0};
+  };
+
+  /** Ordering key of an evictable frame: (last access, frame id). */
+  using EvictKey = std::pair<size_t, frame_id_t>;
+
+  auto EvictableSetOf(const FrameEntry &entry) -> std::set<EvictKey> & {
+    return entry.in_t2_ ? t2_evictable_ : t1_evictable_;
+  }
+
+  /** @return true if the next victim should come from T1. Caller must hold latch_ and have an evictable frame. */
+  auto ShouldEvictFromT1() -> bool;
+
+  /** Keep |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c. Caller must hold latch_. */
+  void TrimGhosts();
+
+  /** Stop tracking a frame. Caller must hold latch_. */
+  void Untrack(std::unordered_map<frame_id_t, FrameEntry>::iterator it);
+
+  /** The cache size c, i.e. the number of frames. */
+  size_t capacity_;
+  /** The adaptive target size p of T1. */
+  size_t target_t1_size_{0};
+  size_t current_timestamp_{0};
+  std::unordered_map<frame_id_t, FrameEntry> frames_;
+  /** Number of frames in T1 and T2, evictable or not. */
+  size_t t1_size_{0};
+  size_t t2_size_{0};
+  /** Evictable frames of T1 and T2, least recently used first. */
+  std::set<EvictKey> t1_evictable_;
+  std::set<EvictKey> t2_evictable_;
+  /** Pages recently evicted from T1 and T2. */
+  GhostList b1_;
+  GhostList b2_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
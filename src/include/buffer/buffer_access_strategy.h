@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * BufferAccessStrategy is a small private ring of frames for operations that touch many pages exactly once, such as
+ * large sequential scans, index backfills and bulk inserts.
+ *
+ * Pages fetched through a strategy that miss the buffer pool are read into the frame of the ring slot they replace,
+ * as long as that frame still holds the page the ring put there and nobody has it pinned. Such an operation therefore
+ * recycles about ring_size frames instead of pushing the rest of the working set out of the pool.
+ *
+ * A strategy is not thread-safe. Each scan or query should use its own.
+ */
+class BufferAccessStrategy {
+ public:
+  /** A frame the ring loaded, and the page it loaded into it. */
+  struct Slot {
+    Page *page_{nullptr};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  explicit BufferAccessStrategy(size_t ring_size = BUFFER_RING_SIZE) : ring_(ring_size > 0 ? ring_size : 1) {}
+
+  /** @return the number of frames in the ring */
+  auto GetRingSize() const -> size_t { return ring_.size(); }
+
+  /** @return the slot the next miss will replace */
+  auto CurrentSlot() const -> const Slot & { return ring_[current_]; }
+
+  /**
+   * Record that the next miss loaded page_id into the given frame, and move on to the next slot.
+   * @param reused true if the frame was recycled from the current slot
+   */
+  void Advance(Page *page, page_id_t page_id, bool reused) {
+    ring_[current_] = {page, page_id};
+    current_ = (current_ + 1) % ring_.size();
+    reused_frames_ += reused ? 1 : 0;
+  }
+
+  /** @return the number of misses that recycled a frame of the ring */
+  auto GetReusedCount() const -> size_t { return reused_frames_; }
+
+ private:
+  std::vector<Slot> ring_;
+  size_t current_{0};
+  size_t reused_frames_{0};
+};
+
+}  // namespace bustub
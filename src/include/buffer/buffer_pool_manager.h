@@ -13,10 +13,16 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "buffer/access_trace.h"
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_extent.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -84,6 +90,117 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Write back every dirty page like FlushAllPages(), then wait until the writes are durable on disk. Call this where
+   * durability is required, e.g. checkpoints and shutdown; plain page writes are not synced.
+   */
+  void SyncAllPages() { SyncAllPgsImp(); }
+
+  /**
+   * Fetch a page, recycling the frames of the given access strategy on a miss instead of evicting from the whole pool.
+   * @param page_id id of page to be fetched
+   * @param strategy the ring of frames to recycle
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPage(page_id_t page_id, BufferAccessStrategy &strategy) -> Page * { return FetchPgImp(page_id, &strategy); }
+
+  /**
+   * Create a new page, recycling the frames of the given access strategy.
+   * @param[out] page_id id of created page
+   * @param strategy the ring of frames to recycle
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPage(page_id_t *page_id, BufferAccessStrategy &strategy) -> Page * { return NewPgImp(page_id, &strategy); }
+
+  /**
+   * Create a new page with the next id of the given extent, reserving a new extent when it is used up. Buffer pools
+   * that can't reserve extents create a regular page instead.
+   * @param[out] page_id id of created page
+   * @param extent the extent of the table or index the page belongs to
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPage(page_id_t *page_id, PageExtent &extent) -> Page * {
+    std::scoped_lock<std::mutex> lock(extent.GetLatch());
+    if (extent.IsExhausted()) {
+      auto first_page_id = AllocateExtentImp(extent.GetTablespace(), extent.GetSize());
+      if (first_page_id == INVALID_PAGE_ID) {
+        return NewPgImp(page_id);
+      }
+      extent.Assign(first_page_id);
+    }
+    auto *page = NewReservedPgImp(extent.Peek());
+    if (page != nullptr) {
+      *page_id = extent.Peek();
+      extent.Advance();
+    }
+    return page;
+  }
+
+  /**
+   * Fetch and pin several pages at once. Compared to fetching them one by one, a buffer pool may take its latches once
+   * for the whole batch and read all the pages that are not resident with a single request to the disk layer.
+   * A page listed several times is pinned once per occurrence.
+   * @param page_ids ids of the pages to be fetched, in any order
+   * @return the fetched pages, in the order of page_ids, or an empty vector if any of them cannot be fetched; in that
+   * case none of them is left pinned
+   */
+  auto FetchPages(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> { return FetchPgsImp(page_ids); }
+
+  /**
+   * Unpin several pages at once, as UnpinPage() would one by one.
+   * @param page_ids ids of the pages to be unpinned; a page listed several times is unpinned once per occurrence
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   * @return false if any of the pages was not pinned, true otherwise
+   */
+  auto UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) -> bool {
+    return UnpinPgsImp(page_ids, is_dirty);
+  }
+
+  /**
+   * Asynchronously load a page into the buffer pool without pinning it. This is only a hint: the page may not be
+   * resident, or may already have been evicted again, by the time it is fetched.
+   * @param page_id id of page to be prefetched
+   */
+  void PrefetchPage(page_id_t page_id) { PrefetchPgsImp(page_id, 1); }
+
+  /**
+   * Asynchronously load the pages [first_page_id, first_page_id + num_pages) without pinning them.
+   * @param first_page_id id of the first page to be prefetched
+   * @param num_pages number of consecutive pages to prefetch
+   */
+  void PrefetchRange(page_id_t first_page_id, size_t num_pages) { PrefetchPgsImp(first_page_id, num_pages); }
+
+  /**
+   * Change the number of frames of the buffer pool while it is in use. Growing adds empty frames; shrinking writes
+   * back and drops the pages of the frames that go away, and waits for the ones that are pinned to be unpinned.
+   * @param new_pool_size the new number of frames
+   * @return false if the buffer pool can't be resized to new_pool_size
+   */
+  auto Resize(size_t new_pool_size) -> bool { return ResizeImp(new_pool_size); }
+
+  /**
+   * Get the hot page set: the ids of the resident pages, hottest first according to the replacer. Pinned pages count
+   * as the hottest. Save it with HotPageFile and pass it to WarmUp() after a restart.
+   * @return the ids of the resident pages, hottest first
+   */
+  auto GetHotPages() -> std::vector<page_id_t> { return HotPagesImp(); }
+
+  /**
+   * Preload a hot page set in the background, while the buffer pool is in use. Pages are read in ascending page id
+   * order so that the I/O is sequential. Warming up only fills free frames, it never evicts a page.
+   * @param page_ids the hot page set, hottest first; pages that don't fit in the pool are skipped
+   */
+  void WarmUp(const std::vector<page_id_t> &page_ids) { WarmUpImp(page_ids); }
+
+  /**
+   * Record every FetchPage, NewPage, UnpinPage and DeletePage call to an access trace, until StopAccessTrace().
+   * @param trace the trace to record to, which may be shared by several buffer pools
+   */
+  void StartAccessTrace(std::shared_ptr<AccessTraceWriter> trace) { SetAccessTraceImp(std::move(trace)); }
+
+  /** Stop recording the access trace. The caller closes the trace. */
+  void StopAccessTrace() { SetAccessTraceImp(nullptr); }
+
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
@@ -141,5 +258,109 @@ class BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   virtual void FlushAllPgsImp() = 0;
+
+  /**
+   * Fetch the requested page through an access strategy. By default strategies are ignored.
+   * @param page_id id of page to be fetched
+   * @param strategy the ring of frames to recycle on a miss, or nullptr
+   * @return the requested page
+   */
+  virtual auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * { return FetchPgImp(page_id); }
+
+  /**
+   * Creates a new page through an access strategy. By default strategies are ignored.
+   * @param[out] page_id id of created page
+   * @param strategy the ring of frames to recycle, or nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual auto NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) -> Page * { return NewPgImp(page_id); }
+
+  /**
+   * Reserve a range of contiguous page ids that NewPage() will never hand out. By default extents are not supported.
+   * @param tablespace the tablespace of the range
+   * @param num_pages number of pages to reserve
+   * @return the first page id of the range, or INVALID_PAGE_ID if no range could be reserved
+   */
+  virtual auto AllocateExtentImp(tablespace_id_t tablespace, size_t num_pages) -> page_id_t { return INVALID_PAGE_ID; }
+
+  /**
+   * Creates a new page with an id reserved by AllocateExtentImp(). By default extents are not supported.
+   * @param page_id the reserved id, which was never used before
+   * @return nullptr if the page could not be created, otherwise pointer to new page
+   */
+  virtual auto NewReservedPgImp(page_id_t page_id) -> Page * { return nullptr; }
+
+  /**
+   * Fetch and pin a batch of pages. By default the pages are fetched one by one.
+   * @param page_ids ids of the pages to be fetched
+   * @return the fetched pages in the order of page_ids, or an empty vector if any of them cannot be fetched
+   */
+  virtual auto FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> {
+    std::vector<Page *> pages;
+    pages.reserve(page_ids.size());
+    for (auto page_id : page_ids) {
+      auto *page = FetchPgImp(page_id);
+      if (page == nullptr) {
+        for (auto *fetched : pages) {
+          UnpinPgImp(fetched->GetPageId(), false);
+        }
+        return {};
+      }
+      pages.push_back(page);
+    }
+    return pages;
+  }
+
+  /**
+   * Unpin a batch of pages. By default the pages are unpinned one by one.
+   * @param page_ids ids of the pages to be unpinned
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   * @return false if any of the pages was not pinned, true otherwise
+   */
+  virtual auto UnpinPgsImp(const std::vector<page_id_t> &page_ids, bool is_dirty) -> bool {
+    bool all_unpinned = true;
+    for (auto page_id : page_ids) {
+      all_unpinned = UnpinPgImp(page_id, is_dirty) && all_unpinned;
+    }
+    return all_unpinned;
+  }
+
+  /**
+   * Asynchronously loads pages [first_page_id, first_page_id + num_pages) into the buffer pool without pinning them.
+   * Prefetching is only a hint, so by default it does nothing.
+   * @param first_page_id id of the first page to be prefetched
+   * @param num_pages number of consecutive pages to prefetch
+   */
+  virtual void PrefetchPgsImp(page_id_t first_page_id, size_t num_pages) {}
+
+  /**
+   * Flushes all the pages and makes the writes durable. By default the pages are only flushed.
+   */
+  virtual void SyncAllPgsImp() { FlushAllPgsImp(); }
+
+  /**
+   * Changes the number of frames of the buffer pool. By default the size is fixed.
+   * @param new_pool_size the new number of frames
+   * @return false if the buffer pool can't be resized to new_pool_size
+   */
+  virtual auto ResizeImp(size_t new_pool_size) -> bool { return false; }
+
+  /**
+   * Gets the ids of the resident pages, hottest first. By default there are none.
+   * @return the hot page set
+   */
+  virtual auto HotPagesImp() -> std::vector<page_id_t> { return {}; }
+
+  /**
+   * Starts preloading a hot page set in the background. Warming up is only a hint, so by default it does nothing.
+   * @param page_ids the hot page set, hottest first
+   */
+  virtual void WarmUpImp(const std::vector<page_id_t> &page_ids) {}
+
+  /**
+   * Starts recording the access trace, or stops it if trace is nullptr. By default nothing is recorded.
+   * @param trace the trace to record to, or nullptr
+   */
+  virtual void SetAccessTraceImp(std::shared_ptr<AccessTraceWriter> trace) {}
 };
 }  // namespace bustub
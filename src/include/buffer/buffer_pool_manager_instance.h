@@ -12,16 +12,24 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_k_replacer.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/frame_arena.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
-#include "container/hash/extendible_hash_table.h"
+#include "container/hash/page_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "storage/page/page.h"
 
 namespace bustub {
@@ -30,6 +38,9 @@ namespace bustub {
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
 class BufferPoolManagerInstance : public BufferPoolManager {
+  /** Flushes the dirty pages of all its instances in one sorted batch. */
+  friend class ParallelBufferPoolManager;
+
  public:
   /**
    * @brief Creates a new BufferPoolManagerInstance.
@@ -37,9 +48,24 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_policy the policy picking the frames to evict
    */
   BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerPolicy replacer_policy = ReplacerPolicy::LRU_K);
+
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of this buffer pool instance
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_policy the policy picking the frames to evict
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr, ReplacerPolicy replacer_policy = ReplacerPolicy::LRU_K);
 
   /**
    * @brief Destroy an existing BufferPoolManagerInstance.
@@ -49,8 +75,74 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t override { return pool_size_; }
 
+  /** @brief Return the number of frames the buffer pool can be resized to. */
+  auto GetMaxPoolSize() const -> size_t { return max_pool_size_; }
+
   /** @brief Return the pointer to all the pages in the buffer pool. */
-  auto GetPages() -> Page * { return pages_; }
+  auto GetPages() -> Page * { return pages_.Data(); }
+
+  /** @brief Return the memory holding the data of all the frames in the buffer pool. */
+  auto GetFrameArena() -> FrameArena * { return arena_; }
+
+  /**
+   * @brief Start the background flusher thread.
+   *
+   * The flusher periodically writes back dirty, unpinned pages that are next in the replacer's eviction order, so
+   * that evictions find clean frames and don't have to write synchronously on the critical path.
+   *
+   * @param target_clean_ratio fraction of the pool (free frames plus the head of the eviction order) to keep clean
+   * @param pages_per_second maximum number of pages the flusher writes per second
+   */
+  void StartBackgroundFlusher(double target_clean_ratio = BG_FLUSH_TARGET_CLEAN_RATIO,
+                              size_t pages_per_second = BG_FLUSH_PAGES_PER_SEC);
+
+  /** @brief Stop and join the background flusher thread, if it is running. */
+  void StopBackgroundFlusher();
+
+  /**
+   * @brief Put a compressed victim cache between the buffer pool and the disk manager.
+   *
+   * Evicted pages are stored in the cache once they are clean, and misses look the cache up before reading from disk.
+   * Pages recycled by an access strategy's ring are not stored, so that scans don't flush the cache. The cache may be
+   * shared with other instances. This must be called before the buffer pool is used.
+   *
+   * @param cache the cache, or nullptr to go straight to disk
+   */
+  void SetCompressedCache(std::shared_ptr<CompressedPageCache> cache) { compressed_cache_ = std::move(cache); }
+
+  /** @return the compressed victim cache, or nullptr if there is none */
+  auto GetCompressedCache() const -> CompressedPageCache * { return compressed_cache_.get(); }
+
+  /**
+   * @brief Issue the page reads and writes of the buffer pool through a DiskScheduler instead of calling the disk
+   * manager directly. Concurrent misses on adjacent pages are then merged, and writes of the background flusher yield
+   * to reads. The scheduler may be shared with other instances, and must use the disk manager of the buffer pool. This
+   * must be called before the buffer pool is used.
+   *
+   * @param scheduler the scheduler, or nullptr to call the disk manager directly
+   */
+  void SetDiskScheduler(std::shared_ptr<DiskScheduler> scheduler) { disk_scheduler_ = std::move(scheduler); }
+
+  /** @return the disk manager */
+  auto GetDiskManager() const -> DiskManager * { return disk_manager_; }
+
+  /** @return the disk scheduler, or nullptr if there is none */
+  auto GetDiskScheduler() const -> DiskScheduler * { return disk_scheduler_.get(); }
+
+  /** @return the number of evictions that had to write a dirty victim back synchronously */
+  auto GetSyncWriteBackCount() const -> size_t { return sync_write_backs_; }
+
+  /** @return the number of pages written by the background flusher */
+  auto GetBackgroundWriteCount() const -> size_t { return background_writes_; }
+
+  /** @return the number of pages loaded into the pool by prefetching */
+  auto GetPrefetchCount() const -> size_t { return prefetched_pages_; }
+
+  /** @return the number of pages loaded into the pool by warming up */
+  auto GetWarmUpCount() const -> size_t { return warmed_up_pages_; }
+
+  /** @brief Wait for the warm-up started by WarmUp() to finish, if one is running. */
+  void WaitForWarmUp();
 
  protected:
   /**
@@ -72,6 +164,30 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto NewPgImp(page_id_t *page_id) -> Page * override;
 
+  /**
+   * @brief Create a new page like NewPgImp(), but take the frame from the strategy's ring when its current slot can be
+   * recycled.
+   */
+  auto NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * @brief Reserve num_pages contiguous page ids past every id handed out so far. In the default tablespace, only a
+   * buffer pool that is not part of a parallel one can do so, since the ids of the range belong to every instance of a
+   * parallel pool; the ranges of other tablespaces are reserved by the disk manager.
+   * @return the first reserved page id, or INVALID_PAGE_ID for an instance of a parallel pool
+   */
+  auto AllocateExtentImp(tablespace_id_t tablespace, size_t num_pages) -> page_id_t override;
+
+  /**
+   * @brief Create a new page like NewPgImp(), with an id reserved by AllocateExtentImp().
+   */
+  auto NewReservedPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * @brief Create a new page with the given reserved id, or with a newly allocated one if it is INVALID_PAGE_ID.
+   */
+  auto NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t reserved_page_id) -> Page *;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -90,6 +206,13 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * @brief Fetch a page like FetchPgImp(). On a miss, the page is read into the frame of the strategy's current ring
+   * slot if that frame still holds the page the ring loaded into it and is unpinned; otherwise a frame is taken from
+   * the free list or the replacer as usual and added to the ring.
+   */
+  auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -105,6 +228,29 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
 
+  /**
+   * @brief Fetch a batch of pages under a single acquisition of the latch.
+   *
+   * The ids are sorted and deduplicated. Resident pages are pinned right away; then a frame is reserved for each page
+   * that is not resident, and all of them are read with one DiskManager::ReadPages() call once the latch is dropped.
+   * The replacer is updated once for the hits and once for the misses. Pages whose I/O is already in flight are
+   * fetched one by one afterwards.
+   *
+   * @param page_ids ids of the pages to be fetched
+   * @return the fetched pages in the order of page_ids, or an empty vector if every frame is pinned
+   */
+  auto FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> override;
+
+  /**
+   * @brief Unpin a batch of pages under a single acquisition of the latch. The frames that become unpinned are made
+   * evictable with one call to the replacer.
+   *
+   * @param page_ids ids of the pages to be unpinned
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   * @return false if any of the pages is not in the page table or was not pinned, true otherwise
+   */
+  auto UnpinPgsImp(const std::vector<page_id_t> &page_ids, bool is_dirty) -> bool override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -122,9 +268,17 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * TODO(P1): Add implementation
    *
    * @brief Flush all the pages in the buffer pool to disk.
+   *
+   * Only dirty pages are written. They are sorted by page id, so that each run of adjacent pages goes out with one
+   * vectored write, and the writes are not synced.
    */
   void FlushAllPgsImp() override;
 
+  /**
+   * @brief Flush all the pages like FlushAllPgsImp(), then sync the disk manager once.
+   */
+  void SyncAllPgsImp() override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -140,42 +294,401 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto DeletePgImp(page_id_t page_id) -> bool override;
 
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
+  /**
+   * @brief Queue pages to be read into the buffer pool by the prefetcher thread, which is started on first use.
+   *
+   * Pages that are not owned by this instance or have not been allocated yet are ignored. Prefetched pages are not
+   * pinned, and the queue is bounded by a quarter of the pool size; requests that don't fit are dropped.
+   *
+   * @param first_page_id id of the first page to be prefetched
+   * @param num_pages number of consecutive pages to prefetch
+   */
+  void PrefetchPgsImp(page_id_t first_page_id, size_t num_pages) override;
+
+  /**
+   * @brief Change the number of frames, up to GetMaxPoolSize(), while the buffer pool is in use.
+   *
+   * Growing makes the memory of the new frames accessible and adds them to the free list. Shrinking stops handing out
+   * the frames at and above new_pool_size right away, then retires them one by one: each one's page is written back if
+   * dirty and removed from the page table, and its memory is returned to the OS. Frames that are pinned are retired
+   * once they are unpinned, so the caller must not hold pins on pages it expects the shrink to drop.
+   *
+   * @param new_pool_size the new number of frames
+   * @return false if new_pool_size is zero or larger than GetMaxPoolSize()
+   */
+  auto ResizeImp(size_t new_pool_size) -> bool override;
+
+  /**
+   * @brief Get the ids of the resident pages: the pinned ones first, then the others in reverse eviction order.
+   */
+  auto HotPagesImp() -> std::vector<page_id_t> override;
+
+  /**
+   * @brief Start a warm-up thread that preloads the pages owned by this instance into free frames, in ascending page id
+   * order and batches of WARMUP_BATCH_SIZE pages. Only as many of the hottest pages as there are free frames are
+   * considered. The next page ids allocated by NewPage() are moved past the preloaded pages. A warm-up that is still
+   * running is stopped first.
+   */
+  void WarmUpImp(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * @brief Start or stop recording the access trace. Calls racing with this may or may not be recorded.
+   * @param trace the trace to record to, or nullptr to stop
+   */
+  void SetAccessTraceImp(std::shared_ptr<AccessTraceWriter> trace) override;
+
+  /** Number of pages in the buffer pool. Frames at and above it are retired, or are being retired by a shrink. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames the buffer pool can grow to. Address space for this many frames is reserved up front. */
+  const size_t max_pool_size_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
   /** The next page id to be allocated  */
   std::atomic<page_id_t> next_page_id_;
-  /** Bucket size for the extendible hash table */
-  const size_t bucket_size_ = 4;
 
-  /** Array of buffer pool pages. */
-  Page *pages_;
+  /** Array of buffer pool pages. Holds the frame metadata only. */
+  FrameArray<Page> pages_;
+  /** Data of the buffer pool frames. Frame i's data is pages_[i].GetData(). */
+  FrameArena *arena_;
   /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_ __attribute__((__unused__));
   /** Page table for keeping track of buffer pool pages. */
-  ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
+  PageTable *page_table_;
   /** Replacer to find unpinned pages for replacement. */
-  LRUKReplacer *replacer_;
+  std::unique_ptr<Replacer> replacer_;
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch protects the page table, the replacer, the free list, the frame metadata and the I/O state below. It is
+   * never held across disk I/O: a miss reserves its frame, marks it as having I/O in progress and drops the latch.
+   */
   std::mutex latch_;
 
+  /** Per-frame I/O state. */
+  struct FrameIo {
+    /** True while the frame is being written back and/or read in without the latch held. Set before the page is
+     * mapped in the page table, and read without the latch by cache hits. */
+    std::atomic<bool> in_progress_{false};
+    /** True while the background flusher writes the page. The frame stays readable but can't be evicted. */
+    bool flushing_{false};
+    /** True while the frame is on the free list. */
+    bool in_free_list_{true};
+    /**
+     * True if the victim the frame is evicting has to be written back, and not only stashed in the compressed cache.
+     */
+    bool victim_dirty_{false};
+    /** Signalled when the I/O on this frame completes. Waiters use latch_. */
+    std::condition_variable io_done_;
+  };
+  /** I/O state of every frame, indexed by frame id. */
+  FrameArray<FrameIo> frame_io_;
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
-   * @return the id of the allocated page
+   * Evicted pages that are still being written back, or stored in the compressed cache, mapped to the frame doing it.
    */
-  auto AllocatePage() -> page_id_t;
+  std::unordered_map<page_id_t, frame_id_t> writing_back_;
+
+  /** The compressed victim cache, or nullptr. */
+  std::shared_ptr<CompressedPageCache> compressed_cache_;
+
+  /** The disk scheduler the I/O goes through, or nullptr. */
+  std::shared_ptr<DiskScheduler> disk_scheduler_;
+
+  /** Number of evictions that wrote a dirty victim back synchronously. */
+  std::atomic<size_t> sync_write_backs_{0};
+  /** Number of pages written by the background flusher. */
+  std::atomic<size_t> background_writes_{0};
+  /** The background flusher thread, if started. */
+  std::thread flusher_thread_;
+  /** True while the background flusher should keep running. Protected by latch_. */
+  bool flusher_running_{false};
+  /** Wakes up the background flusher when it is stopped. Waits use latch_. */
+  std::condition_variable flusher_cv_;
 
+  /** Number of pages loaded by the prefetcher. */
+  std::atomic<size_t> prefetched_pages_{0};
+  /** Pages waiting to be prefetched. Protected by latch_. */
+  std::deque<page_id_t> prefetch_queue_;
+  /** The prefetcher thread, started by the first prefetch request. */
+  std::thread prefetcher_thread_;
+  /** True while the prefetcher should keep running. Protected by latch_. */
+  bool prefetcher_running_{false};
+  /** Wakes up the prefetcher when pages are queued or it is stopped. Waits use latch_. */
+  std::condition_variable prefetch_cv_;
+
+  /** Number of pages loaded by warming up. */
+  std::atomic<size_t> warmed_up_pages_{0};
+  /** The warm-up thread, if started. */
+  std::thread warmup_thread_;
+  /** True while the warm-up should keep running. Protected by latch_. */
+  bool warmup_running_{false};
+
+  /** Serializes calls to ResizeImp(). */
+  std::mutex resize_latch_;
+  /** Wakes up a shrinking ResizeImp() when a frame it is retiring gets unpinned. Waits use latch_. */
+  std::condition_variable retire_cv_;
+
+  /** The access trace being recorded, or nullptr. Read without the latch by every traced call. */
+  std::atomic<AccessTraceWriter *> access_trace_{nullptr};
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
-   * @param page_id id of the page to deallocate
+   * Every trace this instance ever recorded to. They are kept alive until the instance is destroyed, because a call
+   * that loaded access_trace_ just before it was stopped may still record to it.
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
+  std::vector<std::shared_ptr<AccessTraceWriter>> access_traces_;
+
+  /** Record a call to the access trace, if one is being recorded. */
+  void TraceAccess(AccessType type, page_id_t page_id, uint8_t flags = 0) {
+    if (auto *trace = access_trace_.load(std::memory_order_acquire); trace != nullptr) {
+      trace->Record(type, page_id, flags);
+    }
   }
 
+  /**
+   * @brief Body of the prefetcher thread.
+   */
+  void RunPrefetcher();
+
+  /**
+   * @brief Stop and join the prefetcher thread, if it is running.
+   */
+  void StopPrefetcher();
+
+  /**
+   * @brief Body of the warm-up thread.
+   * @param page_ids the pages to preload, in ascending order
+   */
+  void RunWarmUp(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * @brief Stop and join the warm-up thread, if it is running.
+   */
+  void StopWarmUp();
+
+  /**
+   * @brief Read a batch of pages that are not resident into free frames, without pinning them.
+   * @param page_ids the pages, in ascending order
+   * @return false if the free frames ran out
+   */
+  auto PreloadPages(const std::vector<page_id_t> &page_ids) -> bool;
+
+  /**
+   * @brief Body of the background flusher thread.
+   */
+  void RunBackgroundFlusher(double target_clean_ratio, size_t pages_per_second);
+
+  /**
+   * @brief Write back up to max_pages dirty pages among the first `window` frames of the eviction order.
+   * @return the number of pages written
+   */
+  auto FlushEvictionCandidates(size_t window, size_t max_pages) -> size_t;
+
+  /** Frames taken for writing back by BeginFlushLocked(), with the ids of their pages. */
+  using FlushList = std::vector<std::pair<frame_id_t, page_id_t>>;
+
+  /**
+   * @brief Take a frame for writing back if its page is dirty: mark it clean and flushing, so that it can still be
+   * used but not evicted. Caller should acquire the latch. EndFlush() must be called once the page is written.
+   * @return false if the frame holds no dirty page, or is being read, written back or flushed already
+   */
+  auto BeginFlushLocked(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Take every frame that holds a dirty page for writing back, see BeginFlushLocked().
+   */
+  auto CollectDirtyFrames() -> FlushList;
+
+  /**
+   * @brief Release frames taken by BeginFlushLocked(), and make them evictable again if they are unpinned.
+   * @param written false if the write failed, in which case the pages are marked dirty again
+   */
+  void EndFlush(const FlushList &frames, bool written);
+
+  /**
+   * @brief Write back frames taken by BeginFlushLocked() in page id order, then release them.
+   */
+  void WriteBackFrames(FlushList *frames, DiskRequestPriority priority);
+
+  /**
+   * @brief Take a frame from the free list, or evict one. Caller should acquire the latch before calling this function.
+   *
+   * The evicted page is removed from the page table. If it is dirty, or has to be stored in the compressed cache, it is
+   * registered in writing_back_ and its id is returned in victim_page_id; the caller must then call WriteBackVictim()
+   * and FinishIo().
+   *
+   * If a strategy is given and the frame of its current ring slot can be recycled, that frame is used instead.
+   *
+   * @param[out] frame_id the acquired frame
+   * @param[out] victim_page_id the page that still has to be written back or stashed, or INVALID_PAGE_ID
+   * @param strategy the access strategy of the caller, or nullptr
+   * @param[out] reused set to true if the frame was recycled from the strategy's ring
+   * @return false if every frame is pinned
+   */
+  auto AcquireFrame(frame_id_t *frame_id, page_id_t *victim_page_id, BufferAccessStrategy *strategy = nullptr,
+                    bool *reused = nullptr) -> bool;
+
+  /**
+   * @brief Find the frame of the strategy's current ring slot. Caller should acquire the latch.
+   * @param[out] frame_id the frame of the slot
+   * @return false if the slot is empty or belongs to another instance, or if its frame was reused for another page,
+   * is pinned or has I/O in flight
+   */
+  auto FindRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Pin a resident page without taking the latch.
+   *
+   * The frame is pinned first, then the page table is checked again. This pairs with DetachFrame(), which removes the
+   * mapping first and then checks the pin count: either the hit sees the page leave the table and backs off, or the
+   * eviction sees the pin and gives up on the frame.
+   *
+   * @return nullptr if the page is not resident, its I/O is in progress, or it was evicted concurrently
+   */
+  auto TryPinResident(page_id_t page_id) -> Page *;
+
+  /**
+   * @brief Drop the pin of a failed TryPinResident(). Caller should acquire the latch.
+   */
+  void UndoTransientPin(frame_id_t frame_id);
+
+  /**
+   * @brief Drop the copy of a page that is being created from the pool and from the compressed cache. A prefetch or a
+   * warm-up may have read the id before it was created, from a free page or a reserved one, and NewPgImp() must not
+   * install a second frame for it. Caller should acquire the latch, which is released while a read of the copy ends.
+   */
+  void DropStaleCopy(page_id_t page_id, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * @brief Remove the page of a frame from the page table, unless the frame is pinned. Caller should acquire the latch.
+   * @return false if the frame is pinned, in which case the mapping is restored
+   */
+  auto DetachFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Retire a frame cut off by a shrinking ResizeImp(): write back its page if it is dirty and remove it from the
+   * page table. Caller must hold the latch through `lock`, which is released while the page is written back.
+   * @return false if the frame is pinned or has I/O in flight, and has to be retried later
+   */
+  auto RetireFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock) -> bool;
+
+  /**
+   * @brief Read a page that is not resident into a new frame, and pin it once.
+   *
+   * The caller must hold the latch through `lock`. It is released while the victim is written back and the page is
+   * read, and held again when this function returns or throws.
+   *
+   * @param page_id id of the page to read
+   * @param lock the caller's lock on latch_
+   * @param strategy the access strategy of the caller, or nullptr
+   * @return nullptr if every frame is pinned, otherwise the page
+   */
+  auto LoadPage(page_id_t page_id, std::unique_lock<std::mutex> *lock, BufferAccessStrategy *strategy = nullptr)
+      -> Page *;
+
+  /**
+   * @brief Write back the victim that AcquireFrame() evicted from a frame if it is dirty, and store it in the
+   * compressed cache. Called without the latch, before the frame is overwritten.
+   */
+  void WriteBackVictim(frame_id_t frame_id, page_id_t victim_page_id);
+
+  /**
+   * @brief Write a page to disk, through the disk scheduler if there is one. Called without the latch.
+   */
+  void WritePageData(page_id_t page_id, const char *page_data,
+                     DiskRequestPriority priority = DiskRequestPriority::FOREGROUND);
+
+  /**
+   * @brief Write a batch of pages, sorted by page id, through the disk scheduler if there is one, or with one
+   * DiskManager::WritePages() call. Called without the latch.
+   */
+  void WritePagesData(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data,
+                      DiskRequestPriority priority);
+
+  /**
+   * @brief Read a page from the compressed cache, or from disk if it is not there. Called without the latch.
+   */
+  void ReadPageData(page_id_t page_id, char *page_data);
+
+  /**
+   * @brief Read pages from the compressed cache, and the ones that are not there from disk with a single request.
+   * Called without the latch.
+   */
+  void ReadPagesData(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data);
+
+  /**
+   * @brief Map page_id to frame_id and pin the frame once. Caller should acquire the latch before calling this
+   * function.
+   *
+   * If the page is not ready yet, the caller must set the in_progress_ flag of the frame before calling this.
+   *
+   * @param record_access false if the caller records the access and pins the frame in the replacer itself
+   */
+  void InstallPage(frame_id_t frame_id, page_id_t page_id, bool record_access = true);
+
+  /**
+   * @brief Drop pins taken on a resident page, and make its frame evictable with the last one. Caller should acquire
+   * the latch.
+   */
+  void DropPins(frame_id_t frame_id, int count);
+
+  /**
+   * @brief Mark the I/O on a frame as complete and wake up its waiters. Caller should acquire the latch.
+   * @param victim_page_id the page written back by the frame, or INVALID_PAGE_ID
+   */
+  void FinishIo(frame_id_t frame_id, page_id_t victim_page_id);
+
+  /**
+   * @brief Undo InstallPage() after the I/O on a frame failed. Caller should acquire the latch.
+   */
+  void AbortIo(frame_id_t frame_id, page_id_t victim_page_id);
+
+  /**
+   * @brief Drop one pin on a frame whose read failed, and free the frame with the last pin. Caller should acquire the
+   * latch.
+   */
+  void ReleaseFailedFrame(frame_id_t frame_id);
+
+  /**
+   * @brief Allocate a page on disk, reusing a deallocated page of this instance if there is one. Caller should acquire
+   * the latch before calling this function.
+   * @param[out] recycled set to true if the page was deallocated before, and still holds its old data on disk
+   * @return the id of the allocated page, or INVALID_PAGE_ID if the default tablespace is full
+   */
+  auto AllocatePage(bool *recycled) -> page_id_t;
+
+  /**
+   * @brief Give back a page id of the last AllocatePage(), which ended up unused. Caller should acquire the latch.
+   * @param page_id id of the page
+   * @param recycled what AllocatePage() set recycled to
+   */
+  void ReturnPage(page_id_t page_id, bool recycled);
+
+  /** @return true if the page was handed out already, i.e. it may exist on disk */
+  auto IsAllocated(page_id_t page_id) const -> bool;
+
+  /**
+   * @return the lowest page id routed to the given instance that is past every page of the disk manager, in use or
+   * free, so that a pool opened on an existing database file does not hand out ids of pages already there
+   */
+  static auto FirstUnusedPageId(DiskManager *disk_manager, uint32_t num_instances, uint32_t instance_index)
+      -> page_id_t;
+
+  /**
+   * @brief Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions
+   * to validate input data and ensure that a parallel BPM is routing requests to the correct BPI.
+   * @param page_id id of the page to validate
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
+  /**
+   * @brief Deallocate a page on disk: it goes to the free page map of the disk manager, from which AllocatePage()
+   * takes it again. Caller should acquire the latch before calling this function.
+   * @param page_id id of the page to deallocate
+   */
+  void DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
+
   // TODO(student): You may add additional private members and helper functions
 };
 }  // namespace bustub
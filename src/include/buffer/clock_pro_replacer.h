@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer.h
+//
+// Identification: src/include/buffer/clock_pro_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ClockProReplacer implements CLOCK-Pro (Jiang, Chen and Zhang, USENIX ATC 2005), which approximates LIRS with clock
+ * hands instead of a stack.
+ *
+ * Resident pages are hot or cold. A cold page starts a test period when it is brought in; if it is accessed again
+ * within that period it has a small reuse distance and turns hot. Cold pages that are evicted during their test
+ * period stay in the clock as non-resident entries until the period ends, so that a quick return still counts.
+ * Three hands walk the clock:
+ *  - HAND_cold evicts cold pages, promoting the referenced ones instead;
+ *  - HAND_hot demotes unreferenced hot pages to cold and ends the test periods it passes;
+ *  - HAND_test ends test periods, dropping non-resident entries, to keep at most as many of them as there are frames.
+ * The number of frames reserved for cold pages adapts: it grows when a non-resident page is read back during its test
+ * period, and shrinks when a test period expires.
+ */
+class ClockProReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new ClockProReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit ClockProReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ClockProReplacer);
+
+  ~ClockProReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  void Resize(size_t num_frames) override;
+
+  auto Size() -> size_t override;
+
+  /** @return the number of frames currently reserved for cold pages */
+  auto GetColdTarget() -> size_t;
+
+ private:
+  struct ClockEntry {
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** The frame holding the page, only meaningful for resident entries. */
+    frame_id_t frame_id_{0};
+    bool resident_{true};
+    bool hot_{false};
+    bool referenced_{false};
+    bool in_test_{false};
+    bool evictable_{true};
+  };
+
+  using ClockIterator = std::list<ClockEntry>::iterator;
+
+  /** @return the entry after it, wrapping around. Caller must hold latch_. */
+  auto Next(ClockIterator it) -> ClockIterator;
+
+  /** Insert an entry at the list head, right behind HAND_hot. Caller must hold latch_. */
+  auto InsertAtHead(const ClockEntry &entry) -> ClockIterator;
+
+  /** Move an entry to the list head. Caller must hold latch_. */
+  void MoveToHead(ClockIterator it);
+
+  /** Unlink an entry from the clock, moving the hands pointing at it forward. Caller must hold latch_. */
+  void Erase(ClockIterator it);
+
+  /** Stop tracking a resident entry, and forget it. Caller must hold latch_. */
+  void Untrack(ClockIterator it);
+
+  /** Move HAND_hot until it demotes one hot page. Caller must hold latch_. */
+  void RunHandHot();
+
+  /** Move HAND_test until it drops one non-resident entry. Caller must hold latch_. */
+  void RunHandTest();
+
+  /** @return the largest cold target, which leaves room for at least one hot page */
+  auto MaxColdTarget() const -> size_t { return replacer_size_ > 1 ? replacer_size_ - 1 : 1; }
+
+  /** Demote hot pages until they fit in the frames not reserved for cold pages. Caller must hold latch_. */
+  void BalanceHot();
+
+  size_t replacer_size_;
+  /** Number of frames reserved for cold pages, m_c in the paper. */
+  size_t cold_target_;
+  std::list<ClockEntry> clock_;
+  ClockIterator hand_hot_;
+  ClockIterator hand_cold_;
+  ClockIterator hand_test_;
+  std::unordered_map<frame_id_t, ClockIterator> resident_;
+  std::unordered_map<page_id_t, ClockIterator> non_resident_;
+  size_t hot_count_{0};
+  /** Number of evictable frames, and how many of them hold cold pages. */
+  size_t evictable_count_{0};
+  size_t cold_evictable_count_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
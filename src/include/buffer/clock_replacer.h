@@ -12,7 +12,6 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
 #include <vector>
 
@@ -23,6 +22,9 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The clock hand sweeps over the frames in frame id order. An access sets the reference bit of a frame; the hand
+ * clears set bits as it passes and evicts the first evictable frame whose bit is already clear.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -37,16 +39,44 @@ class ClockReplacer : public Replacer {
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  using Replacer::RecordAccess;
 
-  void Pin(frame_id_t frame_id) override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  void Resize(size_t num_frames) override;
 
   auto Size() -> size_t override;
 
+  /** Evict the next frame the clock hand finds. Same as Evict(). */
+  auto Victim(frame_id_t *frame_id) -> bool { return Evict(frame_id); }
+
+  /** Stop a frame from being evicted. Same as SetEvictable(frame_id, false). */
+  void Pin(frame_id_t frame_id) { SetEvictable(frame_id, false); }
+
+  /** Make a frame evictable and set its reference bit, if it was not evictable before. */
+  void Unpin(frame_id_t frame_id);
+
  private:
-  // TODO(student): implement me!
+  struct FrameEntry {
+    bool tracked_{false};
+    bool evictable_{false};
+    bool referenced_{false};
+  };
+
+  std::vector<FrameEntry> frames_;
+  /** The frame the clock hand points at. */
+  size_t hand_{0};
+  /** Number of tracked, evictable frames. */
+  size_t curr_size_{0};
+  std::mutex latch_;
 };
 
 }  // namespace bustub
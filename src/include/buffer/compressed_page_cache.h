@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** A snapshot of the counters of a CompressedPageCache. */
+struct CompressedPageCacheStats {
+  /** Lookups that found the page. */
+  size_t hits_{0};
+  /** Lookups that did not find the page. */
+  size_t misses_{0};
+  /** Pages stored. */
+  size_t insertions_{0};
+  /** Pages not stored because they did not compress well enough. */
+  size_t rejections_{0};
+  /** Pages dropped to stay within the memory budget. */
+  size_t evictions_{0};
+  /** Pages currently stored. */
+  size_t num_pages_{0};
+  /** Compressed bytes currently stored. */
+  size_t bytes_used_{0};
+  /** The memory budget, in bytes. */
+  size_t memory_budget_{0};
+
+  /** @return the fraction of lookups that found the page */
+  auto HitRatio() const -> double {
+    return hits_ + misses_ == 0 ? 0.0 : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+  }
+
+  /** @return the number of pages stored per page worth of memory */
+  auto CompressionRatio() const -> double {
+    return bytes_used_ == 0 ? 0.0 : static_cast<double>(num_pages_ * BUSTUB_PAGE_SIZE) / bytes_used_;
+  }
+};
+
+/**
+ * CompressedPageCache is an in-memory victim cache that sits between the buffer pool and the disk manager. The buffer
+ * pool stores the pages it evicts, once they are clean, compressed with PageCodec, and looks misses up here before
+ * reading them from disk. It holds at most memory_budget bytes of compressed data, and drops the least recently stored
+ * pages to make room.
+ *
+ * The cache is exclusive: a page that is found is removed, since the buffer pool holds it again. It never holds dirty
+ * data, so dropping a page loses nothing. The cache is thread-safe and may be shared by several buffer pool instances.
+ */
+class CompressedPageCache {
+ public:
+  /**
+   * @brief Create a new CompressedPageCache.
+   * @param memory_budget the maximum number of compressed bytes to hold
+   * @param max_compressed_size pages that compress to more bytes than this are not stored
+   */
+  explicit CompressedPageCache(size_t memory_budget, size_t max_compressed_size = BUSTUB_PAGE_SIZE * 3 / 4);
+
+  DISALLOW_COPY_AND_MOVE(CompressedPageCache);
+
+  ~CompressedPageCache() = default;
+
+  /**
+   * @brief Compress and store a clean page, replacing the copy already stored, if any.
+   * @param page_id id of the page
+   * @param page_data the page, BUSTUB_PAGE_SIZE bytes
+   * @return false if the page did not compress well enough and was not stored
+   */
+  auto Insert(page_id_t page_id, const char *page_data) -> bool;
+
+  /**
+   * @brief Look a page up, and remove it if it is found.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer of BUSTUB_PAGE_SIZE bytes, filled if the page is found
+   * @return true if the page was found
+   */
+  auto Take(page_id_t page_id, char *page_data) -> bool;
+
+  /**
+   * @brief Drop a page, e.g. because it was deleted.
+   * @param page_id id of the page
+   */
+  void Erase(page_id_t page_id);
+
+  /** @return a snapshot of the counters */
+  auto GetStats() -> CompressedPageCacheStats;
+
+ private:
+  struct Entry {
+    std::string data_;
+    std::list<page_id_t>::iterator position_;
+  };
+
+  /** Drop a page. Caller must hold latch_. @return the compressed page */
+  auto EraseLocked(std::unordered_map<page_id_t, Entry>::iterator it) -> std::string;
+
+  const size_t max_compressed_size_;
+  /** Stored pages, least recently stored first. */
+  std::list<page_id_t> lru_;
+  std::unordered_map<page_id_t, Entry> entries_;
+  CompressedPageCacheStats stats_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
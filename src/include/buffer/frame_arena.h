@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/mman.h>
+
+#include <cstddef>
+#include <new>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena is the memory holding the data of every frame of a buffer pool.
+ *
+ * All frames live in one contiguous mapping, and frame i starts at byte i * BUSTUB_PAGE_SIZE. Every frame is
+ * therefore aligned to BUSTUB_PAGE_SIZE, which is what O_DIRECT I/O requires. Arenas that can hold a huge page are
+ * aligned to HUGE_PAGE_SIZE and, once they hold at least one and if enable_huge_pages is set, advised to be backed by
+ * transparent huge pages so that scanning a large pool takes fewer TLB misses.
+ *
+ * Address space for max_frames frames is reserved up front, so frames never move when the arena is resized. Only
+ * the first num_frames frames are backed by memory; frames cut off by a shrink give their memory back to the OS and
+ * read as zeros once the arena grows over them again.
+ *
+ * The frame metadata (page id, pin count, dirty flag, latch) is kept outside of the arena, in the Page objects.
+ */
+class FrameArena {
+ public:
+  /**
+   * @brief Map the memory for num_frames frames.
+   * @param num_frames number of frames in the arena
+   * @param max_frames number of frames the arena can grow to
+   */
+  FrameArena(size_t num_frames, size_t max_frames);
+
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @return the data of the given frame */
+  auto GetFrameData(frame_id_t frame_id) -> char * {
+    return data_ + static_cast<size_t>(frame_id) * BUSTUB_PAGE_SIZE;
+  }
+
+  /**
+   * @brief Back the first num_frames frames with memory, and release the memory of the frames after them. The caller
+   * must make sure that nobody uses the released frames anymore.
+   * @param num_frames new number of frames, at most GetMaxFrames()
+   */
+  void Resize(size_t num_frames);
+
+  /** @return the number of frames in the arena */
+  auto GetNumFrames() const -> size_t { return num_frames_; }
+
+  /** @return the number of frames the arena can grow to */
+  auto GetMaxFrames() const -> size_t { return max_frames_; }
+
+  /** @return true if the arena was advised to be backed by huge pages */
+  auto UsesHugePages() const -> bool { return huge_pages_; }
+
+ private:
+  /** Number of frames in the arena. */
+  size_t num_frames_{0};
+  /** Number of frames the address space is reserved for. */
+  size_t max_frames_;
+  /** Start of the whole mapping, which may begin before data_ to leave room for alignment. */
+  void *mapping_;
+  /** Length of the whole mapping. */
+  size_t mapping_size_;
+  /** Start of the first frame. */
+  char *data_;
+  /** True if the arena was madvise()d for huge pages. */
+  bool huge_pages_{false};
+};
+
+/**
+ * FrameArray is an array of per-frame objects, such as the Page metadata of a buffer pool.
+ *
+ * Like FrameArena, it reserves address space for max_frames elements up front so that elements never move. Elements
+ * are constructed the first time the array grows over them and are kept until the array is destroyed, even when the
+ * pool shrinks, because threads that don't hold the buffer pool latch may still look at the metadata of a retired
+ * frame before finding out that it does not hold their page.
+ */
+template <typename T>
+class FrameArray {
+ public:
+  /**
+   * @brief Create an array of num_frames elements.
+   * @param num_frames number of elements to construct now
+   * @param max_frames number of elements the array can grow to
+   */
+  FrameArray(size_t num_frames, size_t max_frames) : max_frames_(max_frames) {
+    auto *mapping =
+        mmap(nullptr, max_frames_ * sizeof(T), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    elements_ = static_cast<T *>(mapping);
+    Grow(num_frames);
+  }
+
+  ~FrameArray() {
+    for (size_t i = 0; i < num_constructed_; i++) {
+      elements_[i].~T();
+    }
+    munmap(elements_, max_frames_ * sizeof(T));
+  }
+
+  DISALLOW_COPY_AND_MOVE(FrameArray);
+
+  /**
+   * @brief Make the array hold at least num_frames elements, constructing the ones that never were.
+   * @param num_frames new number of elements, at most the reserved size
+   */
+  void Grow(size_t num_frames) {
+    BUSTUB_ASSERT(num_frames <= max_frames_, "FrameArray can't grow beyond its reserved size");
+    if (num_frames <= num_constructed_) {
+      return;
+    }
+    if (mprotect(elements_, num_frames * sizeof(T), PROT_READ | PROT_WRITE) != 0) {
+      throw std::bad_alloc();
+    }
+    for (; num_constructed_ < num_frames; num_constructed_++) {
+      new (&elements_[num_constructed_]) T();
+    }
+  }
+
+  auto operator[](size_t index) -> T & { return elements_[index]; }
+
+  /** @return the first element */
+  auto Data() -> T * { return elements_; }
+
+ private:
+  /** Number of elements the address space is reserved for. */
+  size_t max_frames_;
+  /** Number of elements that have been constructed. */
+  size_t num_constructed_{0};
+  T *elements_;
+};
+
+}  // namespace bustub
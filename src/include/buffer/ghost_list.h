@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// ghost_list.h
+//
+// Identification: src/include/buffer/ghost_list.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * GhostList remembers the ids of pages that were evicted recently, oldest first, so that a replacer can tell when
+ * one of them is read back. It holds no frames. Not thread-safe, the replacer that owns it synchronizes access.
+ */
+class GhostList {
+ public:
+  /** @return the number of pages in the list */
+  auto Size() const -> size_t { return pages_.size(); }
+
+  /** @return true if the page is in the list */
+  auto Contains(page_id_t page_id) const -> bool { return positions_.count(page_id) != 0; }
+
+  /** Add a page as the most recent one. */
+  void PushBack(page_id_t page_id) {
+    Erase(page_id);
+    pages_.push_back(page_id);
+    positions_[page_id] = std::prev(pages_.end());
+  }
+
+  /** Forget the oldest page. */
+  void PopFront() {
+    positions_.erase(pages_.front());
+    pages_.pop_front();
+  }
+
+  /**
+   * Forget a page.
+   * @return true if the page was in the list
+   */
+  auto Erase(page_id_t page_id) -> bool {
+    auto it = positions_.find(page_id);
+    if (it == positions_.end()) {
+      return false;
+    }
+    pages_.erase(it->second);
+    positions_.erase(it);
+    return true;
+  }
+
+  /** Forget the oldest pages until at most max_size are left. */
+  void TrimTo(size_t max_size) {
+    while (pages_.size() > max_size) {
+      PopFront();
+    }
+  }
+
+ private:
+  std::list<page_id_t> pages_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> positions_;
+};
+
+}  // namespace bustub
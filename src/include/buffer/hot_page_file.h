@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hot_page_file.h
+//
+// Identification: src/include/buffer/hot_page_file.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * HotPageFile saves the hot page set of a buffer pool, i.e. the ids of its resident pages hottest first, to a sidecar
+ * file of the database so that the next instance can preload them with BufferPoolManager::WarmUp().
+ */
+class HotPageFile {
+ public:
+  /**
+   * Write a hot page set. The file is written as a PageIdFile, so a crash never leaves a partial file behind.
+   * @param file_name path of the file
+   * @param page_ids the page ids, hottest first
+   * @return false if the file could not be written
+   */
+  static auto Write(const std::string &file_name, const std::vector<page_id_t> &page_ids) -> bool;
+
+  /**
+   * Read a hot page set.
+   * @param file_name path of the file
+   * @return the page ids hottest first, or std::nullopt if the file does not exist or is not a hot page file
+   */
+  static auto Read(const std::string &file_name) -> std::optional<std::vector<page_id_t>>;
+
+  /** @return the path of the hot page file that goes with a database file */
+  static auto FileNameFor(const std::string &db_file_name) -> std::string;
+};
+
+}  // namespace bustub
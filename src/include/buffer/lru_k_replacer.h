@@ -13,14 +13,17 @@
 #pragma once
 
 #include <ctime>
+#include <deque>
 #include <exception>
 #include <limits>
 #include <list>
 #include <mutex>  // NOLINT
-#include <queue>
+#include <set>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
@@ -36,8 +39,11 @@ namespace bustub {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * Evictable frames are kept in two ordered sets, one for frames with +inf k-distance and one for the rest, so that
+ * Evict, RecordAccess, SetEvictable and Remove all run in O(log n) instead of scanning every frame.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
    *
@@ -55,7 +61,9 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
+
+  using Replacer::RecordAccess;
 
   /**
    * TODO(P1): Add implementation
@@ -73,7 +81,7 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
    * TODO(P1): Add implementation
@@ -86,7 +94,7 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame that received a new access.
    */
-  void RecordAccess(frame_id_t frame_id);
+  void RecordAccess(frame_id_t frame_id) override;
 
   /**
    * TODO(P1): Add implementation
@@ -105,7 +113,19 @@ class LRUKReplacer {
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  /**
+   * @brief Record an access to each frame and make it non-evictable, taking the latch once.
+   * @param frames the (frame id, page id) pairs of the frames that were pinned
+   */
+  void PinFrames(const std::vector<std::pair<frame_id_t, page_id_t>> &frames) override;
+
+  /**
+   * @brief Make each of the frames evictable, taking the latch once.
+   * @param frames the ids of the frames whose last pin was dropped
+   */
+  void UnpinFrames(const std::vector<frame_id_t> &frames) override;
 
   /**
    * TODO(P1): Add implementation
@@ -124,7 +144,23 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
+
+  /**
+   * @brief Peek at the frames that Evict() would return next, in eviction order, without evicting them.
+   *
+   * @param max_frames the maximum number of frames to return
+   * @return up to max_frames evictable frames, next victim first
+   */
+  auto EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  /**
+   * @brief Change the number of frames the replacer accepts. When shrinking, the access history of the frames that are
+   * cut off is dropped; the caller must make sure that none of them is in use anymore.
+   *
+   * @param num_frames the new maximum number of frames
+   */
+  void Resize(size_t num_frames) override;
 
   /**
    * TODO(P1): Add implementation
@@ -133,22 +169,48 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
+  /**
+   * Per-frame bookkeeping. `history_` holds the timestamps of the last (up to) k accesses, oldest first, so its front
+   * is both the earliest access of a frame with fewer than k accesses and the k-th most recent access otherwise.
+   */
+  struct FrameEntry {
+    bool evictable_{true};
+    std::deque<size_t> history_;
+  };
+
+  /** Ordering key of an evictable frame: (timestamp at the front of its history, frame id). */
+  using EvictKey = std::pair<size_t, frame_id_t>;
+
+  /** @return the ordered set an evictable frame with this entry belongs to */
+  auto SetOf(const FrameEntry &entry) -> std::set<EvictKey> & {
+    return entry.history_.size() < k_ ? history_frames_ : cache_frames_;
+  }
+
+  /** Add an evictable frame to its ordered set. Caller must hold latch_. */
+  void Link(frame_id_t frame_id, const FrameEntry &entry) { SetOf(entry).emplace(entry.history_.front(), frame_id); }
+
+  /** Remove an evictable frame from its ordered set. Caller must hold latch_. */
+  void Unlink(frame_id_t frame_id, const FrameEntry &entry) { SetOf(entry).erase({entry.history_.front(), frame_id}); }
+
+  /** RecordAccess() without taking the latch. Caller must hold latch_. */
+  void RecordAccessLocked(frame_id_t frame_id);
+
+  /** SetEvictable() without taking the latch. Caller must hold latch_. */
+  void SetEvictableLocked(frame_id_t frame_id, bool set_evictable);
+
   size_t current_timestamp_{0};
-  // size_t curr_size_{0};
+  size_t curr_size_{0};
   size_t replacer_size_;
   size_t k_;
-  struct Frame {
-    bool evictable_;
-    std::queue<size_t> timestamps_;
-    int k_value_;
-  };
 
-  std::unordered_map<frame_id_t, Frame> id_to_frames_;
+  std::unordered_map<frame_id_t, FrameEntry> id_to_frames_;
+  /** Evictable frames with fewer than k accesses (+inf backward k-distance), ordered by earliest access. */
+  std::set<EvictKey> history_frames_;
+  /** Evictable frames with k accesses, ordered by k-th most recent access, i.e. largest k-distance first. */
+  std::set<EvictKey> cache_frames_;
 
   std::mutex latch_;
 };
@@ -12,8 +12,10 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,6 +25,8 @@ namespace bustub {
 
 /**
  * LRUReplacer implements the Least Recently Used replacement policy.
+ *
+ * Evictable frames are kept in a set ordered by their last access, so every operation runs in O(log n).
  */
 class LRUReplacer : public Replacer {
  public:
@@ -37,16 +41,43 @@ class LRUReplacer : public Replacer {
    */
   ~LRUReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  using Replacer::RecordAccess;
 
-  void Pin(frame_id_t frame_id) override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  void Resize(size_t num_frames) override;
 
   auto Size() -> size_t override;
 
+  /** Evict the least recently used frame. Same as Evict(). */
+  auto Victim(frame_id_t *frame_id) -> bool { return Evict(frame_id); }
+
+  /** Stop a frame from being evicted. Same as SetEvictable(frame_id, false). */
+  void Pin(frame_id_t frame_id) { SetEvictable(frame_id, false); }
+
+  /** Make a frame evictable, as its most recent use if it was not evictable before. */
+  void Unpin(frame_id_t frame_id);
+
  private:
-  // TODO(student): implement me!
+  struct FrameEntry {
+    bool evictable_{true};
+    size_t last_access_{0};
+  };
+
+  size_t current_timestamp_{0};
+  size_t replacer_size_;
+  std::unordered_map<frame_id_t, FrameEntry> frames_;
+  /** Evictable frames, as (last access, frame id), least recently used first. */
+  std::set<std::pair<size_t, frame_id_t>> evictable_;
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_codec.h
+//
+// Identification: src/include/buffer/page_codec.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace bustub {
+
+/**
+ * PageCodec is a small LZ77 compressor for page images, in the spirit of LZ4: it trades compression ratio for speed
+ * and has no dependencies. The output is a sequence of tokens. A token byte with the high bit clear is followed by
+ * (byte + 1) literal bytes. A token byte with the high bit set is a match of (byte & 0x7f) + 4 bytes, followed by the
+ * 2-byte little-endian distance back to the start of the match, which may overlap the bytes it produces.
+ */
+class PageCodec {
+ public:
+  /**
+   * Compress a buffer.
+   * @param src the data to compress
+   * @param size number of bytes in src, at most 65536
+   * @param[out] dst the compressed data, replacing the previous content
+   */
+  static void Compress(const char *src, size_t size, std::string *dst);
+
+  /**
+   * Decompress a buffer produced by Compress().
+   * @param src the compressed data
+   * @param src_size number of bytes in src
+   * @param[out] dst output buffer of `size` bytes
+   * @param size the size of the original data
+   * @return false if src is corrupt or does not decompress to exactly `size` bytes
+   */
+  static auto Decompress(const char *src, size_t src_size, char *dst, size_t size) -> bool;
+
+ private:
+  static constexpr size_t MIN_MATCH = 4;
+  static constexpr size_t MAX_MATCH = 0x7f + MIN_MATCH;
+  static constexpr size_t MAX_LITERALS = 0x80;
+  static constexpr size_t MAX_DISTANCE = 0xffff;
+  static constexpr size_t HASH_BITS = 12;
+};
+
+}  // namespace bustub
@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_extent.h
+//
+// Identification: src/include/buffer/page_extent.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageExtent is a run of contiguous page ids reserved for one table or index, from which it allocates its pages with
+ * BufferPoolManager::NewPage(page_id_t *, PageExtent &).
+ *
+ * Pages created one after the other by the same object then sit next to each other in the database file, even when
+ * other objects allocate pages in between, so that following the page chain of a table heap or the leaves of a
+ * B+ tree reads the file sequentially. Once the extent is used up the next NewPage() reserves a new one.
+ *
+ * The extent is not persistent: the ids left over when its owner goes away are never handed out.
+ *
+ * The extents of an object placed in a tablespace other than the default one are reserved in the file of that
+ * tablespace, see DiskManager::AllocateExtent().
+ */
+class PageExtent {
+ public:
+  /**
+   * @param num_pages number of pages reserved at once
+   * @param tablespace the tablespace the pages are reserved in
+   */
+  explicit PageExtent(size_t num_pages = EXTENT_SIZE, tablespace_id_t tablespace = DEFAULT_TABLESPACE)
+      : num_pages_(num_pages > 0 ? num_pages : 1), tablespace_(tablespace) {}
+
+  DISALLOW_COPY_AND_MOVE(PageExtent);
+
+  /** @return the number of pages reserved at once */
+  auto GetSize() const -> size_t { return num_pages_; }
+
+  /** @return the tablespace the pages are reserved in */
+  auto GetTablespace() const -> tablespace_id_t { return tablespace_; }
+
+  /** @return true if every page of the current extent was handed out, or none was reserved yet */
+  auto IsExhausted() const -> bool { return next_ == end_; }
+
+  /** @return the next page id of the extent, which must not be exhausted */
+  auto Peek() const -> page_id_t { return next_; }
+
+  /** Hand out the page returned by Peek(). */
+  void Advance() { next_++; }
+
+  /** Start handing out the pages of a new extent [first_page_id, first_page_id + GetSize()). */
+  void Assign(page_id_t first_page_id) {
+    next_ = first_page_id;
+    end_ = first_page_id + static_cast<page_id_t>(num_pages_);
+  }
+
+  /** @return the latch that serializes the allocations of concurrent users of the extent */
+  auto GetLatch() -> std::mutex & { return latch_; }
+
+ private:
+  const size_t num_pages_;
+  const tablespace_id_t tablespace_;
+  std::mutex latch_;
+  page_id_t next_{INVALID_PAGE_ID};
+  page_id_t end_{INVALID_PAGE_ID};
+};
+
+}  // namespace bustub
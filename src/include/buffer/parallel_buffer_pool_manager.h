@@ -0,0 +1,234 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/config.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards the buffer pool across several independent BufferPoolManagerInstances.
+ *
+ * Every page id is owned by exactly one instance (page_id % num_instances), so each instance keeps its own latch,
+ * page table, replacer and free list, and threads working on pages of different instances never contend.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each instance
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_policy the policy picking the frames to evict in each instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacerPolicy replacer_policy = ReplacerPolicy::LRU_K);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, i.e. the number of frames across all instances */
+  auto GetPoolSize() -> size_t override;
+
+  /** @return the number of BufferPoolManagerInstances this parallel BPM is made of */
+  auto GetNumInstances() const -> size_t { return num_instances_; }
+
+  /** Start the background flusher of every instance, see BufferPoolManagerInstance::StartBackgroundFlusher(). */
+  void StartBackgroundFlusher(double target_clean_ratio = BG_FLUSH_TARGET_CLEAN_RATIO,
+                              size_t pages_per_second = BG_FLUSH_PAGES_PER_SEC);
+
+  /** Stop the background flusher of every instance. */
+  void StopBackgroundFlusher();
+
+  /**
+   * Share one compressed victim cache between every instance, see BufferPoolManagerInstance::SetCompressedCache().
+   * @param cache the cache, or nullptr to go straight to disk
+   */
+  void SetCompressedCache(const std::shared_ptr<CompressedPageCache> &cache);
+
+  /**
+   * Share one disk scheduler between every instance, see BufferPoolManagerInstance::SetDiskScheduler().
+   * @param scheduler the scheduler, or nullptr to call the disk manager directly
+   */
+  void SetDiskScheduler(const std::shared_ptr<DiskScheduler> &scheduler);
+
+  /** Wait for every instance to finish warming up. */
+  void WaitForWarmUp();
+
+  /** @return the number of pages loaded by warming up, across all instances */
+  auto GetWarmUpCount() const -> size_t;
+
+  /** @return the number of evictions that had to write a dirty victim back synchronously, across all instances */
+  auto GetSyncWriteBackCount() const -> size_t;
+
+ protected:
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling given page id
+   */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance *;
+
+  /**
+   * Fetch the requested page from the buffer pool.
+   * @param page_id id of page to be fetched
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * Fetch the requested page from the instance that owns it, through the given access strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the ring of frames to recycle on a miss, or nullptr
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * Unpin the target page from the buffer pool.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /**
+   * Splits the batch by owning instance and fetches each part as one batch of that instance.
+   * @param page_ids ids of the pages to be fetched
+   * @return the fetched pages in the order of page_ids, or an empty vector if any of them cannot be fetched
+   */
+  auto FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> override;
+
+  /**
+   * Splits the batch by owning instance and unpins each part as one batch of that instance.
+   * @param page_ids ids of the pages to be unpinned
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   * @return false if any of the pages was not pinned, true otherwise
+   */
+  auto UnpinPgsImp(const std::vector<page_id_t> &page_ids, bool is_dirty) -> bool override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Creates a new page in the buffer pool. Instances are tried in round-robin order, starting from a different
+   * instance on every call, until one of them has a frame available.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id) -> Page * override;
+
+  /**
+   * Creates a new page like NewPgImp(), through the given access strategy.
+   * @param[out] page_id id of created page
+   * @param strategy the ring of frames to recycle, or nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * Reserves num_pages contiguous page ids. The range spans every instance, so it is cut out of the ids of all of them
+   * at once: each instance continues allocating past the end of the range. The ranges of other tablespaces than the
+   * default one are reserved by the disk manager.
+   * @param tablespace the tablespace of the range
+   * @param num_pages number of pages to reserve
+   * @return the first page id of the range
+   */
+  auto AllocateExtentImp(tablespace_id_t tablespace, size_t num_pages) -> page_id_t override;
+
+  /**
+   * Creates a new page with a reserved id in the instance that owns it.
+   * @param page_id the reserved id
+   * @return nullptr if the page could not be created, otherwise pointer to new page
+   */
+  auto NewReservedPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * Deletes a page from the buffer pool.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Flushes all the pages in the buffer pool to disk. The dirty pages of every instance are written as one batch
+   * sorted by page id, since adjacent pages belong to different instances.
+   */
+  void FlushAllPgsImp() override;
+
+  /**
+   * Flushes all the pages, then syncs the shared disk manager once.
+   */
+  void SyncAllPgsImp() override;
+
+  /**
+   * Routes every page of the range to the instance that owns it.
+   * @param first_page_id id of the first page to be prefetched
+   * @param num_pages number of consecutive pages to prefetch
+   */
+  void PrefetchPgsImp(page_id_t first_page_id, size_t num_pages) override;
+
+  /**
+   * Resizes every instance to an equal share of new_pool_size, rounded up.
+   * @param new_pool_size the new total number of frames
+   * @return false if the instances can't be resized to their share
+   */
+  auto ResizeImp(size_t new_pool_size) -> bool override;
+
+  /**
+   * Merges the hot page sets of the instances, taking one page from each instance in turn.
+   * @return the hot page set
+   */
+  auto HotPagesImp() -> std::vector<page_id_t> override;
+
+  /**
+   * Makes every instance warm up with the pages it owns.
+   * @param page_ids the hot page set, hottest first
+   */
+  void WarmUpImp(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * Makes every instance record to the same access trace.
+   * @param trace the trace to record to, or nullptr to stop
+   */
+  void SetAccessTraceImp(std::shared_ptr<AccessTraceWriter> trace) override;
+
+ private:
+  /** Number of BufferPoolManagerInstances. */
+  const size_t num_instances_;
+  /** Number of frames in each BufferPoolManagerInstance. */
+  std::atomic<size_t> pool_size_;
+  /** The BufferPoolManagerInstances, instance i owns every page id with page_id % num_instances_ == i. */
+  std::vector<BufferPoolManagerInstance *> instances_;
+  /** The instance NewPgImp starts searching from on its next call. */
+  std::atomic<size_t> next_instance_{0};
+};
+
+}  // namespace bustub
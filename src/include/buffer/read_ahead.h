@@ -0,0 +1,44 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead.h
+//
+// Identification: src/include/buffer/read_ahead.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ReadAhead detects sequential page accesses of a single scan and prefetches the pages that follow.
+ *
+ * Once two consecutive page ids have been accessed, it keeps up to `read_ahead_window` pages in flight ahead of the
+ * scan, and issues the next batch when half of the window has been consumed. A non-sequential access resets it.
+ */
+class ReadAhead {
+ public:
+  explicit ReadAhead(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+  /**
+   * Record that the scan moved to the given page, and prefetch the following pages if the scan is sequential.
+   * @param page_id id of the page the scan is reading
+   */
+  void OnPageAccess(page_id_t page_id);
+
+ private:
+  BufferPoolManager *bpm_;
+  /** The last page the scan accessed. */
+  page_id_t last_page_id_{INVALID_PAGE_ID};
+  /** Pages up to (excluding) this id have already been prefetched. */
+  page_id_t prefetched_until_{INVALID_PAGE_ID};
+};
+
+}  // namespace bustub
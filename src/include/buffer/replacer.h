@@ -12,12 +12,24 @@
 
 #pragma once
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "common/config.h"
+#include "fmt/format.h"
 
 namespace bustub {
 
+/** The replacement policies a buffer pool can be created with. */
+enum class ReplacerPolicy { LRU, CLOCK, LRU_K, ARC, TWO_QUEUE, CLOCK_PRO };
+
 /**
- * Replacer is an abstract class that tracks page usage.
+ * Replacer is an abstract class that tracks frame usage and picks the frame to evict.
+ *
+ * A frame is tracked from its first recorded access until it is evicted or removed. Tracked frames are either
+ * evictable or not; only evictable frames are candidates for eviction. Every replacer is safe to call from several
+ * threads at once.
  */
 class Replacer {
  public:
@@ -25,26 +37,116 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
+   * Evict the victim frame as defined by the replacement policy, and stop tracking it.
+   * @param[out] frame_id id of frame that was evicted
    * @return true if a victim frame was found, false otherwise
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * Record an access to a frame. A frame that is not tracked yet starts being tracked as evictable.
+   * @param frame_id the id of the frame that was accessed
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void RecordAccess(frame_id_t frame_id) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * Record an access to a frame holding the given page. Policies that remember recently evicted pages override this
+   * to recognize pages that come back; by default the page is ignored.
+   * @param frame_id the id of the frame that was accessed
+   * @param page_id the page the frame holds
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual void RecordAccess(frame_id_t frame_id, page_id_t page_id) { RecordAccess(frame_id); }
 
-  /** @return the number of elements in the replacer that can be victimized */
+  /**
+   * Record an access to each frame and make it non-evictable, as a buffer pool pinning them one by one would.
+   * Policies override this to take their latch once for the whole batch.
+   * @param frames the (frame id, page id) pairs of the frames that were pinned
+   */
+  virtual void PinFrames(const std::vector<std::pair<frame_id_t, page_id_t>> &frames) {
+    for (const auto &[frame_id, page_id] : frames) {
+      RecordAccess(frame_id, page_id);
+      SetEvictable(frame_id, false);
+    }
+  }
+
+  /**
+   * Make each of the frames evictable, as a buffer pool unpinning them one by one would.
+   * @param frames the ids of the frames whose last pin was dropped
+   */
+  virtual void UnpinFrames(const std::vector<frame_id_t> &frames) {
+    for (auto frame_id : frames) {
+      SetEvictable(frame_id, true);
+    }
+  }
+
+  /**
+   * Make a tracked frame evictable or not. Does nothing for frames that are not tracked.
+   * @param frame_id the id of the frame
+   * @param set_evictable whether the frame can be evicted
+   */
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
+
+  /**
+   * Stop tracking an evictable frame, no matter where it is in the eviction order. Does nothing for frames that are
+   * not tracked.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) = 0;
+
+  /**
+   * Peek at the frames that Evict() would return next, in eviction order, without evicting them. Policies that
+   * change their state while looking for a victim return their best guess.
+   * @param max_frames the maximum number of frames to return
+   * @return up to max_frames evictable frames, next victim first
+   */
+  virtual auto EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> = 0;
+
+  /**
+   * Change the number of frames the replacer accepts. When shrinking, the frames that are cut off stop being tracked;
+   * the caller must make sure that none of them is in use anymore.
+   * @param num_frames the new maximum number of frames
+   */
+  virtual void Resize(size_t num_frames) = 0;
+
+  /** @return the number of tracked frames that can be evicted */
   virtual auto Size() -> size_t = 0;
 };
 
+/**
+ * Create a replacer.
+ * @param policy the replacement policy
+ * @param num_frames the maximum number of frames the replacer will be required to track
+ * @param k the lookback constant, only used by LRU-K
+ */
+auto MakeReplacer(ReplacerPolicy policy, size_t num_frames, size_t k = LRUK_REPLACER_K) -> std::unique_ptr<Replacer>;
+
 }  // namespace bustub
+
+template <>
+struct fmt::formatter<bustub::ReplacerPolicy> : formatter<string_view> {
+  template <typename FormatContext>
+  auto format(bustub::ReplacerPolicy c, FormatContext &ctx) const {
+    string_view name;
+    switch (c) {
+      case bustub::ReplacerPolicy::LRU:
+        name = "LRU";
+        break;
+      case bustub::ReplacerPolicy::CLOCK:
+        name = "CLOCK";
+        break;
+      case bustub::ReplacerPolicy::LRU_K:
+        name = "LRU-K";
+        break;
+      case bustub::ReplacerPolicy::ARC:
+        name = "ARC";
+        break;
+      case bustub::ReplacerPolicy::TWO_QUEUE:
+        name = "2Q";
+        break;
+      case bustub::ReplacerPolicy::CLOCK_PRO:
+        name = "CLOCK-Pro";
+        break;
+    }
+    return formatter<string_view>::format(name, ctx);
+  }
+};
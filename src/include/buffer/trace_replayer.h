@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trace_replayer.h
+//
+// Identification: src/include/buffer/trace_replayer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/access_trace.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/** What replaying a page-access trace against a replacer measured. */
+struct ReplayStats {
+  ReplacerPolicy policy_;
+  size_t num_frames_;
+  /** Number of page accesses replayed, and how many found their page in a frame. */
+  uint64_t accesses_{0};
+  uint64_t hits_{0};
+  /** Time spent in the replacer per access, in nanoseconds. */
+  double mean_latency_ns_{0};
+  uint64_t p99_latency_ns_{0};
+  uint64_t max_latency_ns_{0};
+
+  auto HitRatio() const -> double { return accesses_ == 0 ? 0 : static_cast<double>(hits_) / accesses_; }
+};
+
+/**
+ * TraceReplayer simulates a buffer pool of num_frames frames on top of a replacer, without any page data or I/O, so
+ * that page-access traces can be replayed against every replacement policy and their hit ratios compared.
+ *
+ * Each access makes the same replacer calls BufferPoolManagerInstance makes for a fetch followed by an unpin: a miss
+ * takes a free frame or evicts one, then the frame's access is recorded and it is pinned and unpinned. The time
+ * spent in those calls is the per-access latency.
+ */
+class TraceReplayer {
+ public:
+  /**
+   * @brief Create a replayer with an empty pool.
+   * @param policy the replacement policy to replay against
+   * @param num_frames the number of frames in the simulated pool
+   * @param k the lookback constant, only used by LRU-K
+   */
+  TraceReplayer(ReplacerPolicy policy, size_t num_frames, size_t k = LRUK_REPLACER_K);
+
+  /** Fetch and unpin a page. */
+  void Access(page_id_t page_id);
+
+  /** Drop a deleted page from the pool, freeing its frame. */
+  void Delete(page_id_t page_id);
+
+  /**
+   * Replay one record of a buffer pool access trace. Fetches and new pages are accesses, deletes free their frame.
+   * Unpins are skipped: every access is unpinned right away, so the pool never runs out of evictable frames.
+   */
+  void Replay(const AccessTraceRecord &record);
+
+  /** @return the statistics of the accesses replayed so far */
+  auto GetStats() const -> ReplayStats;
+
+  /** Replay a whole trace of page accesses against a fresh pool. */
+  static auto Replay(ReplacerPolicy policy, size_t num_frames, const std::vector<page_id_t> &trace,
+                     size_t k = LRUK_REPLACER_K) -> ReplayStats;
+
+ private:
+  ReplacerPolicy policy_;
+  size_t num_frames_;
+  std::unique_ptr<Replacer> replacer_;
+  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  std::vector<page_id_t> frame_pages_;
+  std::list<frame_id_t> free_list_;
+  uint64_t hits_{0};
+  std::vector<uint64_t> latencies_ns_;
+};
+
+}  // namespace bustub
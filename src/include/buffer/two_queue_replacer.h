@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the full 2Q policy (Johnson and Shasha, VLDB 1994).
+ *
+ * A page read for the first time enters A1in, a FIFO queue of about a quarter of the frames. Accesses while it sits
+ * there are treated as correlated (the same query touching the page again) and don't promote it. When it falls out
+ * of A1in its id is remembered in A1out, a ghost FIFO of about half the frames; a page read back while in A1out has
+ * proven to be hot and enters Am, which is managed as LRU. A scan therefore only ever churns A1in.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new TwoQueueReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit TwoQueueReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQueueReplacer);
+
+  ~TwoQueueReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  void Resize(size_t num_frames) override;
+
+  auto Size() -> size_t override;
+
+ private:
+  struct FrameEntry {
+    page_id_t page_id_{INVALID_PAGE_ID};
+    bool in_am_{false};
+    bool evictable_{true};
+    /** Time of the first access in A1in, of the last access in Am. */
+    size_t timestamp_{0};
+  };
+
+  /** Ordering key of an evictable frame: (timestamp, frame id). */
+  using EvictKey = std::pair<size_t, frame_id_t>;
+
+  auto EvictableSetOf(const FrameEntry &entry) -> std::set<EvictKey> & {
+    return entry.in_am_ ? am_evictable_ : a1in_evictable_;
+  }
+
+  /** @return true if the next victim should come from A1in. Caller must hold latch_ and have an evictable frame. */
+  auto ShouldEvictFromA1in() -> bool;
+
+  /** Size Kin of A1in and Kout of A1out for the current number of frames. Caller must hold latch_. */
+  void SetQueueSizes();
+
+  /** Stop tracking a frame. Caller must hold latch_. */
+  void Untrack(std::unordered_map<frame_id_t, FrameEntry>::iterator it);
+
+  size_t replacer_size_;
+  /** Size A1in is kept at when Am has frames to give. */
+  size_t kin_;
+  /** Number of pages A1out remembers. */
+  size_t kout_;
+  size_t current_timestamp_{0};
+  std::unordered_map<frame_id_t, FrameEntry> frames_;
+  /** Number of frames in A1in, evictable or not. */
+  size_t a1in_size_{0};
+  /** Evictable frames of A1in, oldest first, and of Am, least recently used first. */
+  std::set<EvictKey> a1in_evictable_;
+  std::set<EvictKey> am_evictable_;
+  /** Pages recently evicted from A1in. */
+  GhostList a1out_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
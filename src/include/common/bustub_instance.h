@@ -26,6 +26,8 @@
 #include "common/config.h"
 #include "common/util/string_util.h"
 #include "libfort/lib/fort.hpp"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/tablespace_disk_manager.h"
 #include "type/value.h"
 
 namespace bustub {
@@ -33,6 +35,7 @@ namespace bustub {
 class Transaction;
 class ExecutorContext;
 class DiskManager;
+class DiskScheduler;
 class BufferPoolManager;
 class LockManager;
 class TransactionManager;
@@ -210,13 +213,52 @@ class BustubInstance {
    */
   auto MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext>;
 
+  /**
+   * Create the buffer pool for this BusTub instance, sharded into `bpm_instances` instances.
+   */
+  auto MakeBufferPoolManager(size_t bpm_instances) -> BufferPoolManager *;
+
+  /** Total number of frames in the buffer pool of a BusTub instance. */
+  static constexpr size_t BUSTUB_INSTANCE_POOL_SIZE = 128;
+
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  /**
+   * Create a BusTub instance backed by the given database file.
+   * @param db_file_name the database file
+   * @param bpm_instances number of buffer pool shards; more than one selects a ParallelBufferPoolManager
+   * @param io_mode how the database file is accessed; DIRECT keeps the pages out of the OS page cache
+   */
+  explicit BustubInstance(const std::string &db_file_name, size_t bpm_instances = 1,
+                          DiskIoMode io_mode = DiskIoMode::BUFFERED);
 
-  BustubInstance();
+  /**
+   * Create a BusTub instance backed by memory.
+   * @param bpm_instances number of buffer pool shards; more than one selects a ParallelBufferPoolManager
+   */
+  explicit BustubInstance(size_t bpm_instances = 1);
 
+  /**
+   * Destroy the BusTub instance. A file-backed instance saves its hot page set first, see SaveHotPages().
+   */
   ~BustubInstance();
 
+  /**
+   * Save the hot page set of the buffer pool next to the database file, so that the next instance backed by the same
+   * file preloads it in the background at startup. Does nothing for an instance backed by memory.
+   * @return false if the hot page set could not be saved
+   */
+  auto SaveHotPages() -> bool;
+
+  /**
+   * Add a tablespace to the database. CREATE TABLE and CREATE INDEX place the new object in the tablespace named by
+   * the `default_tablespace` session variable, as in Postgres.
+   * @param name name of the tablespace
+   * @param file_name path of its file, created if it does not exist
+   * @return the id of the tablespace
+   * @throw Exception for an instance backed by memory, or if the tablespace can't be added
+   */
+  auto AddTablespace(const std::string &name, const std::string &file_name) -> tablespace_id_t;
+
   /**
    * Execute a SQL query in the BusTub instance.
    */
@@ -270,8 +312,21 @@ class BustubInstance {
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
+  void CmdResizeBufferPool(const std::string &arg, ResultWriter &writer);
+  void CmdSaveHotPages(ResultWriter &writer);
+  void CmdAddTablespace(const std::string &arg, ResultWriter &writer);
+  /** @return the tablespace new tables and indexes are placed in, see AddTablespace() */
+  auto GetDefaultTablespace() -> tablespace_id_t;
+  /** Start preloading the hot page set saved by the previous instance, if there is one. */
+  void WarmUpBufferPool();
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
   std::unordered_map<std::string, std::string> session_variables_;
+  /** The hot page file of the database, or empty for an instance backed by memory. */
+  std::string hot_page_file_name_;
+  /** The disk manager of an instance backed by a file, which holds its tablespaces, or nullptr. */
+  TablespaceDiskManager *tablespaces_{nullptr};
+  /** Schedules the page I/O of the buffer pool of an instance backed by a file, or nullptr. */
+  std::shared_ptr<DiskScheduler> disk_scheduler_;
 };
 
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -27,15 +28,41 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The background flusher of the buffer pool wakes up every BG_FLUSH_INTERVAL. */
+extern std::chrono::milliseconds bg_flush_interval;
+
+/** Number of pages sequential scans keep prefetched ahead of the page they read. 0 disables read-ahead. */
+extern std::atomic<int> read_ahead_window;
+
+/** True if the frame arenas of buffer pools large enough should be backed by transparent huge pages. */
+extern std::atomic<bool> enable_huge_pages;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
 static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
+static constexpr size_t BUFFER_POOL_MAX_SIZE = 1 << 18;  // frames a buffer pool instance can be resized to
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr double BG_FLUSH_TARGET_CLEAN_RATIO = 0.25;  // fraction of the pool the flusher keeps clean
+static constexpr int BG_FLUSH_PAGES_PER_SEC = 4096;          // max write rate of the background flusher
+static constexpr int BUFFER_RING_SIZE = 32;                  // frames recycled by a BufferAccessStrategy
+static constexpr int WARMUP_BATCH_SIZE = 32;                 // pages a buffer pool warm-up reads at once
+static constexpr size_t EXTENT_SIZE = 64;                    // contiguous pages a table or index reserves at once
+static constexpr int TABLESPACE_PAGE_BITS = 24;  // low bits of a page id addressing the page within its tablespace
+static constexpr size_t TABLESPACE_MAX_PAGES = size_t{1} << TABLESPACE_PAGE_BITS;  // pages a tablespace can hold
+static constexpr size_t MAX_TABLESPACES = 128;   // tablespaces that fit in the remaining bits of a page id
+static constexpr size_t DISK_SCHEDULER_WORKERS = 2;          // I/O worker threads of a DiskScheduler
+static constexpr size_t LOG_SEGMENT_SIZE = 4 << 20;          // size of a preallocated log segment file in byte
+static constexpr size_t LOG_BLOCK_SIZE = 4096;               // unit of the writes to a log segment in byte
+static constexpr size_t LOG_SPARE_SEGMENTS = 2;              // recycled log segments kept for reuse
+static constexpr size_t DISK_SCHEDULER_MAX_BATCH = 32;       // adjacent pages a DiskScheduler issues at once
+static constexpr size_t CACHE_LINE_SIZE = 64;                // size of a cpu cache line in byte
+static constexpr size_t HUGE_PAGE_SIZE = 2 << 20;            // size of a transparent huge page in byte
+static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;          // buffer and offset alignment of O_DIRECT I/O in byte
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -43,6 +70,9 @@ using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
 using slot_offset_t = size_t;  // slot offset type
 using oid_t = uint16_t;
+using tablespace_id_t = uint8_t;  // tablespace id type
+
+static constexpr tablespace_id_t DEFAULT_TABLESPACE = 0;  // the tablespace of the main database file
 
 static constexpr int VARCHAR_DEFAULT_LENGTH = 128;  // default length for varchar when constructing the column
 
@@ -29,6 +29,12 @@ class ReaderWriterLatch {
    */
   void WLock() { mutex_.lock(); }
 
+  /**
+   * Try to acquire a write latch without waiting.
+   * @return true if the write latch was acquired
+   */
+  auto TryWLock() -> bool { return mutex_.try_lock(); }
+
   /**
    * Release a write latch.
    */
@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/container/hash/page_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "container/hash/hash_table.h"
+
+namespace bustub {
+
+/**
+ * PageTable is the page_id -> frame_id map of the buffer pool.
+ *
+ * It is an open-addressing table with linear probing. Every slot is a single 64-bit word holding both the page id
+ * and the frame id, and slots are grouped into cache-line-aligned lines so that a probe usually touches one line.
+ *
+ * Writers are serialized by a mutex and bump a version counter around every change. Readers never lock: they probe
+ * and then check that the version did not move, retrying otherwise. Since every slot and the version are sequentially
+ * consistent atomics, a reader that misses a concurrent Remove() is ordered before it.
+ *
+ * The table grows when it is half full of live entries. The previous slot arrays are kept until the table is
+ * destroyed, because readers may still be probing them.
+ */
+class PageTable : public HashTable<page_id_t, frame_id_t> {
+ public:
+  /**
+   * @brief Create a new PageTable.
+   * @param capacity the number of entries the table is expected to hold, e.g. the number of frames
+   */
+  explicit PageTable(size_t capacity);
+
+  /**
+   * @brief Find the frame holding the given page. Does not block, but retries while a writer is active.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page
+   * @return true if the page was found
+   */
+  auto Find(const page_id_t &page_id, frame_id_t &frame_id) -> bool override;
+
+  /**
+   * @brief Map page_id to frame_id, replacing an existing mapping of page_id.
+   */
+  void Insert(const page_id_t &page_id, const frame_id_t &frame_id) override;
+
+  /**
+   * @brief Remove the mapping of page_id.
+   * @return true if the page was in the table
+   */
+  auto Remove(const page_id_t &page_id) -> bool override;
+
+  /**
+   * @brief Grow the table so that it can hold `capacity` entries without growing again. The table never shrinks.
+   * @param capacity the number of entries the table is expected to hold, e.g. the number of frames
+   */
+  void Reserve(size_t capacity);
+
+  /** @return the number of pages in the table */
+  auto Size() -> size_t;
+
+  /** @return the number of slots of the current slot array */
+  auto GetNumSlots() -> size_t;
+
+ private:
+  static constexpr size_t SLOTS_PER_LINE = CACHE_LINE_SIZE / sizeof(uint64_t);
+  /** Page id of a slot that was never used. Probes stop here. */
+  static constexpr page_id_t EMPTY_SLOT = INVALID_PAGE_ID;
+  /** Page id of a slot whose entry was removed. Probes continue past it. */
+  static constexpr page_id_t TOMBSTONE = -2;
+
+  struct alignas(CACHE_LINE_SIZE) Line {
+    std::atomic<uint64_t> slots_[SLOTS_PER_LINE];
+  };
+
+  struct Slots {
+    explicit Slots(size_t num_lines);
+
+    std::unique_ptr<Line[]> lines_;
+    size_t slot_mask_;
+  };
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto KeyOf(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto ValueOf(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the number of lines a table expected to hold `capacity` entries starts with */
+  static auto LinesFor(size_t capacity) -> size_t;
+
+  /** @return the slot a probe for page_id starts at, which is always the first slot of a line */
+  static auto HomeSlot(page_id_t page_id, size_t slot_mask) -> size_t;
+
+  static auto SlotAt(Slots *slots, size_t index) -> std::atomic<uint64_t> & {
+    return slots->lines_[index / SLOTS_PER_LINE].slots_[index % SLOTS_PER_LINE];
+  }
+
+  /** Store an entry that is known to be absent. Caller holds latch_ and has made the version odd. */
+  void InsertFresh(Slots *slots, page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Move every live entry into a slot array with num_lines lines, dropping the tombstones. A new array is only
+   * allocated when the size changes. Caller holds latch_ and has made the version odd.
+   */
+  void Rebuild(size_t num_lines);
+
+  /** Bumped before and after every change, odd while a change is in progress. */
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> version_{0};
+  /** The current slot array. */
+  std::atomic<Slots *> slots_;
+
+  /** Serializes writers. */
+  alignas(CACHE_LINE_SIZE) std::mutex latch_;
+  /** Every slot array the table has used. Retired arrays may still be read by lagging readers. */
+  std::vector<std::unique_ptr<Slots>> all_slots_;
+  size_t size_{0};
+  size_t tombstones_{0};
+};
+
+}  // namespace bustub
@@ -16,6 +16,7 @@
 #include <utility>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "catalog/catalog.h"
 #include "concurrency/transaction.h"
 #include "storage/page/tmp_tuple_page.h"
@@ -51,6 +52,12 @@ class ExecutorContext {
   /** @return the buffer pool manager */
   auto GetBufferPoolManager() -> BufferPoolManager * { return bpm_; }
 
+  /**
+   * @return the buffer access strategy of this query. Large sequential scans should fetch their pages through it, so
+   * that they recycle a small ring of frames instead of flushing the buffer pool.
+   */
+  auto GetBufferAccessStrategy() -> BufferAccessStrategy * { return &strategy_; }
+
   /** @return the log manager - don't worry about it for now */
   auto GetLogManager() -> LogManager * { return nullptr; }
 
@@ -71,6 +78,8 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The ring of frames shared by the sequential scans of this query */
+  BufferAccessStrategy strategy_;
 };
 
 }  // namespace bustub
@@ -51,6 +51,9 @@ class LogManager {
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline auto GetLogBuffer() -> char * { return log_buffer_; }
 
+  /** Recycle the log segments that recovery can't need anymore, see DiskManager::RecycleLog(). */
+  inline void RecycleLog() { disk_manager_->RecycleLog(); }
+
  private:
   // TODO(students): you may add your own member variables
 
@@ -13,31 +13,74 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
 #include <fstream>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
+#include <shared_mutex>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/free_page_map.h"
 
 namespace bustub {
 
+/** How the database file is accessed. */
+enum class DiskIoMode : uint8_t {
+  /** Through the OS page cache. */
+  BUFFERED,
+  /**
+   * With O_DIRECT, bypassing the OS page cache so that the buffer pool is the only cache of the pages. Buffers must be
+   * aligned to DIRECT_IO_ALIGNMENT, as the frames of a buffer pool are; unaligned ones are bounced through an aligned
+   * copy.
+   */
+  DIRECT,
+};
+
+/** The header at the start of every block of a log segment. */
+struct LogBlockHeader {
+  uint32_t magic_;
+  /** Bytes of log data in the block, less than LOG_BLOCK_PAYLOAD for the last block of the log. */
+  uint32_t used_;
+  /** Sequence number of the segment the block was written in, telling it apart from the blocks of a recycled one. */
+  uint64_t segment_seq_;
+};
+
+/** Bytes of log data a log block holds. */
+static constexpr size_t LOG_BLOCK_PAYLOAD = LOG_BLOCK_SIZE - sizeof(LogBlockHeader);
+/** Bytes of log data a log segment holds. */
+static constexpr size_t LOG_SEGMENT_PAYLOAD = LOG_SEGMENT_SIZE / LOG_BLOCK_SIZE * LOG_BLOCK_PAYLOAD;
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are transferred with positional I/O (pread/pwrite) on a shared file descriptor, so that page reads and writes
+ * of different threads run in parallel instead of queueing on a file position.
+ *
+ * The log is a sequence of segment files of LOG_SEGMENT_SIZE bytes, named after the log file with the sequence number
+ * of the segment appended (see LogSegmentName()). A segment is preallocated when it is created, so that appending to
+ * the log never grows a file, and the segments a checkpoint made useless are renamed to come after the last one and
+ * reused (see RecycleLog()). Segments are written in whole LOG_BLOCK_SIZE blocks, each starting with a LogBlockHeader
+ * that tells where the log ends when it is opened again.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param io_mode how the database file is accessed. DIRECT falls back to BUFFERED if the file system does not support
+   * O_DIRECT, see GetIoMode().
+   * @param open_log false for a data file that goes without a log file, such as the file of a tablespace
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, DiskIoMode io_mode = DiskIoMode::BUFFERED, bool open_log = true);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
 
-  virtual ~DiskManager() = default;
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -59,22 +102,133 @@ class DiskManager {
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Read a batch of pages from the database file. Runs of adjacent page ids are read with a single preadv, so callers
+   * should sort them by page id.
+   * @param page_ids ids of the pages
+   * @param[out] pages_data output buffers, one per page
+   */
+  virtual void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data);
+
+  /**
+   * Write a batch of pages to the database file. Runs of adjacent page ids are written with a single pwritev, so
+   * callers should sort them by page id.
+   * @param page_ids ids of the pages
+   * @param pages_data raw page data, one per page
+   */
+  virtual void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data);
+
+  /**
+   * Wait until every page written so far is durable on disk. Page writes only hand the data over to the OS, so this is
+   * the barrier to call where durability is required: checkpoints, before the log records of a page are dropped, and
+   * at shutdown. Does nothing for a disk manager that is not backed by a file.
+   */
+  virtual void Sync();
+
+  /**
+   * Return a page to the free page map. Its blocks are given back to the file system right away, by punching a hole
+   * or by truncating the file when the page ends it, and AllocateFreePage() hands it out again. The map is saved next
+   * to the database file by Sync(), together with the pages it describes.
+   * @param page_id id of the page, which must not be in use anymore
+   */
+  virtual void DeallocatePage(page_id_t page_id);
+
+  /**
+   * Take a page out of the free page map, lowest id first.
+   * @param stride,residue only consider pages with page_id % stride == residue, i.e. the pages of one instance of a
+   * parallel buffer pool
+   * @return the page id, or INVALID_PAGE_ID if no such page is free
+   */
+  virtual auto AllocateFreePage(uint32_t stride = 1, uint32_t residue = 0) -> page_id_t;
+
+  /**
+   * Take a run of contiguous pages out of the free page map, lowest ids first.
+   * @param num_pages length of the run
+   * @return the first page id of the run, or INVALID_PAGE_ID if no such run is free
+   */
+  auto AllocateFreeRun(size_t num_pages) -> page_id_t;
+
+  /**
+   * Reserve a range of contiguous page ids in a tablespace other than the default one, see TablespaceDiskManager.
+   * @param tablespace the tablespace
+   * @param num_pages number of pages to reserve
+   * @return the first page id of the range, or INVALID_PAGE_ID since a single database file has no other tablespace
+   */
+  virtual auto AllocateExtent(tablespace_id_t tablespace, size_t num_pages) -> page_id_t { return INVALID_PAGE_ID; }
+
+  /**
+   * @param tablespace a tablespace other than the default one
+   * @return one past the last page id reserved in the tablespace by AllocateExtent() or found in its file
+   */
+  virtual auto GetTablespaceEnd(tablespace_id_t tablespace) -> page_id_t { return MakePageId(tablespace, 0); }
+
+  /**
+   * A page id holds the tablespace of the page in its high bits and the page within the file of the tablespace in its
+   * low TABLESPACE_PAGE_BITS bits. The pages of the default tablespace keep their plain ids.
+   * @return the id of page local_page_id of a tablespace
+   */
+  static constexpr auto MakePageId(tablespace_id_t tablespace, page_id_t local_page_id) -> page_id_t {
+    return static_cast<page_id_t>(tablespace) << TABLESPACE_PAGE_BITS | local_page_id;
+  }
+
+  /** @return the tablespace of a page */
+  static constexpr auto TablespaceOf(page_id_t page_id) -> tablespace_id_t {
+    return static_cast<tablespace_id_t>(static_cast<uint32_t>(page_id) >> TABLESPACE_PAGE_BITS);
+  }
+
+  /** @return the page within the file of its tablespace */
+  static constexpr auto LocalPageId(page_id_t page_id) -> page_id_t {
+    return page_id & ((page_id_t{1} << TABLESPACE_PAGE_BITS) - 1);
+  }
+
+  /** @return the number of pages in the free page map */
+  auto GetNumFreePages() -> size_t;
+
+  /** @return the number of page ids in use or free, i.e. the lowest page id that was never allocated */
+  virtual auto GetNumPages() -> page_id_t;
+
+  /**
+   * Append a log buffer to the log and return once it is durable. The log data of concurrent callers is made durable
+   * together: while one of them syncs the log, the others append theirs, and the next sync covers them all.
    * @param log_data raw log data
    * @param size size of log entry
    */
   void WriteLog(char *log_data, int size);
 
   /**
-   * Read a log entry from the log file.
+   * Read a log entry from the log.
    * @param[out] log_data output buffer
    * @param size size of the log entry
-   * @param offset offset of the log entry in the file
-   * @return true if the read was successful, false otherwise
+   * @param offset offset of the log entry in the log, counted from the oldest log data that was not recycled
+   * @return true if the read was successful, false if the offset is past the end of the log
    */
   auto ReadLog(char *log_data, int size, int offset) -> bool;
 
-  /** @return the number of disk flushes */
+  /**
+   * Recycle the log segments before the one being written. To be called by a checkpoint, once every page is durable
+   * and no transaction is running, when recovery doesn't need any of the log written so far. Up to LOG_SPARE_SEGMENTS
+   * of the segments are renamed to be reused as the next ones, the others are removed.
+   */
+  void RecycleLog();
+
+  /** @return the number of bytes of the log, counted from the oldest log data that was not recycled */
+  auto GetLogSize() -> int;
+
+  /** @return the number of syncs of the log */
+  auto GetNumLogSyncs() const -> int { return num_log_syncs_; }
+
+  /** @return the path of log segment seq of the given log file */
+  static auto LogSegmentName(const std::string &log_name, uint64_t seq) -> std::string;
+
+  /** Make the entries of a directory durable, such as a file that was created or renamed in it */
+  static void SyncDirectoryOf(const std::string &file_name);
+
+  /** @return the path of the database file */
+  auto GetFileName() const -> const std::string & { return file_name_; }
+
+  /** @return how the database file is actually accessed */
+  auto GetIoMode() const -> DiskIoMode { return io_mode_; }
+
+  /** @return the number of calls to WriteLog() */
   auto GetNumFlushes() const -> int;
 
   /** @return true iff the in-memory content has not been flushed yet */
@@ -83,6 +237,9 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return the number of calls to Sync() */
+  auto GetNumSyncs() const -> int { return num_syncs_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -94,18 +251,55 @@ class DiskManager {
 
  protected:
   auto GetFileSize(const std::string &file_name) -> int;
-  // stream to write log file
-  std::fstream log_io_;
+  /** @return true if the buffer can't be handed to the db file as is, because of the alignment O_DIRECT requires */
+  auto NeedsBounce(const char *page_data) const -> bool {
+    return io_mode_ == DiskIoMode::DIRECT && reinterpret_cast<uintptr_t>(page_data) % DIRECT_IO_ALIGNMENT != 0;
+  }
+  /** Write a page without taking file_size_latch_, which the caller holds shared. */
+  void WritePageImp(page_id_t page_id, const char *page_data);
+  /** @return true if any buffer of the pages [first, first + count) needs to be bounced */
+  auto RunNeedsBounce(const std::vector<char *> &pages_data, size_t first, size_t count) const -> bool;
+  /** Find the segments of the log and where it ends. */
+  void OpenLog();
+  /** Start appending to log segment seq, creating it or reusing a spare one. Must hold log_latch_. */
+  void StartLogSegment(uint64_t seq);
+  /** Write the log data of a WriteLog() to the segments, in whole blocks. Must hold log_latch_. */
+  void AppendLog(const char *log_data, size_t size);
+  /** @return the position of the end of the log, in bytes of log data since the start of segment 0 */
+  auto LogEnd() const -> uint64_t { return log_seq_ * LOG_SEGMENT_PAYLOAD + log_used_; }
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // the log: segments [log_first_seq_, log_seq_] hold the log data, and (log_seq_, log_last_seq_] are spare ones
+  std::mutex log_latch_;
+  std::condition_variable log_synced_cv_;
+  uint64_t log_first_seq_{0};
+  uint64_t log_seq_{0};
+  uint64_t log_last_seq_{0};
+  // bytes of log data in segment log_seq_, and its descriptor, or -1 until the first write
+  size_t log_used_{0};
+  int log_fd_{-1};
+  // the last, partial block of the log, rewritten by every write until it is full
+  std::vector<char> log_tail_block_;
+  // segments written since the last sync that are not written anymore, to be synced and closed by the next one
+  std::vector<int> log_unsynced_fds_;
+  // the log before log_synced_end_ is durable; log_syncing_ is set while a sync runs outside of the latch
+  uint64_t log_synced_end_{0};
+  bool log_syncing_{false};
+  std::atomic<int> num_log_syncs_{0};
+  // descriptor of the db file, shared by all threads: page I/O is positional and never moves a file offset
+  int db_fd_{-1};
   std::string file_name_;
+  DiskIoMode io_mode_{DiskIoMode::BUFFERED};
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
+  std::atomic<int> num_syncs_{0};
+  // deallocated pages, and the file they are saved to (none for a disk manager that is not backed by a file)
+  std::mutex free_pages_latch_;
+  FreePageMap free_pages_;
+  // held shared by the page writes and exclusively by a truncation, so that no write extends the file meanwhile
+  std::shared_mutex file_size_latch_;
+  std::string free_pages_name_;
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
 };
 
 }  // namespace bustub
@@ -51,6 +51,28 @@ class DiskManagerMemory : public DiskManager {
    */
   void ReadPage(page_id_t page_id, char *page_data) override;
 
+  /**
+   * Read a batch of pages, one by one.
+   * @param page_ids ids of the pages
+   * @param[out] pages_data output buffers, one per page
+   */
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override {
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      ReadPage(page_ids[i], pages_data[i]);
+    }
+  }
+
+  /**
+   * Write a batch of pages, one by one.
+   * @param page_ids ids of the pages
+   * @param pages_data raw page data, one per page
+   */
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override {
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      WritePage(page_ids[i], pages_data[i]);
+    }
+  }
+
  private:
   char *memory_;
 };
@@ -103,6 +125,28 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     memcpy(page_data, ptr->first.data(), BUSTUB_PAGE_SIZE);
   }
 
+  /**
+   * Read a batch of pages, one by one.
+   * @param page_ids ids of the pages
+   * @param[out] pages_data output buffers, one per page
+   */
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override {
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      ReadPage(page_ids[i], pages_data[i]);
+    }
+  }
+
+  /**
+   * Write a batch of pages, one by one.
+   * @param page_ids ids of the pages
+   * @param pages_data raw page data, one per page
+   */
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override {
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      WritePage(page_ids[i], pages_data[i]);
+    }
+  }
+
  private:
   std::mutex mutex_;
   using Page = std::array<char, BUSTUB_PAGE_SIZE>;
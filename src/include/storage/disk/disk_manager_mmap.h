@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.h
+//
+// Identification: src/include/storage/disk/disk_manager_mmap.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerMmap serves the pages of a database file that is never written, such as the copy of an analytical
+ * replica, from a read-only memory mapping of the file.
+ *
+ * A page read is a memcpy out of the mapping instead of a pread, so a page miss costs no system call once the page is
+ * in the page cache, and the kernel reads ahead of scans on its own. Callers that only look at a page can skip the copy
+ * altogether with GetPage().
+ *
+ * The file is mapped once, at construction: pages appended to it afterwards are not seen. Writes throw, so the buffer
+ * pool on top of it must never write a page back.
+ */
+class DiskManagerMmap : public DiskManager {
+ public:
+  /**
+   * @brief Map the given database file.
+   * @param db_file the file name of the database file, which must exist
+   */
+  explicit DiskManagerMmap(const std::string &db_file);
+
+  ~DiskManagerMmap() override;
+
+  DISALLOW_COPY_AND_MOVE(DiskManagerMmap);
+
+  /** @brief Not supported, the file is read-only. @throw Exception always */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Copy a page out of the mapping. Pages past the end of the file read as zeros.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * Copy a batch of pages out of the mapping.
+   * @param page_ids ids of the pages
+   * @param[out] pages_data output buffers, one per page
+   */
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override {
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      ReadPage(page_ids[i], pages_data[i]);
+    }
+  }
+
+  /** @brief Not supported, the file is read-only. @throw Exception always */
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override;
+
+  /** @brief Nothing to sync, the file is never written. */
+  void Sync() override {}
+
+  /**
+   * @param page_id id of the page
+   * @return the page inside the mapping, valid as long as the disk manager, or nullptr if the file does not hold it
+   */
+  auto GetPage(page_id_t page_id) const -> const char * {
+    if (page_id < 0 || page_id >= num_pages_) {
+      return nullptr;
+    }
+    return data_ + static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  }
+
+  /** @return the number of whole pages in the mapping */
+  auto GetNumPages() -> page_id_t override { return num_pages_; }
+
+ private:
+  /** Start of the mapping, nullptr for an empty file. */
+  const char *data_{nullptr};
+  /** Length of the mapping in bytes. */
+  size_t size_{0};
+  page_id_t num_pages_{0};
+};
+
+}  // namespace bustub
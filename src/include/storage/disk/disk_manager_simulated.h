@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_simulated.h
+//
+// Identification: src/include/storage/disk/disk_manager_simulated.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** The service times of an emulated storage device. */
+struct DeviceProfile {
+  /** Median latency of a read request, before its data is transferred. */
+  std::chrono::microseconds read_latency_{0};
+  /** Median latency of a write request, before its data is transferred. */
+  std::chrono::microseconds write_latency_{0};
+  /** Spread of the log-normal latency distribution around the medians, 0 for fixed latencies. */
+  double latency_sigma_{0};
+  /** Requests served at once, the others wait for a slot; 0 for no limit. */
+  size_t queue_depth_{0};
+  /** Throughput of the transfers of all requests together, in bytes per second; 0 for no limit. */
+  size_t bytes_per_second_{0};
+
+  /** @return a 7200 rpm hard disk: a seek per request, one request at a time */
+  static auto Hdd() -> DeviceProfile;
+  /** @return a SATA SSD, limited by the AHCI queue and the SATA link */
+  static auto SataSsd() -> DeviceProfile;
+  /** @return an NVMe SSD */
+  static auto Nvme() -> DeviceProfile;
+};
+
+/**
+ * DiskManagerSimulated keeps the pages in memory, like DiskManagerUnlimitedMemory, but makes every request take the
+ * time the emulated device of a DeviceProfile would: a latency drawn from a log-normal distribution, a limited number
+ * of requests in flight and a shared transfer rate. A batch of ReadPages()/WritePages() is one request, like a preadv.
+ * Benchmarks of the buffer pool then pay for their misses, and give the same picture on any machine.
+ *
+ * The pages live in a map sharded by page id, so that the emulator never serializes requests that the device would
+ * serve in parallel. Latencies are drawn from a generator seeded at construction, so a single-threaded run is
+ * reproducible. Waits shorter than the timer slack of the OS are approximated by yielding.
+ */
+class DiskManagerSimulated : public DiskManager {
+ public:
+  /**
+   * @param profile the service times of the device
+   * @param seed seed of the latency distribution
+   */
+  explicit DiskManagerSimulated(const DeviceProfile &profile, uint64_t seed = 0);
+
+  ~DiskManagerSimulated() override = default;
+
+  DISALLOW_COPY_AND_MOVE(DiskManagerSimulated);
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /** Read a page. A page that was never written reads as zeros, like a hole in a file. */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** Read a batch of pages with a single request. */
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override;
+
+  /** Write a batch of pages with a single request. */
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override;
+
+  /** Flushing the write cache of the device costs a write latency. */
+  void Sync() override;
+
+  /** Drop the page and add it to the free page map. */
+  void DeallocatePage(page_id_t page_id) override;
+
+  /** @return one past the highest page written or free */
+  auto GetNumPages() -> page_id_t override;
+
+  /** @return the number of pages read */
+  auto GetNumReads() const -> int { return num_reads_; }
+
+  /** @return the service times of the device */
+  auto GetProfile() const -> const DeviceProfile & { return profile_; }
+
+ private:
+  using Page = std::array<char, BUSTUB_PAGE_SIZE>;
+  using Clock = std::chrono::steady_clock;
+
+  /** A part of the page map. */
+  struct Shard {
+    std::mutex latch_;
+    std::unordered_map<page_id_t, std::unique_ptr<Page>> pages_;
+  };
+
+  static constexpr size_t NUM_SHARDS = 16;
+
+  auto GetShard(page_id_t page_id) -> Shard & {
+    // Fibonacci hashing, so that the strided page ids of a parallel buffer pool instance still spread over the shards.
+    return shards_[(static_cast<uint32_t>(page_id) * 0x9E3779B1U) >> 28];
+  }
+
+  void CopyIn(page_id_t page_id, const char *page_data);
+  void CopyOut(page_id_t page_id, char *page_data);
+
+  /** Wait for a request transferring num_pages pages to complete. */
+  void Serve(bool is_write, size_t num_pages);
+
+  /** Sleep until the deadline, yielding through the last stretch that a sleep can't time precisely. */
+  static void WaitUntil(Clock::time_point deadline);
+
+  const DeviceProfile profile_;
+  std::array<Shard, NUM_SHARDS> shards_;
+  std::atomic<page_id_t> num_pages_{0};
+  std::atomic<int> num_reads_{0};
+
+  /** Protects the request queue, the transfer channel and the latency generator. */
+  std::mutex latch_;
+  std::condition_variable slot_free_;
+  size_t in_flight_{0};
+  /** When the transfers reserved so far are done. */
+  Clock::time_point channel_free_at_{};
+  std::mt19937_64 rng_;
+  std::lognormal_distribution<double> latency_factor_;
+};
+
+}  // namespace bustub
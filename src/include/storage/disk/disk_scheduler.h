@@ -0,0 +1,203 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <future>  // NOLINT
+#include <map>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** How urgently a write is needed. Reads are always foreground. */
+enum class DiskRequestPriority : uint8_t {
+  /** Someone waits for the write, e.g. an eviction or an explicit flush. */
+  FOREGROUND,
+  /** Nobody waits for the write, e.g. the background flusher. Only issued when no other request can run. */
+  BACKGROUND,
+};
+
+/**
+ * A read or write of one page, handed over to the DiskScheduler.
+ */
+struct DiskRequest {
+  /** True for a write, false for a read. */
+  bool is_write_{false};
+  /** For a read, the buffer the page is read into; for a write, the page data. Must stay valid until completion. */
+  char *data_{nullptr};
+  /** Id of the page to read or write. */
+  page_id_t page_id_{INVALID_PAGE_ID};
+  /** Set to true once the request completes, or to the exception the disk manager threw. */
+  std::promise<bool> callback_;
+  /** Optional, called on the I/O worker with the outcome of the request right before callback_ is set. */
+  std::function<void(bool)> on_complete_;
+  /** Urgency of a write. */
+  DiskRequestPriority priority_{DiskRequestPriority::FOREGROUND};
+};
+
+/** Counters of a DiskScheduler. */
+struct DiskSchedulerStats {
+  /** Read and write requests completed. */
+  size_t reads_{0};
+  size_t writes_{0};
+  /** Calls to DiskManager::ReadPages() and DiskManager::WritePages(). Each one covers a run of adjacent pages. */
+  size_t read_batches_{0};
+  size_t write_batches_{0};
+  /** Reads answered from a write of the same page that was still queued, without any I/O. */
+  size_t reads_from_queued_writes_{0};
+  /** Writes that were overwritten by a later write of the same page before they were issued. */
+  size_t superseded_writes_{0};
+};
+
+/**
+ * DiskScheduler runs page reads and writes on a pool of I/O worker threads, so that callers don't block inside the
+ * disk manager unless they wait on the request.
+ *
+ * Queued requests are ordered by page id, and each worker takes the next run of adjacent pages in elevator order (the
+ * lowest page past the previous run, wrapping around) and issues it with a single ReadPages() or WritePages() call.
+ * Reads go first, then foreground writes, then background writes.
+ *
+ * Requests of the same page keep the order they were scheduled in: at most one batch touches a page at a time, a
+ * write waits for the queued reads of its page, a read of a page with a queued write is answered from the data of that
+ * write, and a queued write is replaced by a later write of the same page.
+ *
+ * Only page I/O is scheduled. The log is still written with DiskManager::WriteLog() by the thread that flushes it.
+ */
+class DiskScheduler {
+ public:
+  /**
+   * @brief Create a new DiskScheduler and start its workers.
+   * @param disk_manager the disk manager the requests are issued to
+   * @param num_workers the number of I/O worker threads
+   * @param max_batch_size the maximum number of adjacent pages issued together
+   */
+  explicit DiskScheduler(DiskManager *disk_manager, size_t num_workers = DISK_SCHEDULER_WORKERS,
+                         size_t max_batch_size = DISK_SCHEDULER_MAX_BATCH);
+
+  DISALLOW_COPY_AND_MOVE(DiskScheduler);
+
+  /**
+   * @brief Complete every request that was scheduled, then stop and join the workers.
+   */
+  ~DiskScheduler();
+
+  /**
+   * @brief Queue a request. Returns right away; completion is signalled through the request's callback.
+   * @param request the request
+   */
+  void Schedule(DiskRequest request);
+
+  /**
+   * @brief Queue a read of a page.
+   * @param page_id id of the page
+   * @param[out] page_data the buffer the page is read into
+   * @return a future that becomes ready when page_data holds the page
+   */
+  auto ScheduleRead(page_id_t page_id, char *page_data) -> std::future<bool>;
+
+  /**
+   * @brief Queue a write of a page.
+   * @param page_id id of the page
+   * @param page_data the page data, must stay unchanged until the future is ready
+   * @param priority the urgency of the write
+   * @return a future that becomes ready when the page is written
+   */
+  auto ScheduleWrite(page_id_t page_id, const char *page_data,
+                     DiskRequestPriority priority = DiskRequestPriority::FOREGROUND) -> std::future<bool>;
+
+  /** @brief Create a promise for the callback of a request. */
+  static auto CreatePromise() -> std::promise<bool> { return {}; }
+
+  /**
+   * @brief Wait for a batch of futures returned by the scheduler. All of them are waited for even if some failed,
+   * since their buffers are in use until then.
+   * @throw the exception of the first future that failed
+   */
+  static void WaitAll(std::vector<std::future<bool>> *futures);
+
+  /** @brief Block until every request scheduled so far has completed. */
+  void WaitForIdle();
+
+  /** @return the disk manager the requests are issued to */
+  auto GetDiskManager() const -> DiskManager * { return disk_manager_; }
+
+  /** @return a snapshot of the counters */
+  auto GetStats() -> DiskSchedulerStats;
+
+ private:
+  /** The queued requests of one page, oldest first. A write is issued with the data of the last request. */
+  using QueuedRequests = std::vector<DiskRequest>;
+  using RequestQueue = std::map<page_id_t, QueuedRequests>;
+
+  /** A run of adjacent pages taken off a queue by a worker. */
+  struct Batch {
+    bool is_write_{false};
+    std::vector<page_id_t> page_ids_;
+    std::vector<QueuedRequests> requests_;
+  };
+
+  /** Body of the worker threads. */
+  void RunWorker();
+
+  /** Take the next batch to issue, in priority order. Caller must hold latch_. @return false if none can run. */
+  auto NextBatch(Batch *batch) -> bool;
+
+  /** Take the next run of adjacent pages off a queue. Caller must hold latch_. @return false if none can run. */
+  auto TakeRun(RequestQueue *queue, page_id_t *head, bool is_write, Batch *batch) -> bool;
+
+  /** @return true if a request of the page can be issued now. Caller must hold latch_. */
+  auto CanIssue(page_id_t page_id, bool is_write) const -> bool {
+    return in_flight_.count(page_id) == 0 && (!is_write || reads_.count(page_id) == 0);
+  }
+
+  /** Issue a batch to the disk manager and complete its requests. Called without the latch. */
+  void IssueBatch(Batch *batch);
+
+  /** Complete a request with the given outcome. Called without the latch. */
+  static void Complete(DiskRequest *request, const std::exception_ptr &error);
+
+  DiskManager *disk_manager_;
+  const size_t max_batch_size_;
+
+  /** Protects everything below. */
+  std::mutex latch_;
+  /** Wakes up the workers when requests are queued, pages stop being in flight, or the scheduler stops. */
+  std::condition_variable work_cv_;
+  /** Wakes up WaitForIdle() when the last outstanding request completes. */
+  std::condition_variable idle_cv_;
+  RequestQueue reads_;
+  RequestQueue writes_;
+  RequestQueue background_writes_;
+  /** Where the elevator of each queue resumes. */
+  page_id_t read_head_{0};
+  page_id_t write_head_{0};
+  page_id_t background_write_head_{0};
+  /** Pages of the batches being issued. */
+  std::unordered_set<page_id_t> in_flight_;
+  /** Requests scheduled but not completed yet. */
+  size_t outstanding_{0};
+  bool stopped_{false};
+  DiskSchedulerStats stats_;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
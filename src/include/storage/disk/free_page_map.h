@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.h
+//
+// Identification: src/include/storage/disk/free_page_map.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FreePageMap is the set of deallocated pages of a database file, which are handed out again before the file grows.
+ * It is saved to a sidecar file of the database so that it survives restarts. Not thread-safe: the disk manager
+ * serializes the accesses.
+ */
+class FreePageMap {
+ public:
+  /**
+   * @brief Add a page to the map.
+   * @return false if the page was free already
+   */
+  auto Add(page_id_t page_id) -> bool;
+
+  /**
+   * @brief Take the lowest free page whose id is congruent to residue modulo stride out of the map. The stride lets
+   * each instance of a parallel buffer pool only take the pages it owns.
+   * @return the page id, or INVALID_PAGE_ID if there is none
+   */
+  auto Take(uint32_t stride, uint32_t residue) -> page_id_t;
+
+  /**
+   * @brief Take the lowest run of num_pages contiguous free pages out of the map.
+   * @return the first page id of the run, or INVALID_PAGE_ID if there is none
+   */
+  auto TakeRun(size_t num_pages) -> page_id_t;
+
+  /**
+   * @param end_page_id the page id right after the last page of the file
+   * @return the first page of the run of free pages that ends the file, or end_page_id if the last page is in use
+   */
+  auto TrailingRunStart(page_id_t end_page_id) const -> page_id_t;
+
+  /** @return the number of free pages */
+  auto Size() const -> size_t { return free_pages_.size(); }
+
+  /** @return one past the highest free page id, or 0 if the map is empty */
+  auto EndPageId() const -> page_id_t { return free_pages_.empty() ? 0 : *free_pages_.rbegin() + 1; }
+
+  /** @return true if the map changed since it was last read or written */
+  auto IsDirty() const -> bool { return dirty_; }
+
+  /**
+   * Write the map. The file is written as a PageIdFile, so a crash never leaves a partial file behind.
+   * @param file_name path of the file
+   * @return false if the file could not be written
+   */
+  auto Write(const std::string &file_name) -> bool;
+
+  /**
+   * Replace the map with the one saved in a file.
+   * @param file_name path of the file
+   * @return false if the file does not exist or is not a free page file, in which case the map is left empty
+   */
+  auto Read(const std::string &file_name) -> bool;
+
+  /** @return the path of the free page file that goes with a database file */
+  static auto FileNameFor(const std::string &db_file_name) -> std::string;
+
+ private:
+  std::set<page_id_t> free_pages_;
+  bool dirty_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_id_file.h
+//
+// Identification: src/include/storage/disk/page_id_file.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** The header at the start of a page id file. */
+struct PageIdFileHeader {
+  char magic_[8];
+  uint32_t version_;
+  uint32_t num_pages_;
+};
+
+/**
+ * PageIdFile is the format of the sidecar files of a database that hold a list of page ids, such as the free page file
+ * and the hot page file: a header with the magic of the kind of file and its version, followed by the page ids. The
+ * kinds of file only differ by their magic.
+ */
+class PageIdFile {
+ public:
+  /**
+   * Write a list of page ids. The file is written and synced under a temporary name, renamed, and then the directory is
+   * synced, so a crash leaves either the old file or the new one behind, never a partial file.
+   * @param file_name path of the file
+   * @param magic the magic of the kind of file, of sizeof(PageIdFileHeader::magic_) bytes
+   * @param version the version of the format of the kind of file
+   * @param page_ids the page ids
+   * @return false if the file could not be written
+   */
+  static auto Write(const std::string &file_name, const char *magic, uint32_t version,
+                    const std::vector<page_id_t> &page_ids) -> bool;
+
+  /**
+   * Read a list of page ids.
+   * @param file_name path of the file
+   * @param magic the magic of the kind of file, of sizeof(PageIdFileHeader::magic_) bytes
+   * @param version the version of the format of the kind of file
+   * @return the page ids, or std::nullopt if the file does not exist or is not of this kind and version
+   */
+  static auto Read(const std::string &file_name, const char *magic, uint32_t version)
+      -> std::optional<std::vector<page_id_t>>;
+};
+
+}  // namespace bustub
@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tablespace_disk_manager.h
+//
+// Identification: src/include/storage/disk/tablespace_disk_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * TablespaceDiskManager spreads the pages of a database over several files, the tablespaces, so that tables and
+ * indexes can be placed on separate devices.
+ *
+ * The database file is the default tablespace and keeps the log and the plain page ids. Every other tablespace is a
+ * file of its own, addressed by the high bits of the page id (see DiskManager::MakePageId()), with its own descriptor,
+ * I/O mode and free page map: the I/O of one tablespace never waits for another one. Pages are only created in a
+ * tablespace through the extents of the objects placed there, see AllocateExtent().
+ *
+ * Tablespaces are not recorded in the database: they must be added again, in the same order, when it is reopened.
+ */
+class TablespaceDiskManager : public DiskManager {
+ public:
+  /** Name of the default tablespace, the database file. */
+  static constexpr const char *DEFAULT_TABLESPACE_NAME = "default";
+
+  /**
+   * Creates a disk manager whose default tablespace is the given database file.
+   * @param db_file the file name of the database file
+   * @param io_mode how the database file is accessed
+   */
+  explicit TablespaceDiskManager(const std::string &db_file, DiskIoMode io_mode = DiskIoMode::BUFFERED);
+
+  ~TablespaceDiskManager() override = default;
+
+  DISALLOW_COPY_AND_MOVE(TablespaceDiskManager);
+
+  /**
+   * Add a tablespace, creating its file if it does not exist.
+   * @param name name of the tablespace
+   * @param file_name path of its file
+   * @param io_mode how the file is accessed
+   * @return the id of the tablespace
+   * @throw Exception if the name is taken, there are MAX_TABLESPACES already or the file can't be opened
+   */
+  auto AddTablespace(const std::string &name, const std::string &file_name, DiskIoMode io_mode = DiskIoMode::BUFFERED)
+      -> tablespace_id_t;
+
+  /** @return the id of a tablespace, or std::nullopt if there is none of that name */
+  auto GetTablespace(const std::string &name) -> std::optional<tablespace_id_t>;
+
+  /** @return the number of tablespaces, the default one included */
+  auto GetNumTablespaces() -> size_t;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** Read a batch of pages, with one batch per tablespace. */
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override;
+
+  /** Write a batch of pages, with one batch per tablespace. */
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override;
+
+  /** Sync the files of all tablespaces. */
+  void Sync() override;
+
+  /** Return a page to the free page map of its tablespace. */
+  void DeallocatePage(page_id_t page_id) override;
+
+  /**
+   * Reserve num_pages contiguous page ids of a tablespace: a run of its free page map if there is one that long, or
+   * else the pages past its end. Free pages that don't form such a run are not handed out again.
+   * @throw Exception if the tablespace does not exist or is full
+   */
+  auto AllocateExtent(tablespace_id_t tablespace, size_t num_pages) -> page_id_t override;
+
+  auto GetTablespaceEnd(tablespace_id_t tablespace) -> page_id_t override;
+
+ private:
+  /** @return the disk manager of the file of a tablespace other than the default one @throw Exception if unknown */
+  auto GetFile(tablespace_id_t tablespace) const -> DiskManager *;
+
+  /**
+   * Split a batch of pages into runs of the same tablespace and call fn(file, local_page_ids, run_pages_data) for each
+   * of them, with a null file for the default tablespace.
+   */
+  template <typename Fn>
+  void ForEachTablespace(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data, Fn &&fn);
+
+  /** Protects the names and the ends of the tablespaces. */
+  std::mutex latch_;
+  std::unordered_map<std::string, tablespace_id_t> names_;
+  /** Files of the tablespaces, indexed by id; the default one is this disk manager. A slot is only written once. */
+  std::array<std::unique_ptr<DiskManager>, MAX_TABLESPACES> files_;
+  /** One past the last local page id reserved in each tablespace. */
+  std::array<page_id_t, MAX_TABLESPACES> ends_{};
+};
+
+}  // namespace bustub
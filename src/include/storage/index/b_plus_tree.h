@@ -10,10 +10,13 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <deque>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "buffer/page_extent.h"
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
@@ -32,6 +35,16 @@ namespace bustub {
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Insert(), Remove() and GetValue() may be called concurrently. They descend with latch crabbing: a page is latched
+ * before the latch of its parent is released. Lookups and most writes hold read latches down to the leaf, which a write
+ * latches for writing; only a write whose leaf would split or underflow starts over, write latching the path from the
+ * root and keeping the latches of the pages the change may reach. The root page id is protected by the root latch.
+ *
+ * An iterator holds the read latch of its leaf, and latches the next leaf before releasing it, so leaves are latched
+ * from left to right. A remove latches the brothers it merges or redistributes with while it holds the pages of its
+ * path, some of which an iterator may wait for: it only tries for their latches, before changing anything, and starts
+ * over if one is held.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -40,7 +53,8 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     tablespace_id_t tablespace = DEFAULT_TABLESPACE);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -60,9 +74,6 @@ class BPlusTree {
   // return the leaf size of the node
   auto GetMaxSize() const -> size_t;
 
-  // find leaf node in the b+tree
-  auto FindLeaf(BPlusTreePage *bpt_page, const KeyType &key, const KeyComparator &cmp) const -> BPlusTreePage *;
-
   // check if key is redundant
   auto CheckRedundant(LeafPage *leaf_page, const KeyType &key, const KeyComparator &cmp) const -> bool;
 
@@ -71,7 +82,10 @@ class BPlusTree {
 
   auto FindBrotherPage(BPlusTreePage *page, const page_id_t &page_id, int *key_index, page_id_t *bro_page_id_left,
                        page_id_t *bro_page_id_right) const -> void;
-  void RemoveEntry(BPlusTreePage *bpt_page, const KeyType &key);
+  // remove key from a page, merging or redistributing it with a brother if it underflows, the brothers latched by
+  // LatchBrothers() being used up from the front; the pages merged away are added to deleted_pages
+  void RemoveEntry(BPlusTreePage *bpt_page, const KeyType &key, std::deque<Page *> *brothers,
+                   std::vector<page_id_t> *deleted_pages);
 
   void CoalesceNodes(BPlusTreePage *bpt_page, BPlusTreePage *bro_page, bool is_predecessor, const KeyType &key);
 
@@ -95,6 +109,32 @@ class BPlusTree {
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
 
  private:
+  enum class Operation { FIND, INSERT, REMOVE };
+
+  // true if applying op to the page can't change its parent
+  auto IsSafe(BPlusTreePage *bpt_page, Operation op) const -> bool;
+
+  // the size below which a page other than the root underflows
+  auto MinSize(BPlusTreePage *bpt_page) const -> int;
+
+  // point a child at its new parent
+  void SetParentOf(page_id_t child_page_id, page_id_t parent_page_id);
+
+  // descend to the leaf of key, or to the leftmost leaf, with read latches, write latching the leaf unless op is FIND;
+  // nullptr if empty tree
+  auto LatchLeaf(const KeyType &key, Operation op, bool leftmost = false) -> Page *;
+
+  // descend to the leaf of key with write latches, returning the pages still latched, the leaf last, behind a nullptr
+  // standing for the root latch if it is still held
+  auto LatchPath(const KeyType &key, Operation op) -> std::deque<Page *>;
+
+  // release and unpin the pages returned by LatchPath()
+  void ReleasePath(std::deque<Page *> *pages, bool is_dirty);
+
+  // write latch the brothers a remove of key from the leaf merges or redistributes the pages with, from the leaf up,
+  // without waiting; false if one is latched by someone else, in which case none is
+  auto LatchBrothers(LeafPage *leaf_page, const KeyType &key, std::deque<Page *> *brothers) -> bool;
+
   void UpdateRootPageId(int insert_record = 0);
 
   /* Debug Routines for FREE!! */
@@ -104,11 +144,17 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
+  // protects root_page_id_
+  mutable ReaderWriterLatch root_latch_;
   page_id_t root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  // Leaves and internal pages are allocated from separate extents of the tablespace of the tree, so that walking the
+  // leaves reads the file sequentially
+  PageExtent leaf_extent_;
+  PageExtent internal_extent_;
 };
 
 }  // namespace bustub
@@ -13,17 +13,23 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include "buffer/read_ahead.h"
+#include "common/macros.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * An iterator holds the pin and the read latch of its leaf, so the tree must not be changed by the thread that uses it.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
-  // you may define your own constructor based on your member variables
-  IndexIterator(page_id_t leaf_page_id, int index, BufferPoolManager *buffer_pool_manager);
+  // leaf_page is pinned and read latched, and released by the iterator; nullptr for the end
+  IndexIterator(Page *leaf_page, int index, BufferPoolManager *buffer_pool_manager);
+  DISALLOW_COPY(IndexIterator);
   ~IndexIterator();  // NOLINT
 
   auto IsEnd() -> bool;
@@ -41,11 +47,15 @@ class IndexIterator {
   }
 
  private:
-  // add your own private member variables here
+  // move to the first entry of the next leaf that has any, or to the end
+  void NextLeaf();
+
+  Page *page_;
   page_id_t leaf_page_id_;
   int index_;
   B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_page_;
   BufferPoolManager *buffer_pool_manager_;
+  ReadAhead read_ahead_;
 };
 
 }  // namespace bustub
@@ -10,11 +10,23 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <mutex>  // NOLINT
+#include <new>
+#include <shared_mutex>
 #include <string>
 #include <thread>  // NOLINT
 
@@ -30,103 +42,548 @@ static char *buffer_used;
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, DiskIoMode io_mode, bool open_log)
+    : file_name_(db_file), io_mode_(io_mode) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
-  log_name_ = file_name_.substr(0, n) + ".log";
-
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
+  if (open_log) {
+    log_name_ = file_name_.substr(0, n) + ".log";
+    OpenLog();
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  int flags = O_RDWR | O_CREAT;
+  if (io_mode_ == DiskIoMode::DIRECT) {
+    db_fd_ = open(db_file.c_str(), flags | O_DIRECT, 0644);  // NOLINT
+    // Some file systems, e.g. tmpfs, refuse O_DIRECT: go through the page cache there.
+    if (db_fd_ < 0 && errno == EINVAL) {
+      LOG_WARN("O_DIRECT is not supported for %s, using buffered I/O", db_file.c_str());
+      io_mode_ = DiskIoMode::BUFFERED;
     }
   }
+  if (io_mode_ == DiskIoMode::BUFFERED) {
+    db_fd_ = open(db_file.c_str(), flags, 0644);  // NOLINT
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
   buffer_used = nullptr;
+
+  // A new or empty database file has no page in use, whatever a leftover free page file says.
+  free_pages_name_ = FreePageMap::FileNameFor(db_file);
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) == 0 && stat_buf.st_size > 0) {
+    free_pages_.Read(free_pages_name_);
+  } else {
+    remove(free_pages_name_.c_str());
+  }
+}
+
+DiskManager::~DiskManager() {
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
+  for (int fd : log_unsynced_fds_) {
+    close(fd);
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+  }
 }
 
 /**
- * Close all file streams
+ * Close all file streams, once everything written is durable
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+  if (db_fd_ >= 0) {
+    Sync();
+    close(db_fd_);
+    db_fd_ = -1;
+  }
+  // Every WriteLog() returned once its data was synced.
+  std::scoped_lock<std::mutex> lock(log_latch_);
+  for (int fd : log_unsynced_fds_) {
+    close(fd);
+  }
+  log_unsynced_fds_.clear();
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
   }
-  log_io_.close();
+}
+
+/** Maximum number of pages transferred by one preadv/pwritev. */
+static constexpr size_t IO_VECTOR_MAX = 64;
+
+/**
+ * Call pread/pwrite until `size` bytes are transferred, retrying on interrupts and partial transfers
+ * @return: the number of bytes transferred, short only at the end of the file, or -1 on error
+ */
+template <typename Transfer>
+static auto TransferFull(size_t size, Transfer &&transfer) -> ssize_t {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = transfer(done);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      return -1;
+    }
+    if (n == 0) {
+      break;
+    }
+    done += n;
+  }
+  return static_cast<ssize_t>(done);
+}
+
+/**
+ * Call fn(first, count) for every run of adjacent page ids, up to IO_VECTOR_MAX pages each
+ */
+template <typename Fn>
+static void ForEachRun(const std::vector<page_id_t> &page_ids, Fn &&fn) {
+  size_t first = 0;
+  while (first < page_ids.size()) {
+    size_t count = 1;
+    while (first + count < page_ids.size() && count < IO_VECTOR_MAX &&
+           page_ids[first + count] == page_ids[first] + static_cast<page_id_t>(count)) {
+      count++;
+    }
+    fn(first, count);
+    first += count;
+  }
+}
+
+/**
+ * A page buffer aligned for O_DIRECT, which the I/O of unaligned caller buffers is bounced through
+ */
+struct AlignedPageDeleter {
+  void operator()(char *page) const { ::operator delete[](page, std::align_val_t{DIRECT_IO_ALIGNMENT}); }
+};
+using AlignedPage = std::unique_ptr<char[], AlignedPageDeleter>;
+
+static auto MakeAlignedPage() -> AlignedPage {
+  return AlignedPage(static_cast<char *>(::operator new[](BUSTUB_PAGE_SIZE, std::align_val_t{DIRECT_IO_ALIGNMENT})));
+}
+
+/**
+ * Build the I/O vector of the pages [first, first + count)
+ */
+static auto MakeIoVector(const std::vector<char *> &pages_data, size_t first, size_t count) -> std::vector<iovec> {
+  std::vector<iovec> iov(count);
+  for (size_t i = 0; i < count; i++) {
+    iov[i] = {pages_data[first + i], BUSTUB_PAGE_SIZE};
+  }
+  return iov;
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
+  std::shared_lock<std::shared_mutex> lock(file_size_latch_);
+  WritePageImp(page_id, page_data);
+}
+
+/**
+ * Write the contents of a page. Caller must hold file_size_latch_ shared
+ */
+void DiskManager::WritePageImp(page_id_t page_id, const char *page_data) {
+  if (NeedsBounce(page_data)) {
+    auto bounce = MakeAlignedPage();
+    memcpy(bounce.get(), page_data, BUSTUB_PAGE_SIZE);
+    WritePageImp(page_id, bounce.get());
+    return;
+  }
+  off_t offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
+  ssize_t write_count = TransferFull(BUSTUB_PAGE_SIZE, [&](size_t done) {
+    return pwrite(db_fd_, page_data + done, BUSTUB_PAGE_SIZE - done, offset + static_cast<off_t>(done));
+  });
   // check for I/O error
-  if (db_io_.bad()) {
+  if (write_count != BUSTUB_PAGE_SIZE) {
     LOG_DEBUG("I/O error while writing");
+  }
+}
+
+/**
+ * Write the contents of several pages, with one pwritev per run of adjacent pages
+ */
+void DiskManager::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) {
+  assert(page_ids.size() == pages_data.size());
+  std::shared_lock<std::shared_mutex> lock(file_size_latch_);
+  ForEachRun(page_ids, [&](size_t first, size_t count) {
+    if (RunNeedsBounce(pages_data, first, count)) {
+      for (size_t i = first; i < first + count; i++) {
+        WritePageImp(page_ids[i], pages_data[i]);
+      }
+      return;
+    }
+    auto iov = MakeIoVector(pages_data, first, count);
+    off_t offset = static_cast<off_t>(page_ids[first]) * BUSTUB_PAGE_SIZE;
+    ssize_t n;
+    do {
+      n = pwritev(db_fd_, iov.data(), static_cast<int>(count), offset);
+    } while (n < 0 && errno == EINTR);
+    size_t written = n > 0 ? static_cast<size_t>(n) / BUSTUB_PAGE_SIZE : 0;
+    num_writes_ += static_cast<int>(written);
+    // Finish a partial transfer page by page, rewriting the page it stopped in.
+    for (size_t i = written; i < count; i++) {
+      WritePageImp(page_ids[first + i], pages_data[first + i]);
+    }
+  });
+}
+
+/**
+ * Returns true if a buffer of the pages [first, first + count) has to be bounced, which rules out a single
+ * preadv/pwritev
+ */
+auto DiskManager::RunNeedsBounce(const std::vector<char *> &pages_data, size_t first, size_t count) const -> bool {
+  return std::any_of(pages_data.begin() + first, pages_data.begin() + first + count,
+                     [&](const char *page_data) { return NeedsBounce(page_data); });
+}
+
+/**
+ * Make the page writes durable: the only place where the db file is synced
+ */
+void DiskManager::Sync() {
+  num_syncs_ += 1;
+  if (db_fd_ < 0) {
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  int rc;
+  do {
+    rc = fdatasync(db_fd_);
+  } while (rc < 0 && errno == EINTR);
+  if (rc < 0) {
+    throw Exception("can't sync db file");
+  }
+  // The pages are durable, so is the map of the free ones.
+  std::scoped_lock<std::mutex> lock(free_pages_latch_);
+  if (free_pages_.IsDirty() && !free_pages_.Write(free_pages_name_)) {
+    throw Exception("can't write free page file");
+  }
+}
+
+/**
+ * Add a page to the free page map and give its blocks back to the file system. Both happen under the latch, so that a
+ * page taken out of the map by AllocateFreePage() is never cut off by a truncation once it is written again. The file
+ * size latch keeps out the writes, which may extend the file past the size the truncation is computed from
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(free_pages_latch_);
+  if (!free_pages_.Add(page_id) || db_fd_ < 0) {
+    return;
+  }
+  std::unique_lock<std::shared_mutex> file_size_lock(file_size_latch_);
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) != 0) {
+    return;
+  }
+  auto end_page_id = static_cast<page_id_t>((stat_buf.st_size + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE);
+  if (page_id >= end_page_id) {
+    return;
+  }
+  auto run_start = free_pages_.TrailingRunStart(end_page_id);
+  if (run_start < end_page_id) {
+    if (ftruncate(db_fd_, static_cast<off_t>(run_start) * BUSTUB_PAGE_SIZE) != 0) {
+      LOG_DEBUG("I/O error while truncating db file");
+    }
+    return;
+  }
+  // Not supported by every file system, the page then keeps its blocks until it is reused.
+  if (fallocate(db_fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE,
+                BUSTUB_PAGE_SIZE) != 0 &&
+      errno != EOPNOTSUPP) {
+    LOG_DEBUG("I/O error while punching a hole in db file");
+  }
+}
+
+auto DiskManager::AllocateFreePage(uint32_t stride, uint32_t residue) -> page_id_t {
+  std::scoped_lock<std::mutex> lock(free_pages_latch_);
+  return free_pages_.Take(stride, residue);
+}
+
+auto DiskManager::AllocateFreeRun(size_t num_pages) -> page_id_t {
+  std::scoped_lock<std::mutex> lock(free_pages_latch_);
+  return free_pages_.TakeRun(num_pages);
+}
+
+auto DiskManager::GetNumFreePages() -> size_t {
+  std::scoped_lock<std::mutex> lock(free_pages_latch_);
+  return free_pages_.Size();
+}
+
+/**
+ * The file may end before the highest free pages, once they were truncated away
+ */
+auto DiskManager::GetNumPages() -> page_id_t {
+  std::scoped_lock<std::mutex> lock(free_pages_latch_);
+  page_id_t num_pages = 0;
+  struct stat stat_buf;
+  if (db_fd_ >= 0 && fstat(db_fd_, &stat_buf) == 0) {
+    num_pages = static_cast<page_id_t>((stat_buf.st_size + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE);
+  }
+  return std::max(num_pages, free_pages_.EndPageId());
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
+  if (NeedsBounce(page_data)) {
+    auto bounce = MakeAlignedPage();
+    ReadPage(page_id, bounce.get());
+    memcpy(page_data, bounce.get(), BUSTUB_PAGE_SIZE);
+    return;
+  }
+  off_t offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
+  ssize_t read_count = TransferFull(BUSTUB_PAGE_SIZE, [&](size_t done) {
+    return pread(db_fd_, page_data + done, BUSTUB_PAGE_SIZE - done, offset + static_cast<off_t>(done));
+  });
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading");
+    return;
+  }
+  // if file ends before reading BUSTUB_PAGE_SIZE
+  if (read_count < BUSTUB_PAGE_SIZE) {
+    if (read_count == 0) {
+      LOG_DEBUG("I/O error reading past end of file");
+    } else {
+      LOG_DEBUG("Read less than a page");
+    }
+    memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  }
+}
+
+/**
+ * Read the contents of several pages, with one preadv per run of adjacent pages
+ */
+void DiskManager::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) {
+  assert(page_ids.size() == pages_data.size());
+  ForEachRun(page_ids, [&](size_t first, size_t count) {
+    if (RunNeedsBounce(pages_data, first, count)) {
+      for (size_t i = first; i < first + count; i++) {
+        ReadPage(page_ids[i], pages_data[i]);
+      }
       return;
     }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+    auto iov = MakeIoVector(pages_data, first, count);
+    off_t offset = static_cast<off_t>(page_ids[first]) * BUSTUB_PAGE_SIZE;
+    ssize_t n;
+    do {
+      n = preadv(db_fd_, iov.data(), static_cast<int>(count), offset);
+    } while (n < 0 && errno == EINTR);
+    // The run ended early, at the end of the file or because of a partial transfer: finish it page by page.
+    for (size_t i = n > 0 ? static_cast<size_t>(n) / BUSTUB_PAGE_SIZE : 0; i < count; i++) {
+      ReadPage(page_ids[first + i], pages_data[first + i]);
+    }
+  });
+}
+
+static constexpr uint32_t LOG_BLOCK_MAGIC = 0x424c4f47;  // "BLOG"
+
+/**
+ * Retry a system call that was interrupted
+ */
+template <typename Call>
+static auto RetryOnInterrupt(Call &&call) -> decltype(call()) {
+  decltype(call()) rc;
+  do {
+    rc = call();
+  } while (rc < 0 && errno == EINTR);
+  return rc;
+}
+
+void DiskManager::SyncDirectoryOf(const std::string &file_name) {
+  auto n = file_name.rfind('/');
+  auto dir = n == std::string::npos ? std::string(".") : file_name.substr(0, n + 1);
+  int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);  // NOLINT
+  if (fd >= 0) {
+    RetryOnInterrupt([&] { return fsync(fd); });
+    close(fd);
+  }
+}
+
+/**
+ * Read the header of a log block
+ * @return: false if the block is not part of segment seq, i.e. never written or left over from a recycled segment
+ */
+static auto ReadLogBlockHeader(int fd, uint64_t seq, size_t block, LogBlockHeader *header) -> bool {
+  auto n = RetryOnInterrupt(
+      [&] { return pread(fd, header, sizeof(*header), static_cast<off_t>(block * LOG_BLOCK_SIZE)); });
+  return n == static_cast<ssize_t>(sizeof(*header)) && header->magic_ == LOG_BLOCK_MAGIC &&
+         header->segment_seq_ == seq && header->used_ <= LOG_BLOCK_PAYLOAD;
+}
+
+auto DiskManager::LogSegmentName(const std::string &log_name, uint64_t seq) -> std::string {
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), ".%06lu", static_cast<unsigned long>(seq));  // NOLINT
+  return log_name + suffix;
+}
+
+/**
+ * List the segment files of the log. Those whose first block belongs to them hold log data, the last run of them is
+ * the log; the ones after it are spare segments, and those before it are leftovers of an interrupted recycling
+ */
+void DiskManager::OpenLog() {
+  auto n = log_name_.rfind('/');
+  auto dir_name = n == std::string::npos ? std::string(".") : log_name_.substr(0, n + 1);
+  auto prefix = (n == std::string::npos ? log_name_ : log_name_.substr(n + 1)) + ".";
+  std::vector<uint64_t> seqs;
+  if (DIR *dir = opendir(dir_name.c_str()); dir != nullptr) {
+    while (auto *entry = readdir(dir)) {
+      std::string name(entry->d_name);
+      if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+          std::all_of(name.begin() + prefix.size(), name.end(), [](char c) { return isdigit(c) != 0; })) {
+        seqs.push_back(std::stoull(name.substr(prefix.size())));
+      }
+    }
+    closedir(dir);
+  }
+  std::sort(seqs.begin(), seqs.end());
+
+  std::vector<uint64_t> live;
+  for (auto seq : seqs) {
+    int fd = open(LogSegmentName(log_name_, seq).c_str(), O_RDONLY);  // NOLINT
+    LogBlockHeader header;
+    if (fd >= 0 && ReadLogBlockHeader(fd, seq, 0, &header)) {
+      live.push_back(seq);
+    }
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+  if (live.empty()) {
+    // The log is empty: the first write starts segment log_seq_, reusing it if it is a spare one.
+    log_first_seq_ = log_seq_ = seqs.empty() ? 0 : seqs.front();
+    log_last_seq_ = seqs.empty() ? 0 : seqs.back();
+    log_used_ = 0;
+    log_synced_end_ = LogEnd();
+    return;
+  }
+  log_seq_ = live.back();
+  log_first_seq_ = log_seq_;
+  while (log_first_seq_ > 0 && std::binary_search(live.begin(), live.end(), log_first_seq_ - 1)) {
+    log_first_seq_--;
+  }
+  log_last_seq_ = seqs.back();
+  for (auto seq : seqs) {
+    if (seq < log_first_seq_) {
+      remove(LogSegmentName(log_name_, seq).c_str());
+    }
+  }
+
+  // The log ends in the first block of the last segment that is not full.
+  int fd = open(LogSegmentName(log_name_, log_seq_).c_str(), O_RDONLY);  // NOLINT
+  if (fd < 0) {
+    throw Exception("can't open log segment");
+  }
+  log_used_ = 0;
+  LogBlockHeader header;
+  for (size_t block = 0; block < LOG_SEGMENT_SIZE / LOG_BLOCK_SIZE; block++) {
+    if (!ReadLogBlockHeader(fd, log_seq_, block, &header)) {
+      break;
+    }
+    log_used_ += header.used_;
+    if (header.used_ < LOG_BLOCK_PAYLOAD) {
+      break;
+    }
+  }
+  close(fd);
+  log_synced_end_ = LogEnd();
+}
+
+/**
+ * Switch to another segment. A spare segment keeps its blocks, which are told apart from the new ones by their
+ * sequence number, so only a new segment is preallocated
+ */
+void DiskManager::StartLogSegment(uint64_t seq) {
+  if (log_fd_ >= 0) {
+    log_unsynced_fds_.push_back(log_fd_);
+    log_fd_ = -1;
+  }
+  log_seq_ = seq;
+  log_used_ = 0;
+  auto name = LogSegmentName(log_name_, log_seq_);
+  log_fd_ = open(name.c_str(), O_RDWR | O_CREAT, 0644);  // NOLINT
+  if (log_fd_ < 0) {
+    throw Exception("can't open log segment");
+  }
+  struct stat stat_buf;
+  bool spare = fstat(log_fd_, &stat_buf) == 0 && stat_buf.st_size >= static_cast<off_t>(LOG_SEGMENT_SIZE);
+  if (!spare) {
+    int rc = posix_fallocate(log_fd_, 0, static_cast<off_t>(LOG_SEGMENT_SIZE));
+    if (rc != 0) {
+      LOG_WARN("can't preallocate %s: %s", name.c_str(), strerror(rc));
     }
+    // The allocation is made durable once, so that syncing the log never has to update the size of the file.
+    RetryOnInterrupt([&] { return fsync(log_fd_); });
+    SyncDirectoryOf(name);
   }
+  log_last_seq_ = std::max(log_last_seq_, log_seq_);
+  log_tail_block_.assign(LOG_BLOCK_SIZE, 0);
 }
 
 /**
- * Write the contents of the log into disk file
- * Only return when sync is done, and only perform sequence write
+ * Fill the log blocks from the end of the log on, and write them with one pwrite per segment. The last block is kept
+ * in log_tail_block_, and written again by the next call with the data appended to it
+ */
+void DiskManager::AppendLog(const char *log_data, size_t size) {
+  if (log_fd_ < 0 && log_used_ == 0) {
+    StartLogSegment(log_seq_);
+  } else if (log_fd_ < 0 && log_used_ < LOG_SEGMENT_PAYLOAD) {
+    // First write since the log was opened: continue its last block.
+    log_fd_ = open(LogSegmentName(log_name_, log_seq_).c_str(), O_RDWR);  // NOLINT
+    if (log_fd_ < 0) {
+      throw Exception("can't open log segment");
+    }
+    log_tail_block_.assign(LOG_BLOCK_SIZE, 0);
+    auto block = log_used_ / LOG_BLOCK_PAYLOAD;
+    RetryOnInterrupt([&] {
+      return pread(log_fd_, log_tail_block_.data(), LOG_BLOCK_SIZE, static_cast<off_t>(block * LOG_BLOCK_SIZE));
+    });
+  }
+  std::vector<char> blocks;
+  while (size > 0) {
+    if (log_used_ == LOG_SEGMENT_PAYLOAD) {
+      StartLogSegment(log_seq_ + 1);
+    }
+    auto first_block = log_used_ / LOG_BLOCK_PAYLOAD;
+    blocks.clear();
+    while (size > 0 && log_used_ < LOG_SEGMENT_PAYLOAD) {
+      auto used = log_used_ % LOG_BLOCK_PAYLOAD;
+      auto n = std::min(size, LOG_BLOCK_PAYLOAD - used);
+      memcpy(log_tail_block_.data() + sizeof(LogBlockHeader) + used, log_data, n);
+      LogBlockHeader header{LOG_BLOCK_MAGIC, static_cast<uint32_t>(used + n), log_seq_};
+      memcpy(log_tail_block_.data(), &header, sizeof(header));
+      blocks.insert(blocks.end(), log_tail_block_.begin(), log_tail_block_.end());
+      log_data += n;
+      size -= n;
+      log_used_ += n;
+      if (used + n == LOG_BLOCK_PAYLOAD) {
+        std::fill(log_tail_block_.begin(), log_tail_block_.end(), 0);
+      }
+    }
+    auto offset = static_cast<off_t>(first_block * LOG_BLOCK_SIZE);
+    ssize_t written = TransferFull(blocks.size(), [&](size_t done) {
+      return pwrite(log_fd_, blocks.data() + done, blocks.size() - done, offset + static_cast<off_t>(done));
+    });
+    if (written != static_cast<ssize_t>(blocks.size())) {
+      throw Exception("I/O error while writing log");
+    }
+  }
+}
+
+/**
+ * Append the log data, then sync unless a sync that started after the append already covers it. Only one thread syncs
+ * at a time, outside of the latch, so that the others keep appending and are covered by the next sync
  */
 void DiskManager::WriteLog(char *log_data, int size) {
+  std::unique_lock<std::mutex> lock(log_latch_);
   // enforce swap log buffer
   assert(log_data != buffer_used);
   buffer_used = log_data;
@@ -134,56 +591,120 @@ void DiskManager::WriteLog(char *log_data, int size) {
   if (size == 0) {  // no effect on num_flushes_ if log buffer is empty
     return;
   }
-
-  flush_log_ = true;
-
-  if (flush_log_f_ != nullptr) {
-    // used for checking non-blocking flushing
-    assert(flush_log_f_->wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+  if (log_name_.empty()) {
+    LOG_DEBUG("no log file to write to");
+    return;
   }
 
+  flush_log_ = true;
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
+  AppendLog(log_data, static_cast<size_t>(size));
 
-  // check for I/O error
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while writing log");
-    return;
+  auto end = LogEnd();
+  while (log_synced_end_ < end) {
+    if (log_syncing_) {
+      log_synced_cv_.wait(lock);
+      continue;
+    }
+    log_syncing_ = true;
+    auto sync_end = LogEnd();
+    auto fds = std::move(log_unsynced_fds_);
+    log_unsynced_fds_.clear();
+    int fd = log_fd_;
+    lock.unlock();
+    // One sync for every segment written since the last one: the data of all the callers appended meanwhile.
+    int rc = 0;
+    for (int unsynced_fd : fds) {
+      rc |= RetryOnInterrupt([&] { return fdatasync(unsynced_fd); });
+      close(unsynced_fd);
+    }
+    rc |= RetryOnInterrupt([&] { return fdatasync(fd); });
+    lock.lock();
+    log_syncing_ = false;
+    log_synced_cv_.notify_all();
+    if (rc < 0) {
+      flush_log_ = false;
+      throw Exception("can't sync log");
+    }
+    num_log_syncs_ += 1;
+    log_synced_end_ = std::max(log_synced_end_, sync_end);
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
   flush_log_ = false;
 }
 
 /**
- * Read the contents of the log into the given memory area
- * Always read from the beginning and perform sequence read
+ * Read the log data at the given offset, block by block
  * @return: false means already reach the end
  */
 auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
-  if (offset >= GetFileSize(log_name_)) {
-    // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
+  std::scoped_lock<std::mutex> lock(log_latch_);
+  auto position = log_first_seq_ * LOG_SEGMENT_PAYLOAD + static_cast<uint64_t>(offset);
+  auto end = LogEnd();
+  if (log_name_.empty() || offset < 0 || position >= end) {
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
-
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while reading log");
-    return false;
+  int fd = -1;
+  uint64_t fd_seq = 0;
+  int read_count = 0;
+  while (read_count < size && position < end) {
+    auto seq = position / LOG_SEGMENT_PAYLOAD;
+    auto used = position % LOG_SEGMENT_PAYLOAD;
+    if (fd < 0 || fd_seq != seq) {
+      if (fd >= 0) {
+        close(fd);
+      }
+      fd = open(LogSegmentName(log_name_, seq).c_str(), O_RDONLY);  // NOLINT
+      fd_seq = seq;
+      if (fd < 0) {
+        LOG_DEBUG("I/O error while reading log");
+        return false;
+      }
+    }
+    auto n = std::min({static_cast<uint64_t>(size - read_count), LOG_BLOCK_PAYLOAD - used % LOG_BLOCK_PAYLOAD,
+                       end - position});
+    auto file_offset = static_cast<off_t>(used / LOG_BLOCK_PAYLOAD * LOG_BLOCK_SIZE + sizeof(LogBlockHeader) +
+                                          used % LOG_BLOCK_PAYLOAD);
+    if (TransferFull(n, [&](size_t done) {
+          return pread(fd, log_data + read_count + done, n - done, file_offset + static_cast<off_t>(done));
+        }) != static_cast<ssize_t>(n)) {
+      LOG_DEBUG("I/O error while reading log");
+      close(fd);
+      return false;
+    }
+    read_count += static_cast<int>(n);
+    position += n;
   }
-  // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
+  close(fd);
+  // if log ends before reading "size"
   if (read_count < size) {
-    log_io_.clear();
     memset(log_data + read_count, 0, size - read_count);
   }
-
   return true;
 }
 
+void DiskManager::RecycleLog() {
+  std::scoped_lock<std::mutex> lock(log_latch_);
+  if (log_name_.empty() || log_first_seq_ >= log_seq_) {
+    return;
+  }
+  for (auto seq = log_first_seq_; seq < log_seq_; seq++) {
+    auto name = LogSegmentName(log_name_, seq);
+    if (log_last_seq_ - log_seq_ < LOG_SPARE_SEGMENTS &&
+        rename(name.c_str(), LogSegmentName(log_name_, log_last_seq_ + 1).c_str()) == 0) {
+      log_last_seq_++;
+    } else {
+      remove(name.c_str());
+    }
+  }
+  log_first_seq_ = log_seq_;
+  SyncDirectoryOf(log_name_);
+}
+
+auto DiskManager::GetLogSize() -> int {
+  std::scoped_lock<std::mutex> lock(log_latch_);
+  return log_name_.empty() ? 0 : static_cast<int>(LogEnd() - log_first_seq_ * LOG_SEGMENT_PAYLOAD);
+}
+
 /**
  * Returns number of flushes made so far
  */
@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.cpp
+//
+// Identification: src/storage/disk/disk_manager_mmap.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_mmap.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+DiskManagerMmap::DiskManagerMmap(const std::string &db_file) {
+  file_name_ = db_file;
+  int fd = open(db_file.c_str(), O_RDONLY);  // NOLINT
+  if (fd < 0) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) != 0) {
+    close(fd);
+    throw Exception("can't stat db file");
+  }
+  size_ = static_cast<size_t>(stat_buf.st_size);
+  num_pages_ = static_cast<page_id_t>(size_ / BUSTUB_PAGE_SIZE);
+  if (size_ > 0) {
+    void *mapping = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      throw Exception("can't map db file");
+    }
+    data_ = static_cast<const char *>(mapping);
+  }
+  // The mapping keeps the file open.
+  close(fd);
+}
+
+DiskManagerMmap::~DiskManagerMmap() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char *>(data_), size_);  // NOLINT
+  }
+}
+
+void DiskManagerMmap::WritePage(page_id_t page_id, const char *page_data) {
+  throw Exception("can't write page " + std::to_string(page_id) + ", the db file is mapped read-only");
+}
+
+void DiskManagerMmap::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) {
+  throw Exception("can't write pages, the db file is mapped read-only");
+}
+
+void DiskManagerMmap::ReadPage(page_id_t page_id, char *page_data) {
+  const char *page = GetPage(page_id);
+  if (page == nullptr) {
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  memcpy(page_data, page, BUSTUB_PAGE_SIZE);
+}
+
+}  // namespace bustub
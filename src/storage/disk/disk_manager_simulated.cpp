@@ -0,0 +1,163 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_simulated.cpp
+//
+// Identification: src/storage/disk/disk_manager_simulated.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_simulated.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+using std::chrono::microseconds;
+
+auto DeviceProfile::Hdd() -> DeviceProfile {
+  return {microseconds(5000), microseconds(5000), 0.5, 1, 180UL << 20};
+}
+
+auto DeviceProfile::SataSsd() -> DeviceProfile {
+  return {microseconds(150), microseconds(60), 0.3, 32, 550UL << 20};
+}
+
+auto DeviceProfile::Nvme() -> DeviceProfile {
+  return {microseconds(60), microseconds(20), 0.3, 256, 3200UL << 20};
+}
+
+/** Waits this close to their deadline yield instead of sleeping, which would overshoot by the timer slack. */
+static constexpr microseconds SPIN_THRESHOLD{60};
+
+DiskManagerSimulated::DiskManagerSimulated(const DeviceProfile &profile, uint64_t seed)
+    : profile_(profile), rng_(seed), latency_factor_(0.0, profile.latency_sigma_ > 0 ? profile.latency_sigma_ : 1.0) {}
+
+void DiskManagerSimulated::WaitUntil(Clock::time_point deadline) {
+  if (deadline - Clock::now() > SPIN_THRESHOLD) {
+    std::this_thread::sleep_until(deadline - SPIN_THRESHOLD);
+  }
+  while (Clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+}
+
+/**
+ * A request waits for a slot in the queue of the device, then for its latency, then for its turn on the transfer
+ * channel, which it keeps as long as its pages take at the throughput of the device
+ */
+void DiskManagerSimulated::Serve(bool is_write, size_t num_pages) {
+  std::unique_lock<std::mutex> lock(latch_);
+  slot_free_.wait(lock, [&] { return profile_.queue_depth_ == 0 || in_flight_ < profile_.queue_depth_; });
+  in_flight_++;
+  auto now = Clock::now();
+  auto latency = std::chrono::duration<double, std::micro>(is_write ? profile_.write_latency_ : profile_.read_latency_);
+  if (profile_.latency_sigma_ > 0) {
+    latency *= latency_factor_(rng_);
+  }
+  auto done = now + std::chrono::duration_cast<Clock::duration>(latency);
+  if (profile_.bytes_per_second_ > 0) {
+    auto transfer = std::chrono::duration<double>(static_cast<double>(num_pages * BUSTUB_PAGE_SIZE) /
+                                                  static_cast<double>(profile_.bytes_per_second_));
+    channel_free_at_ = std::max(done, channel_free_at_) + std::chrono::duration_cast<Clock::duration>(transfer);
+    done = channel_free_at_;
+  }
+  lock.unlock();
+
+  WaitUntil(done);
+
+  lock.lock();
+  in_flight_--;
+  lock.unlock();
+  slot_free_.notify_one();
+}
+
+void DiskManagerSimulated::CopyIn(page_id_t page_id, const char *page_data) {
+  auto &shard = GetShard(page_id);
+  {
+    std::scoped_lock<std::mutex> lock(shard.latch_);
+    auto &page = shard.pages_[page_id];
+    if (page == nullptr) {
+      page = std::make_unique<Page>();
+    }
+    memcpy(page->data(), page_data, BUSTUB_PAGE_SIZE);
+  }
+  num_writes_ += 1;
+  for (auto num_pages = num_pages_.load(); page_id >= num_pages;) {
+    if (num_pages_.compare_exchange_weak(num_pages, page_id + 1)) {
+      break;
+    }
+  }
+}
+
+void DiskManagerSimulated::CopyOut(page_id_t page_id, char *page_data) {
+  auto &shard = GetShard(page_id);
+  {
+    std::scoped_lock<std::mutex> lock(shard.latch_);
+    auto it = shard.pages_.find(page_id);
+    if (it == shard.pages_.end()) {
+      memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    } else {
+      memcpy(page_data, it->second->data(), BUSTUB_PAGE_SIZE);
+    }
+  }
+  num_reads_ += 1;
+}
+
+void DiskManagerSimulated::WritePage(page_id_t page_id, const char *page_data) {
+  Serve(true, 1);
+  CopyIn(page_id, page_data);
+}
+
+void DiskManagerSimulated::ReadPage(page_id_t page_id, char *page_data) {
+  Serve(false, 1);
+  CopyOut(page_id, page_data);
+}
+
+void DiskManagerSimulated::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) {
+  assert(page_ids.size() == pages_data.size());
+  if (page_ids.empty()) {
+    return;
+  }
+  Serve(false, page_ids.size());
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    CopyOut(page_ids[i], pages_data[i]);
+  }
+}
+
+void DiskManagerSimulated::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) {
+  assert(page_ids.size() == pages_data.size());
+  if (page_ids.empty()) {
+    return;
+  }
+  Serve(true, page_ids.size());
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    CopyIn(page_ids[i], pages_data[i]);
+  }
+}
+
+void DiskManagerSimulated::Sync() {
+  Serve(true, 0);
+  DiskManager::Sync();
+}
+
+void DiskManagerSimulated::DeallocatePage(page_id_t page_id) {
+  auto &shard = GetShard(page_id);
+  {
+    std::scoped_lock<std::mutex> lock(shard.latch_);
+    shard.pages_.erase(page_id);
+  }
+  DiskManager::DeallocatePage(page_id);
+}
+
+auto DiskManagerSimulated::GetNumPages() -> page_id_t {
+  return std::max(num_pages_.load(), DiskManager::GetNumPages());
+}
+
+}  // namespace bustub
@@ -0,0 +1,254 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t num_workers, size_t max_batch_size)
+    : disk_manager_(disk_manager), max_batch_size_(std::max<size_t>(1, max_batch_size)) {
+  num_workers = std::max<size_t>(1, num_workers);
+  workers_.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; i++) {
+    workers_.emplace_back(&DiskScheduler::RunWorker, this);
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    stopped_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest request) {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (stopped_) {
+    throw Exception(ExceptionType::INVALID, "disk scheduler is shut down");
+  }
+  auto page_id = request.page_id_;
+  if (!request.is_write_) {
+    // The queued write of the page is the most recent version, and its data stays put until the write is issued.
+    const QueuedRequests *queued_write = nullptr;
+    if (auto it = writes_.find(page_id); it != writes_.end()) {
+      queued_write = &it->second;
+    } else if (auto bg = background_writes_.find(page_id); bg != background_writes_.end()) {
+      queued_write = &bg->second;
+    }
+    if (queued_write != nullptr) {
+      memcpy(request.data_, queued_write->back().data_, BUSTUB_PAGE_SIZE);
+      stats_.reads_++;
+      stats_.reads_from_queued_writes_++;
+      lock.unlock();
+      Complete(&request, nullptr);
+      return;
+    }
+    reads_[page_id].push_back(std::move(request));
+  } else if (auto it = writes_.find(page_id); it != writes_.end()) {
+    it->second.push_back(std::move(request));
+  } else if (request.priority_ == DiskRequestPriority::BACKGROUND) {
+    background_writes_[page_id].push_back(std::move(request));
+  } else {
+    // A foreground write pulls the queued background writes of its page along.
+    auto &queued = writes_[page_id];
+    if (auto bg = background_writes_.find(page_id); bg != background_writes_.end()) {
+      queued = std::move(bg->second);
+      background_writes_.erase(bg);
+    }
+    queued.push_back(std::move(request));
+  }
+  outstanding_++;
+  lock.unlock();
+  work_cv_.notify_one();
+}
+
+auto DiskScheduler::ScheduleRead(page_id_t page_id, char *page_data) -> std::future<bool> {
+  DiskRequest request;
+  request.data_ = page_data;
+  request.page_id_ = page_id;
+  auto future = request.callback_.get_future();
+  Schedule(std::move(request));
+  return future;
+}
+
+auto DiskScheduler::ScheduleWrite(page_id_t page_id, const char *page_data, DiskRequestPriority priority)
+    -> std::future<bool> {
+  DiskRequest request;
+  request.is_write_ = true;
+  request.data_ = const_cast<char *>(page_data);  // NOLINT
+  request.page_id_ = page_id;
+  request.priority_ = priority;
+  auto future = request.callback_.get_future();
+  Schedule(std::move(request));
+  return future;
+}
+
+void DiskScheduler::WaitAll(std::vector<std::future<bool>> *futures) {
+  for (auto &future : *futures) {
+    future.wait();
+  }
+  for (auto &future : *futures) {
+    future.get();
+  }
+}
+
+void DiskScheduler::WaitForIdle() {
+  std::unique_lock<std::mutex> lock(latch_);
+  idle_cv_.wait(lock, [&] { return outstanding_ == 0; });
+}
+
+auto DiskScheduler::GetStats() -> DiskSchedulerStats {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return stats_;
+}
+
+void DiskScheduler::RunWorker() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    Batch batch;
+    if (NextBatch(&batch)) {
+      lock.unlock();
+      IssueBatch(&batch);
+      lock.lock();
+      continue;
+    }
+    // Requests that are blocked by a batch in flight are picked up once it completes.
+    if (stopped_ && reads_.empty() && writes_.empty() && background_writes_.empty()) {
+      return;
+    }
+    work_cv_.wait(lock);
+  }
+}
+
+auto DiskScheduler::NextBatch(Batch *batch) -> bool {
+  return TakeRun(&reads_, &read_head_, false, batch) || TakeRun(&writes_, &write_head_, true, batch) ||
+         TakeRun(&background_writes_, &background_write_head_, true, batch);
+}
+
+auto DiskScheduler::TakeRun(RequestQueue *queue, page_id_t *head, bool is_write, Batch *batch) -> bool {
+  if (queue->empty()) {
+    return false;
+  }
+  // Elevator order: the first page that can be issued at or past the head, wrapping around to the lowest page.
+  auto start = queue->lower_bound(*head);
+  while (start != queue->end() && !CanIssue(start->first, is_write)) {
+    ++start;
+  }
+  if (start == queue->end()) {
+    start = queue->begin();
+    while (start != queue->end() && start->first < *head && !CanIssue(start->first, is_write)) {
+      ++start;
+    }
+    if (start == queue->end() || start->first >= *head) {
+      return false;
+    }
+  }
+
+  batch->is_write_ = is_write;
+  auto it = start;
+  auto next_page_id = start->first;
+  while (it != queue->end() && it->first == next_page_id && batch->page_ids_.size() < max_batch_size_ &&
+         CanIssue(it->first, is_write)) {
+    batch->page_ids_.push_back(it->first);
+    batch->requests_.push_back(std::move(it->second));
+    in_flight_.insert(it->first);
+    it = queue->erase(it);
+    next_page_id++;
+  }
+  *head = next_page_id;
+  return true;
+}
+
+void DiskScheduler::IssueBatch(Batch *batch) {
+  std::vector<char *> pages_data;
+  pages_data.reserve(batch->page_ids_.size());
+  for (auto &requests : batch->requests_) {
+    // A write stores the data of the last request. Reads of the same page share the buffer of the first one.
+    pages_data.push_back(batch->is_write_ ? requests.back().data_ : requests.front().data_);
+  }
+
+  std::exception_ptr error;
+  try {
+    if (batch->is_write_) {
+      disk_manager_->WritePages(batch->page_ids_, pages_data);
+    } else {
+      disk_manager_->ReadPages(batch->page_ids_, pages_data);
+      for (size_t i = 0; i < batch->requests_.size(); i++) {
+        for (size_t j = 1; j < batch->requests_[i].size(); j++) {
+          memcpy(batch->requests_[i][j].data_, pages_data[i], BUSTUB_PAGE_SIZE);
+        }
+      }
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  size_t completed = 0;
+  for (auto &requests : batch->requests_) {
+    completed += requests.size();
+  }
+
+  // The counters are updated first, so that they account for a request by the time its future is ready.
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (batch->is_write_) {
+      stats_.writes_ += completed;
+      stats_.write_batches_++;
+      stats_.superseded_writes_ += completed - batch->page_ids_.size();
+    } else {
+      stats_.reads_ += completed;
+      stats_.read_batches_++;
+    }
+  }
+
+  for (auto &requests : batch->requests_) {
+    for (auto &request : requests) {
+      Complete(&request, error);
+    }
+  }
+
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    for (auto page_id : batch->page_ids_) {
+      in_flight_.erase(page_id);
+    }
+    outstanding_ -= completed;
+    if (outstanding_ == 0) {
+      idle_cv_.notify_all();
+    }
+  }
+  // Requests of these pages that were held back can be issued now.
+  work_cv_.notify_all();
+}
+
+void DiskScheduler::Complete(DiskRequest *request, const std::exception_ptr &error) {
+  if (request->on_complete_) {
+    request->on_complete_(error == nullptr);
+  }
+  if (error == nullptr) {
+    request->callback_.set_value(true);
+  } else {
+    request->callback_.set_exception(error);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.cpp
+//
+// Identification: src/storage/disk/free_page_map.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_page_map.h"
+
+#include <iterator>
+#include <vector>
+
+#include "storage/disk/page_id_file.h"
+
+namespace bustub {
+
+namespace {
+
+constexpr char FREE_PAGE_FILE_MAGIC[8] = "BTFREPG";
+constexpr uint32_t FREE_PAGE_FILE_VERSION = 1;
+
+}  // namespace
+
+auto FreePageMap::Add(page_id_t page_id) -> bool {
+  if (!free_pages_.insert(page_id).second) {
+    return false;
+  }
+  dirty_ = true;
+  return true;
+}
+
+auto FreePageMap::Take(uint32_t stride, uint32_t residue) -> page_id_t {
+  for (auto it = free_pages_.begin(); it != free_pages_.end(); ++it) {
+    if (static_cast<uint32_t>(*it) % stride == residue) {
+      auto page_id = *it;
+      free_pages_.erase(it);
+      dirty_ = true;
+      return page_id;
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+auto FreePageMap::TakeRun(size_t num_pages) -> page_id_t {
+  auto run_start = free_pages_.begin();
+  size_t run_size = 0;
+  for (auto it = free_pages_.begin(); it != free_pages_.end(); ++it) {
+    if (run_size == 0 || *it != *std::prev(it) + 1) {
+      run_start = it;
+      run_size = 0;
+    }
+    if (++run_size == num_pages) {
+      auto page_id = *run_start;
+      free_pages_.erase(run_start, std::next(it));
+      dirty_ = true;
+      return page_id;
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+auto FreePageMap::TrailingRunStart(page_id_t end_page_id) const -> page_id_t {
+  auto start = end_page_id;
+  for (auto it = free_pages_.lower_bound(end_page_id); it != free_pages_.begin();) {
+    --it;
+    if (*it != start - 1) {
+      break;
+    }
+    start = *it;
+  }
+  return start;
+}
+
+auto FreePageMap::Write(const std::string &file_name) -> bool {
+  std::vector<page_id_t> page_ids(free_pages_.begin(), free_pages_.end());
+  if (!PageIdFile::Write(file_name, FREE_PAGE_FILE_MAGIC, FREE_PAGE_FILE_VERSION, page_ids)) {
+    return false;
+  }
+  dirty_ = false;
+  return true;
+}
+
+auto FreePageMap::Read(const std::string &file_name) -> bool {
+  free_pages_.clear();
+  dirty_ = false;
+  auto page_ids = PageIdFile::Read(file_name, FREE_PAGE_FILE_MAGIC, FREE_PAGE_FILE_VERSION);
+  if (!page_ids.has_value()) {
+    return false;
+  }
+  free_pages_.insert(page_ids->begin(), page_ids->end());
+  return true;
+}
+
+auto FreePageMap::FileNameFor(const std::string &db_file_name) -> std::string {
+  // Like the log file, the free page file replaces the extension of the database file.
+  auto n = db_file_name.rfind('.');
+  return (n == std::string::npos ? db_file_name : db_file_name.substr(0, n)) + ".fsm";
+}
+
+}  // namespace bustub
@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_id_file.cpp
+//
+// Identification: src/storage/disk/page_id_file.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_id_file.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * Write a whole buffer to a file, resuming after partial or interrupted writes
+ */
+static auto WriteAll(int fd, const char *data, size_t size) -> bool {
+  while (size > 0) {
+    auto n = write(fd, data, size);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    data += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+auto PageIdFile::Write(const std::string &file_name, const char *magic, uint32_t version,
+                       const std::vector<page_id_t> &page_ids) -> bool {
+  PageIdFileHeader header{};
+  memcpy(header.magic_, magic, sizeof(header.magic_));
+  header.version_ = version;
+  header.num_pages_ = static_cast<uint32_t>(page_ids.size());
+  std::vector<char> data(sizeof(header) + page_ids.size() * sizeof(page_id_t));
+  memcpy(data.data(), &header, sizeof(header));
+  memcpy(data.data() + sizeof(header), page_ids.data(), page_ids.size() * sizeof(page_id_t));
+
+  auto tmp_file_name = file_name + ".tmp";
+  int fd = open(tmp_file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);  // NOLINT
+  if (fd < 0) {
+    return false;
+  }
+  // The data must be durable before the rename makes it the file, or a crash may leave an empty or partial file under
+  // the name of the file.
+  bool ok = WriteAll(fd, data.data(), data.size());
+  if (ok) {
+    int rc;
+    do {
+      rc = fdatasync(fd);
+    } while (rc < 0 && errno == EINTR);
+    ok = rc == 0;
+  }
+  ok = close(fd) == 0 && ok;
+  if (!ok || rename(tmp_file_name.c_str(), file_name.c_str()) != 0) {
+    remove(tmp_file_name.c_str());
+    return false;
+  }
+  DiskManager::SyncDirectoryOf(file_name);
+  return true;
+}
+
+auto PageIdFile::Read(const std::string &file_name, const char *magic, uint32_t version)
+    -> std::optional<std::vector<page_id_t>> {
+  std::ifstream file(file_name, std::ios::binary);
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+  PageIdFileHeader header{};
+  if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      memcmp(header.magic_, magic, sizeof(header.magic_)) != 0 || header.version_ != version) {
+    return std::nullopt;
+  }
+  std::vector<page_id_t> page_ids(header.num_pages_);
+  if (!file.read(reinterpret_cast<char *>(page_ids.data()),
+                 static_cast<std::streamsize>(page_ids.size() * sizeof(page_id_t)))) {
+    return std::nullopt;
+  }
+  return page_ids;
+}
+
+}  // namespace bustub
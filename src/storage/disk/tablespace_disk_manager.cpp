@@ -0,0 +1,177 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tablespace_disk_manager.cpp
+//
+// Identification: src/storage/disk/tablespace_disk_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/tablespace_disk_manager.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+TablespaceDiskManager::TablespaceDiskManager(const std::string &db_file, DiskIoMode io_mode)
+    : DiskManager(db_file, io_mode) {
+  names_.emplace(DEFAULT_TABLESPACE_NAME, DEFAULT_TABLESPACE);
+}
+
+auto TablespaceDiskManager::AddTablespace(const std::string &name, const std::string &file_name, DiskIoMode io_mode)
+    -> tablespace_id_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (names_.count(name) > 0) {
+    throw Exception("tablespace " + name + " already exists");
+  }
+  if (names_.size() >= MAX_TABLESPACES) {
+    throw Exception("too many tablespaces");
+  }
+  auto tablespace = static_cast<tablespace_id_t>(names_.size());
+  // Tablespaces have no log of their own, the log of the database covers them.
+  auto file = std::make_unique<DiskManager>(file_name, io_mode, false);
+  ends_[tablespace] = file->GetNumPages();
+  files_[tablespace] = std::move(file);
+  names_.emplace(name, tablespace);
+  return tablespace;
+}
+
+auto TablespaceDiskManager::GetTablespace(const std::string &name) -> std::optional<tablespace_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = names_.find(name);
+  if (it == names_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+auto TablespaceDiskManager::GetNumTablespaces() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return names_.size();
+}
+
+/**
+ * The slot of a tablespace is written before its id is handed out, so reading it takes no latch
+ */
+auto TablespaceDiskManager::GetFile(tablespace_id_t tablespace) const -> DiskManager * {
+  if (tablespace >= MAX_TABLESPACES || files_[tablespace] == nullptr) {
+    throw Exception("unknown tablespace " + std::to_string(tablespace));
+  }
+  return files_[tablespace].get();
+}
+
+template <typename Fn>
+void TablespaceDiskManager::ForEachTablespace(const std::vector<page_id_t> &page_ids,
+                                              const std::vector<char *> &pages_data, Fn &&fn) {
+  assert(page_ids.size() == pages_data.size());
+  size_t first = 0;
+  while (first < page_ids.size()) {
+    auto tablespace = TablespaceOf(page_ids[first]);
+    size_t end = first + 1;
+    while (end < page_ids.size() && TablespaceOf(page_ids[end]) == tablespace) {
+      end++;
+    }
+    // Batches of the database file alone, the common case, are passed on as they are.
+    if (tablespace == DEFAULT_TABLESPACE && first == 0 && end == page_ids.size()) {
+      fn(nullptr, page_ids, pages_data);
+      return;
+    }
+    std::vector<page_id_t> run_page_ids;
+    run_page_ids.reserve(end - first);
+    for (size_t i = first; i < end; i++) {
+      run_page_ids.push_back(tablespace == DEFAULT_TABLESPACE ? page_ids[i] : LocalPageId(page_ids[i]));
+    }
+    std::vector<char *> run_pages_data(pages_data.begin() + first, pages_data.begin() + end);
+    fn(tablespace == DEFAULT_TABLESPACE ? nullptr : GetFile(tablespace), run_page_ids, run_pages_data);
+    first = end;
+  }
+}
+
+void TablespaceDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  auto tablespace = TablespaceOf(page_id);
+  if (tablespace == DEFAULT_TABLESPACE) {
+    DiskManager::WritePage(page_id, page_data);
+    return;
+  }
+  num_writes_ += 1;
+  GetFile(tablespace)->WritePage(LocalPageId(page_id), page_data);
+}
+
+void TablespaceDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  auto tablespace = TablespaceOf(page_id);
+  if (tablespace == DEFAULT_TABLESPACE) {
+    DiskManager::ReadPage(page_id, page_data);
+    return;
+  }
+  GetFile(tablespace)->ReadPage(LocalPageId(page_id), page_data);
+}
+
+void TablespaceDiskManager::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) {
+  ForEachTablespace(page_ids, pages_data,
+                    [&](DiskManager *file, const std::vector<page_id_t> &run_page_ids,
+                        const std::vector<char *> &run_pages_data) {
+                      if (file == nullptr) {
+                        DiskManager::ReadPages(run_page_ids, run_pages_data);
+                      } else {
+                        file->ReadPages(run_page_ids, run_pages_data);
+                      }
+                    });
+}
+
+void TablespaceDiskManager::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) {
+  ForEachTablespace(page_ids, pages_data,
+                    [&](DiskManager *file, const std::vector<page_id_t> &run_page_ids,
+                        const std::vector<char *> &run_pages_data) {
+                      if (file == nullptr) {
+                        DiskManager::WritePages(run_page_ids, run_pages_data);
+                      } else {
+                        num_writes_ += static_cast<int>(run_page_ids.size());
+                        file->WritePages(run_page_ids, run_pages_data);
+                      }
+                    });
+}
+
+void TablespaceDiskManager::Sync() {
+  DiskManager::Sync();
+  for (size_t tablespace = DEFAULT_TABLESPACE + 1; tablespace < GetNumTablespaces(); tablespace++) {
+    GetFile(static_cast<tablespace_id_t>(tablespace))->Sync();
+  }
+}
+
+void TablespaceDiskManager::DeallocatePage(page_id_t page_id) {
+  auto tablespace = TablespaceOf(page_id);
+  if (tablespace == DEFAULT_TABLESPACE) {
+    DiskManager::DeallocatePage(page_id);
+    return;
+  }
+  GetFile(tablespace)->DeallocatePage(LocalPageId(page_id));
+}
+
+auto TablespaceDiskManager::AllocateExtent(tablespace_id_t tablespace, size_t num_pages) -> page_id_t {
+  auto *file = GetFile(tablespace);
+  // Pages deallocated in the tablespace are reused once they add up to a whole extent, e.g. when an object goes away.
+  if (auto first = file->AllocateFreeRun(num_pages); first != INVALID_PAGE_ID) {
+    return MakePageId(tablespace, first);
+  }
+  std::scoped_lock<std::mutex> lock(latch_);
+  // Pages may have been written past the reserved ones by hand.
+  auto first = std::max(ends_[tablespace], file->GetNumPages());
+  if (static_cast<size_t>(first) + num_pages > TABLESPACE_MAX_PAGES) {
+    throw Exception("tablespace " + std::to_string(tablespace) + " is full");
+  }
+  ends_[tablespace] = first + static_cast<page_id_t>(num_pages);
+  return MakePageId(tablespace, first);
+}
+
+auto TablespaceDiskManager::GetTablespaceEnd(tablespace_id_t tablespace) -> page_id_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return MakePageId(tablespace, ends_[tablespace]);
+}
+
+}  // namespace bustub
@@ -1,4 +1,8 @@
+#include <algorithm>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -9,13 +13,15 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, tablespace_id_t tablespace)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {
+      internal_max_size_(internal_max_size),
+      leaf_extent_(EXTENT_SIZE, tablespace),
+      internal_extent_(EXTENT_SIZE, tablespace) {
   LOG_INFO("# [bpt INIT]leaf max size:%d, internal max size:%d", leaf_max_size, internal_max_size);
 }
 
@@ -23,7 +29,12 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manag
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return root_page_id_ == INVALID_PAGE_ID; }
+auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
+  root_latch_.RLock();
+  bool is_empty = root_page_id_ == INVALID_PAGE_ID;
+  root_latch_.RUnlock();
+  return is_empty;
+}
 
 /*
  * Helper function to get the leaf node size
@@ -32,40 +43,139 @@ INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetMaxSize() const -> size_t { return leaf_max_size_; }
 
 /*
- * Helper function to find the leafnode int the current b+tree
+ * A page is safe for an operation if the operation can't split it or make it underflow, so that its parent won't
+ * change. Removing from the root changes it only when an internal root is left with a single child
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::FindLeaf(BPlusTreePage *bpt_page, const KeyType &key, const KeyComparator &cmp) const
-    -> BPlusTreePage * {
-  if (bpt_page->IsLeafPage()) {
-    auto leaf_page = reinterpret_cast<LeafPage *>(bpt_page);
-    LOG_INFO("# [bpt FindLeaf]leaf finded!which has the first key:%ld", leaf_page->KeyAt(0).ToString());
-    return bpt_page;
+auto BPLUSTREE_TYPE::IsSafe(BPlusTreePage *bpt_page, Operation op) const -> bool {
+  switch (op) {
+    case Operation::FIND:
+      return true;
+    case Operation::INSERT:
+      return bpt_page->IsLeafPage() ? bpt_page->GetSize() < leaf_max_size_ - 1
+                                    : bpt_page->GetSize() < internal_max_size_;
+    case Operation::REMOVE:
+      if (bpt_page->IsRootPage()) {
+        return bpt_page->IsLeafPage() || bpt_page->GetSize() > 2;
+      }
+      return bpt_page->GetSize() - 1 >= MinSize(bpt_page);
   }
-  auto internal_page = reinterpret_cast<InternalPage *>(bpt_page);
+  return false;
+}
+
+/*
+ * A leaf splits into two halves once it holds leaf_max_size_ entries, an internal page once it would hold more than
+ * internal_max_size_ children. A page other than the root underflows below the size of the smaller half
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::MinSize(BPlusTreePage *bpt_page) const -> int {
+  return bpt_page->IsLeafPage() ? leaf_max_size_ / 2 : (internal_max_size_ + 1) / 2;
+}
 
-  Page *node_page;
-  int index = internal_page->FindSmallestBiggerKV(key, cmp);
-  LOG_INFO("# [bpt FindLeaf]next index is %d", index);
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetParentOf(page_id_t child_page_id, page_id_t parent_page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(child_page_id);
+  BUSTUB_ENSURE(page != nullptr, "FetchPage child nullptr!");
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(parent_page_id);
+  buffer_pool_manager_->UnpinPage(child_page_id, true);
+}
 
-  node_page = buffer_pool_manager_->FetchPage(internal_page->ValueAt(index));
-  BUSTUB_ENSURE(node_page != nullptr, "FetchPage node_page nullptr!");
+/*
+ * Optimistic descent: read latch crabbing from the root, the root latch being held until the root page is latched.
+ * The leaf is write latched for an insert or a remove, which is all they need if it turns out to be safe.
+ * The type of a child is read before it is latched: a page never changes type while its parent links to it
+ * @return : the pinned and latched leaf, or nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LatchLeaf(const KeyType &key, Operation op, bool leftmost) -> Page * {
+  root_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  BUSTUB_ENSURE(page != nullptr, "FetchPage page nullptr!");
+  auto bpt_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (bpt_page->IsLeafPage() && op != Operation::FIND) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+  root_latch_.RUnlock();
+
+  while (!bpt_page->IsLeafPage()) {
+    auto internal_page = reinterpret_cast<InternalPage *>(bpt_page);
+    int index = leftmost ? 0 : internal_page->FindSmallestBiggerKV(key, comparator_);
+    Page *child = buffer_pool_manager_->FetchPage(internal_page->ValueAt(index));
+    BUSTUB_ENSURE(child != nullptr, "FetchPage child nullptr!");
+    auto child_bpt_page = reinterpret_cast<BPlusTreePage *>(child->GetData());
+    if (child_bpt_page->IsLeafPage() && op != Operation::FIND) {
+      child->WLatch();
+    } else {
+      child->RLatch();
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child;
+    bpt_page = child_bpt_page;
+  }
+  return page;
+}
+
+/*
+ * Pessimistic descent: write latch crabbing from the root. The latches of the ancestors of a safe page, the root latch
+ * included, are released, since the operation won't reach them
+ * @return : the pages still latched, see the declaration
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LatchPath(const KeyType &key, Operation op) -> std::deque<Page *> {
+  std::deque<Page *> pages;
+  root_latch_.WLock();
+  pages.push_back(nullptr);
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    return pages;
+  }
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    BUSTUB_ENSURE(page != nullptr, "FetchPage page nullptr!");
+    page->WLatch();
+    auto bpt_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (IsSafe(bpt_page, op)) {
+      ReleasePath(&pages, false);
+    }
+    pages.push_back(page);
+    if (bpt_page->IsLeafPage()) {
+      return pages;
+    }
+    auto internal_page = reinterpret_cast<InternalPage *>(bpt_page);
+    page_id = internal_page->ValueAt(internal_page->FindSmallestBiggerKV(key, comparator_));
+  }
+}
 
-  buffer_pool_manager_->UnpinPage(internal_page->GetPageId(), false);
-  auto new_page = reinterpret_cast<BPlusTreePage *>(node_page->GetData());
-  return FindLeaf(new_page, key, cmp);
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleasePath(std::deque<Page *> *pages, bool is_dirty) {
+  for (Page *page : *pages) {
+    if (page == nullptr) {
+      root_latch_.WUnlock();
+      continue;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  }
+  pages->clear();
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::InsertInParent(BPlusTreePage *old_page, const KeyType &key, BPlusTreePage *new_page) -> void {
-  LOG_INFO("# [bpt InsertInParent]key:%ld", key.ToString());
+  // old_page is pinned by the caller, new_page is unpinned here.
 
   auto internal_page = reinterpret_cast<InternalPage *>(old_page);
   auto new_internal_page = reinterpret_cast<InternalPage *>(new_page);
 
   if (internal_page->IsRootPage()) {
     page_id_t new_root_page_id;
-    Page *new_root_page = buffer_pool_manager_->NewPage(&new_root_page_id);
+    Page *new_root_page = buffer_pool_manager_->NewPage(&new_root_page_id, internal_extent_);
     auto new_root_internal_page = reinterpret_cast<InternalPage *>(new_root_page->GetData());
     new_root_internal_page->Init(new_root_page_id, INVALID_PAGE_ID, internal_max_size_);
     root_page_id_ = new_root_page_id;
@@ -74,24 +184,18 @@ auto BPLUSTREE_TYPE::InsertInParent(BPlusTreePage *old_page, const KeyType &key,
     new_root_internal_page->SetValueAt(1, new_internal_page->GetPageId());
     new_root_internal_page->IncreaseSize(2);
     UpdateRootPageId(0);
-    LOG_INFO("# [bpt InsertInParent]create new root, key:%ld, root page id:%d", key.ToString(), root_page_id_);
     internal_page->SetParentPageId(root_page_id_);
     new_internal_page->SetParentPageId(root_page_id_);
-    LOG_INFO("# [bpt InsertInParent]parent page id:%d", old_page->GetParentPageId());
-    buffer_pool_manager_->UnpinPage(old_page->GetPageId(), true);
     buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
     buffer_pool_manager_->UnpinPage(new_root_page_id, true);
     return;
   }
   page_id_t parent_page_id = internal_page->GetParentPageId();
-  buffer_pool_manager_->UnpinPage(old_page->GetPageId(), true);
-
   Page *parent_page = buffer_pool_manager_->FetchPage(parent_page_id);
   BUSTUB_ENSURE(parent_page != nullptr, "FetchPage parent_page nullptr!");
   auto parent_bpt_page = reinterpret_cast<InternalPage *>(parent_page->GetData());
 
   if (parent_bpt_page->GetSize() < internal_max_size_) {
-    LOG_INFO("# [bpt InsertInParent]parent node is not full, do insert");
     parent_bpt_page->InternalInsert(key, new_page->GetPageId(), comparator_);
     new_page->SetParentPageId(parent_page_id);
     buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
@@ -99,58 +203,55 @@ auto BPLUSTREE_TYPE::InsertInParent(BPlusTreePage *old_page, const KeyType &key,
     return;
   }
 
-  LOG_INFO("# [bpt InsertInParent]parent node is full, do split");
-  page_id_t copy_page_id;
-  Page *copy_page = buffer_pool_manager_->NewPage(&copy_page_id);
-  auto internal_copy_page = reinterpret_cast<InternalPage *>(copy_page->GetData());
-  internal_copy_page->Init(copy_page_id, parent_bpt_page->GetParentPageId(), internal_max_size_);
-
+  // The entries of the parent with the new one, which don't fit in a page.
+  std::vector<std::pair<KeyType, page_id_t>> entries;
+  entries.reserve(parent_bpt_page->GetSize() + 1);
   for (int i = 0; i < parent_bpt_page->GetSize(); i++) {
-    internal_copy_page->SetKeyAt(i, parent_bpt_page->KeyAt(i));
-    internal_copy_page->SetValueAt(i, parent_bpt_page->ValueAt(i));
-    internal_copy_page->IncreaseSize(1);
+    entries.emplace_back(parent_bpt_page->KeyAt(i), parent_bpt_page->ValueAt(i));
   }
-
-  internal_copy_page->InternalInsert(key, new_page->GetPageId(), comparator_);
+  auto position = std::upper_bound(entries.begin() + 1, entries.end(), key, [&](const KeyType &k, const auto &entry) {
+    return comparator_(k, entry.first) < 0;
+  });
+  entries.insert(position, {key, new_page->GetPageId()});
   parent_bpt_page->EraseAll();
   buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
 
   page_id_t new_parent_page_id;
-  Page *new_parent_page = buffer_pool_manager_->NewPage(&new_parent_page_id);
+  Page *new_parent_page = buffer_pool_manager_->NewPage(&new_parent_page_id, internal_extent_);
   auto new_parent_internal_bpt_page = reinterpret_cast<InternalPage *>(new_parent_page->GetData());
   new_parent_internal_bpt_page->Init(new_parent_page_id, parent_bpt_page->GetParentPageId(), internal_max_size_);
+  int num_entries = static_cast<int>(entries.size());
+  // The children are moved without their latches. Their parent page id is only read by a writer that holds the latch of
+  // this page too, and the optimistic writers and readers that may hold a child meanwhile don't touch it. Latching them
+  // could deadlock with an iterator that holds one leaf and waits for the next one, latched by this thread.
   int i = 0;
-  while (i < internal_copy_page->GetSize() / 2) {
-    LOG_INFO("# [bpt InsertInParent] first half, i:%d, key:%ld", i, internal_copy_page->KeyAt(i).ToString());
-    parent_bpt_page->SetKeyAt(i, internal_copy_page->KeyAt(i));
-    parent_bpt_page->SetValueAt(i, internal_copy_page->ValueAt(i));
-    Page *temp_page = buffer_pool_manager_->FetchPage(internal_copy_page->ValueAt(i));
+  while (i < num_entries / 2) {
+    parent_bpt_page->SetKeyAt(i, entries[i].first);
+    parent_bpt_page->SetValueAt(i, entries[i].second);
+    Page *temp_page = buffer_pool_manager_->FetchPage(entries[i].second);
     BUSTUB_ENSURE(temp_page != nullptr, "FetchPage temp_page1 nullptr!");
-    auto temp_leaf_page = reinterpret_cast<LeafPage *>(temp_page);
-    temp_leaf_page->SetParentPageId(parent_page_id);
-    buffer_pool_manager_->UnpinPage(internal_copy_page->ValueAt(i), true);
+    auto temp_bpt_page = reinterpret_cast<BPlusTreePage *>(temp_page->GetData());
+    temp_bpt_page->SetParentPageId(parent_page_id);
+    buffer_pool_manager_->UnpinPage(entries[i].second, true);
     parent_bpt_page->IncreaseSize(1);
     i++;
   }
-  KeyType new_key = internal_copy_page->KeyAt(i);
+  KeyType new_key = entries[i].first;
   int j = 0;
-  while (i < internal_copy_page->GetSize()) {
-    LOG_INFO("# [bpt InsertInParent] second half, i:%d, j:%d key:%ld", i, j, internal_copy_page->KeyAt(i).ToString());
-    new_parent_internal_bpt_page->SetKeyAt(j, internal_copy_page->KeyAt(i));
-    new_parent_internal_bpt_page->SetValueAt(j++, internal_copy_page->ValueAt(i));
-    Page *temp_page = buffer_pool_manager_->FetchPage(internal_copy_page->ValueAt(i));
+  while (i < num_entries) {
+    new_parent_internal_bpt_page->SetKeyAt(j, entries[i].first);
+    new_parent_internal_bpt_page->SetValueAt(j++, entries[i].second);
+    Page *temp_page = buffer_pool_manager_->FetchPage(entries[i].second);
     BUSTUB_ENSURE(temp_page != nullptr, "FetchPage temp_page2 nullptr!");
-    auto temp_leaf_page = reinterpret_cast<LeafPage *>(temp_page);
-    temp_leaf_page->SetParentPageId(new_parent_page_id);
-    buffer_pool_manager_->UnpinPage(internal_copy_page->ValueAt(i), true);
+    auto temp_bpt_page = reinterpret_cast<BPlusTreePage *>(temp_page->GetData());
+    temp_bpt_page->SetParentPageId(new_parent_page_id);
+    buffer_pool_manager_->UnpinPage(entries[i].second, true);
     new_parent_internal_bpt_page->IncreaseSize(1);
     i++;
   }
-  buffer_pool_manager_->DeletePage(copy_page_id);
 
   InsertInParent(parent_bpt_page, new_key, new_parent_internal_bpt_page);
-  // buffer_pool_manager_->UnpinPage(parent_page_id, true);
-  // buffer_pool_manager_->UnpinPage(new_parent_page_id, true);
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -166,7 +267,7 @@ auto BPLUSTREE_TYPE::CheckRedundant(LeafPage *leaf_page, const KeyType &key, con
       high = mid;
     }
   }
-  return comparator_(leaf_page->KeyAt(low), key) == 0;
+  return low < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(low), key) == 0;
 }
 
 /*****************************************************************************
@@ -179,22 +280,19 @@ auto BPLUSTREE_TYPE::CheckRedundant(LeafPage *leaf_page, const KeyType &key, con
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
-  if (IsEmpty()) {
+  Page *page = LatchLeaf(key, Operation::FIND);
+  if (page == nullptr) {
     return false;
   }
   ValueType value;
-  page_id_t current_page_id = GetRootPageId();
-  Page *page = buffer_pool_manager_->FetchPage(current_page_id);
-  BUSTUB_ENSURE(page != nullptr, "FetchPage page nullptr!");
-  auto bpt_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
-
-  auto leaf_page = reinterpret_cast<LeafPage *>(FindLeaf(bpt_page, key, comparator_));
-  if (leaf_page->FindKey(key, &value, comparator_)) {
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+  auto leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  bool found = leaf_page->FindKey(key, &value, comparator_);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (found) {
     result->push_back(value);
-    return true;
   }
-  return false;
+  return found;
 }
 
 /*****************************************************************************
@@ -206,14 +304,30 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * entry, otherwise insert into leaf page.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
+ *
+ * The leaf is found optimistically first, and the insert is done right there if the leaf is not full. Otherwise it
+ * starts over with the path to the leaf write latched up to the first page that won't split.
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  LOG_INFO("# [bpt Insert] ***********now insert key: %ld*************", key.ToString());
-  if (IsEmpty()) {
-    LOG_INFO("# [bpt Insert]tree is empty, now create root and insert");
+  if (Page *page = LatchLeaf(key, Operation::INSERT); page != nullptr) {
+    auto leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    bool is_duplicate = CheckRedundant(leaf_page, key, comparator_);
+    bool is_safe = IsSafe(leaf_page, Operation::INSERT);
+    if (!is_duplicate && is_safe) {
+      leaf_page->LeafInsert(key, value, comparator_);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), !is_duplicate && is_safe);
+    if (is_duplicate || is_safe) {
+      return !is_duplicate;
+    }
+  }
+
+  std::deque<Page *> pages = LatchPath(key, Operation::INSERT);
+  if (pages.back() == nullptr) {
     page_id_t new_page_id;
-    Page *new_page = buffer_pool_manager_->NewPage(&new_page_id);
+    Page *new_page = buffer_pool_manager_->NewPage(&new_page_id, leaf_extent_);
     root_page_id_ = new_page_id;
     UpdateRootPageId(1);
     auto root_page = reinterpret_cast<LeafPage *>(new_page->GetData());
@@ -222,44 +336,27 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     root_page->SetValueAt(0, value);
     root_page->IncreaseSize(1);
     buffer_pool_manager_->UnpinPage(new_page_id, true);
+    ReleasePath(&pages, false);
     return true;
   }
-  page_id_t current_root_id = GetRootPageId();
-  Page *page = buffer_pool_manager_->FetchPage(current_root_id);
-  BUSTUB_ENSURE(page != nullptr, "FetchPage page nullptr!");
-  auto bpt_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
-  // debug lines, wait to delete
-
-  auto temp_page = reinterpret_cast<InternalPage *>(bpt_page);
-  LOG_INFO("# [bpt Insert] Now the root's first key is:%ld", temp_page->KeyAt(1).ToString());
-
-  auto leaf_page = reinterpret_cast<LeafPage *>(FindLeaf(bpt_page, key, comparator_));
-  LOG_INFO("# [bpt Insert]parent_page_id:%d", leaf_page->GetParentPageId());
 
-  // check if there is a redundant key
+  // The leaf may have changed since it was latched for reading.
+  auto leaf_page = reinterpret_cast<LeafPage *>(pages.back()->GetData());
   if (CheckRedundant(leaf_page, key, comparator_)) {
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+    ReleasePath(&pages, false);
     return false;
   }
-
-  if (leaf_page->GetSize() < leaf_max_size_ - 1) {
-    // InsertInLeaf(bpt_page, key, value);
-    LOG_INFO("# [bpt Insert]leaf node is not full, do insert");
+  if (IsSafe(leaf_page, Operation::INSERT)) {
     leaf_page->LeafInsert(key, value, comparator_);
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+    ReleasePath(&pages, true);
     return true;
   }
 
-  LOG_INFO("# [bpt Insert]leaf node is full, now split");
   page_id_t new_parent_page_id;
-  Page *new_parent_page = buffer_pool_manager_->NewPage(&new_parent_page_id);
+  Page *new_parent_page = buffer_pool_manager_->NewPage(&new_parent_page_id, leaf_extent_);
   auto new_leaf_page = reinterpret_cast<LeafPage *>(new_parent_page->GetData());
   new_leaf_page->Init(new_parent_page_id, leaf_page->GetParentPageId(), leaf_max_size_);
 
-  // page_id_t new_page_id;
-  // Page *new_page = buffer_pool_manager_->NewPage(&new_page_id);
-  // auto temp_leaf_page = reinterpret_cast<LeafPage *>(new_page->GetData());
-  // temp_leaf_page->Init(new_page_id, leaf_page->GetParentPageId(), leaf_max_size_);
   new_leaf_page->SetNextPageId(leaf_page->GetNextPageId());
   leaf_page->SetNextPageId(new_leaf_page->GetPageId());
 
@@ -267,36 +364,9 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   leaf_page->CopyHalfTo(new_leaf_page);
   leaf_page->SetSize(leaf_page->GetSize() / 2);
 
-  // for (int i = 0; i < leaf_page->GetSize(); i++) {
-  //   // LOG_INFO("# [bpt Insert] now got key:%ld", leaf_page->KeyAt(i).ToString());
-  //   temp_leaf_page->SetKeyAt(i, leaf_page->KeyAt(i));
-  //   temp_leaf_page->SetValueAt(i, leaf_page->ValueAt(i));
-  //   temp_leaf_page->IncreaseSize(1);
-  // }
-
-  // temp_leaf_page->LeafInsert(key, value, comparator_);
-
-  // leaf_page->EraseAll();
-
-  // LOG_INFO("# [bpt Insert]now move kvs");
-  // // move half
-  // int i = 0;
-  // for (; i < temp_leaf_page->GetSize() / 2; i++) {
-  //   LOG_INFO("# [bpt Insert] first half, i:%d, key:%ld", i, temp_leaf_page->KeyAt(i).ToString());
-  //   leaf_page->KVInsert(i, temp_leaf_page->KeyAt(i), temp_leaf_page->ValueAt(i));
-  // }
-  // // temp_leaf_page->CopyNTo(leaf_page, temp_n/2);
-  // // temp_leaf_page->CopyNTo(new_leaf_page, )
-  // int j = 0;
-  // for (; i < temp_leaf_page->GetSize(); i++) {
-  //   LOG_INFO("# [bpt Insert] second half, i:%d, j:%d key:%ld", i, j, temp_leaf_page->KeyAt(i).ToString());
-  //   new_leaf_page->KVInsert(j++, temp_leaf_page->KeyAt(i), temp_leaf_page->ValueAt(i));
-  // }
-  // buffer_pool_manager_->DeletePage(new_page_id);
-  LOG_INFO("# [bpt Insert] new l, key:%ld, parent_page_id:%d", new_leaf_page->KeyAt(0).ToString(),
-           new_leaf_page->GetParentPageId());
   InsertInParent(leaf_page, new_leaf_page->KeyAt(0), new_leaf_page);
 
+  ReleasePath(&pages, true);
   return true;
 }
 
@@ -312,239 +382,238 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
-  if (IsEmpty()) {
-    LOG_INFO("# [bpt Remove] the tree is empty, can't remove");
+  Page *page = LatchLeaf(key, Operation::REMOVE);
+  if (page == nullptr) {
+    return;
+  }
+  auto leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  bool is_safe = IsSafe(leaf_page, Operation::REMOVE);
+  if (is_safe) {
+    leaf_page->DeleteKey(key, comparator_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), is_safe);
+  if (is_safe) {
     return;
   }
-  LOG_INFO("# [bpt Remove]***********now remove key:%ld*************", key.ToString());
-  page_id_t current_root_id = GetRootPageId();
-  Page *page = buffer_pool_manager_->FetchPage(current_root_id);
-  BUSTUB_ENSURE(page != nullptr, "FetchPage page nullptr!");
-  auto bpt_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
 
-  RemoveEntry(FindLeaf(bpt_page, key, comparator_), key);
+  // The leaf would underflow: start over, latching the pages a merge or a redistribution may reach.
+  std::vector<page_id_t> deleted_pages;
+  while (true) {
+    std::deque<Page *> pages = LatchPath(key, Operation::REMOVE);
+    if (pages.back() == nullptr) {
+      ReleasePath(&pages, false);
+      return;
+    }
+    leaf_page = reinterpret_cast<LeafPage *>(pages.back()->GetData());
+    std::deque<Page *> brothers;
+    if (LatchBrothers(leaf_page, key, &brothers)) {
+      RemoveEntry(leaf_page, key, &brothers, &deleted_pages);
+      ReleasePath(&pages, true);
+      break;
+    }
+    // A brother is held, maybe by an iterator that waits for the leaf or by a thread that waits for an iterator: let
+    // them move on.
+    ReleasePath(&pages, false);
+    std::this_thread::yield();
+  }
+  // The pages merged away are no longer linked from the tree, and no longer pinned by this thread. Another thread may
+  // still pin one for a moment, between releasing its latch and unpinning it: wait for it to let go, as nothing can
+  // pin the page again.
+  for (auto page_id : deleted_pages) {
+    while (!buffer_pool_manager_->DeletePage(page_id)) {
+      std::this_thread::yield();
+    }
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::FindBrotherPage(BPlusTreePage *page, const page_id_t &page_id, int *key_index,
                                      page_id_t *bro_page_id_left, page_id_t *bro_page_id_right) const -> void {
+  // key_index is the index of the key that separates the page from its brother in the parent
   auto parent_page = reinterpret_cast<InternalPage *>(page);
   *bro_page_id_left = INVALID_PAGE_ID;
   *bro_page_id_right = INVALID_PAGE_ID;
-  LOG_INFO("#[bpt FindBroPage] now got page id: %d, parent page id:%d, parent size:%d", page_id, page->GetPageId(),
-           parent_page->GetSize());
   for (int i = 0; i < parent_page->GetSize(); i++) {
-    LOG_INFO("#[bpt FindBroPage] now check parent index: %d", i);
     if (parent_page->ValueAt(i) == page_id) {
       if (i == 0) {
         *bro_page_id_right = parent_page->ValueAt(1);
-        *key_index = 0;
-        LOG_INFO("# [bpt FindBroPage] now got right page at index: 1");
+        *key_index = 1;
         return;
       }
       *bro_page_id_left = parent_page->ValueAt(i - 1);
       *key_index = i;
-      LOG_INFO("#[bpt FindBroPage] now got left page at index: %d", *key_index);
       return;
     }
   }
-  LOG_INFO("# [bpt FindBroPage] can't find bro page");
 }
 
+/*
+ * Leaves are latched from left to right by iterators, which hold a leaf while they wait for the next one, and a thread
+ * waiting for an iterator may hold the parent of a page. A brother is latched while the pages of the path are held, so
+ * its latch is only tried for, and before anything is changed: the remove can then start over
+ * @return : false if a latch is held by someone else, in which case no brother is latched
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::RemoveEntry(BPlusTreePage *bpt_page, const KeyType &key) {
-  if (bpt_page->IsRootPage()) {
-    if (bpt_page->IsLeafPage()) {
-      auto leaf_bpt_page = reinterpret_cast<LeafPage *>(bpt_page);
-      leaf_bpt_page->DeleteKey(key, comparator_);
-      buffer_pool_manager_->UnpinPage(root_page_id_, true);
-    } else if (bpt_page->GetSize() == 2) {
-      LOG_INFO("# [bpt RemoveEntry] node is root & has only one child after delete");
-      auto internal_bpt_page = reinterpret_cast<InternalPage *>(bpt_page);
-      internal_bpt_page->DeleteKey(key, comparator_);
-      root_page_id_ = internal_bpt_page->ValueAt(0);
-      buffer_pool_manager_->DeletePage(internal_bpt_page->GetPageId());
-      Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
-      BUSTUB_ENSURE(page != nullptr, "FetchPage page nullptr!");
-      auto leaf_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
-      leaf_page->SetParentPageId(INVALID_PAGE_ID);
-      buffer_pool_manager_->UnpinPage(root_page_id_, true);
-      UpdateRootPageId(0);
-    }
-    return;
+auto BPLUSTREE_TYPE::LatchBrothers(LeafPage *leaf_page, const KeyType &key, std::deque<Page *> *brothers) -> bool {
+  if (!CheckRedundant(leaf_page, key, comparator_)) {
+    return true;
   }
-
-  if (!bpt_page->IsLeafPage() && bpt_page->GetSize() - 1 < internal_max_size_ / 2) {
-    LOG_INFO("# [bpt RemoveEntry] node is internal & has few pointers");
+  BPlusTreePage *bpt_page = leaf_page;
+  // The pages that underflow, each ancestor of the leaf up to the first one that is redistributed, are write latched by
+  // Remove() and pinned.
+  while (!bpt_page->IsRootPage() && bpt_page->GetSize() - 1 < MinSize(bpt_page)) {
+    page_id_t parent_page_id = bpt_page->GetParentPageId();
+    Page *page = buffer_pool_manager_->FetchPage(parent_page_id);
+    BUSTUB_ENSURE(page != nullptr, "FetchPage page nullptr!");
+    auto parent_page = reinterpret_cast<InternalPage *>(page->GetData());
     page_id_t bro_page_id_left;
     page_id_t bro_page_id_right;
     int parent_key_index = -1;
-    Page *page = buffer_pool_manager_->FetchPage(bpt_page->GetParentPageId());
-    BUSTUB_ENSURE(page != nullptr, "FetchPage page nullptr!");
-    auto parent_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
-    auto bpt_internal_page = reinterpret_cast<InternalPage *>(bpt_page);
-
     FindBrotherPage(parent_page, bpt_page->GetPageId(), &parent_key_index, &bro_page_id_left, &bro_page_id_right);
-    bpt_internal_page->DeleteKey(key, comparator_);
-
-    if (bro_page_id_left != INVALID_PAGE_ID) {
-      Page *left = buffer_pool_manager_->FetchPage(bro_page_id_left);
-      BUSTUB_ENSURE(left != nullptr, "FetchPage left nullptr!");
-      auto left_page = reinterpret_cast<BPlusTreePage *>(left->GetData());
-      auto parent_internal_page = reinterpret_cast<InternalPage *>(parent_page);
-      // auto right_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(bro_page_id_right));
-      if (left_page->GetSize() + bpt_internal_page->GetSize() < internal_max_size_) {
-        CoalesceNodes(bpt_internal_page, left_page, true, parent_internal_page->KeyAt(parent_key_index));
-        RemoveEntry(parent_internal_page, parent_internal_page->KeyAt(parent_key_index));
-        buffer_pool_manager_->DeletePage(bpt_internal_page->GetPageId());
-      } else {
-        KeyType end_key =
-            Redistribution(bpt_internal_page, left_page, false, parent_internal_page->KeyAt(parent_key_index));
-        parent_internal_page->SetKeyAt(parent_key_index, end_key);
-        buffer_pool_manager_->UnpinPage(bpt_page->GetPageId(), true);
-      }
-      buffer_pool_manager_->UnpinPage(bpt_page->GetParentPageId(), true);
-      buffer_pool_manager_->UnpinPage(bro_page_id_left, true);
-    } else {
-      Page *right = buffer_pool_manager_->FetchPage(bro_page_id_right);
-      BUSTUB_ENSURE(right != nullptr, "FetchPage right nullptr!");
-      auto right_page = reinterpret_cast<BPlusTreePage *>(right->GetData());
-      auto parent_internal_page = reinterpret_cast<InternalPage *>(parent_page);
-      if (right_page->GetSize() + bpt_internal_page->GetSize() < internal_max_size_) {
-        CoalesceNodes(bpt_internal_page, right_page, false, parent_internal_page->KeyAt(parent_key_index));
-        RemoveEntry(parent_internal_page, parent_internal_page->KeyAt(parent_key_index));
-        buffer_pool_manager_->DeletePage(bpt_internal_page->GetPageId());
-      } else {
-        KeyType first_key =
-            Redistribution(bpt_internal_page, right_page, true, parent_internal_page->KeyAt(parent_key_index));
-        parent_internal_page->SetKeyAt(parent_key_index, first_key);
+    Page *bro = buffer_pool_manager_->FetchPage(bro_page_id_left != INVALID_PAGE_ID ? bro_page_id_left
+                                                                                     : bro_page_id_right);
+    BUSTUB_ENSURE(bro != nullptr, "FetchPage bro nullptr!");
+    buffer_pool_manager_->UnpinPage(parent_page_id, false);
+    if (!bro->TryWLatch()) {
+      buffer_pool_manager_->UnpinPage(bro->GetPageId(), false);
+      for (Page *bro_page : *brothers) {
+        bro_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(bro_page->GetPageId(), false);
       }
-      buffer_pool_manager_->UnpinPage(bpt_page->GetParentPageId(), true);
-      buffer_pool_manager_->UnpinPage(bro_page_id_right, true);
-      buffer_pool_manager_->UnpinPage(bpt_page->GetPageId(), true);
+      brothers->clear();
+      return false;
     }
-    return;
+    brothers->push_back(bro);
+    auto bro_page = reinterpret_cast<BPlusTreePage *>(bro->GetData());
+    int max_size = bpt_page->IsLeafPage() ? leaf_max_size_ - 1 : internal_max_size_;
+    if (bro_page->GetSize() + bpt_page->GetSize() - 1 > max_size) {
+      break;
+    }
+    bpt_page = parent_page;
   }
-  if (bpt_page->IsLeafPage() && bpt_page->GetSize() - 1 < (leaf_max_size_ - 1) / 2) {
-    LOG_INFO("# [bpt RemoveEntry] node is leaf & has few pointers");
-    page_id_t bro_page_id_left;
-    page_id_t bro_page_id_right;
-    int parent_key_index = -1;
-    Page *page = buffer_pool_manager_->FetchPage(bpt_page->GetParentPageId());
-    BUSTUB_ENSURE(page != nullptr, "FetchPage page nullptr!");
-    auto parent_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
-    auto bpt_leaf_page = reinterpret_cast<LeafPage *>(bpt_page);
+  return true;
+}
 
-    FindBrotherPage(parent_page, bpt_page->GetPageId(), &parent_key_index, &bro_page_id_left, &bro_page_id_right);
-    bpt_leaf_page->DeleteKey(key, comparator_);
-
-    if (bro_page_id_left != INVALID_PAGE_ID) {
-      Page *left = buffer_pool_manager_->FetchPage(bro_page_id_left);
-      BUSTUB_ENSURE(left != nullptr, "FetchPage left nullptr!");
-      auto left_page = reinterpret_cast<BPlusTreePage *>(left->GetData());
-      auto parent_internal_page = reinterpret_cast<LeafPage *>(parent_page);
-
-      if (left_page->GetSize() + bpt_leaf_page->GetSize() < leaf_max_size_) {
-        CoalesceNodes(bpt_leaf_page, left_page, true, parent_internal_page->KeyAt(parent_key_index));
-        RemoveEntry(parent_internal_page, parent_internal_page->KeyAt(parent_key_index));
-        buffer_pool_manager_->DeletePage(bpt_leaf_page->GetPageId());
-      } else {
-        KeyType end_key =
-            Redistribution(bpt_leaf_page, left_page, false, parent_internal_page->KeyAt(parent_key_index));
-        parent_internal_page->SetKeyAt(parent_key_index, end_key);
-        buffer_pool_manager_->UnpinPage(bpt_page->GetPageId(), true);
-      }
-      buffer_pool_manager_->UnpinPage(bpt_page->GetParentPageId(), true);
-      buffer_pool_manager_->UnpinPage(bro_page_id_left, true);
-    } else {
-      Page *right = buffer_pool_manager_->FetchPage(bro_page_id_right);
-      BUSTUB_ENSURE(right != nullptr, "FetchPage right nullptr!");
-      auto right_page = reinterpret_cast<BPlusTreePage *>(right->GetData());
-      auto parent_internal_page = reinterpret_cast<LeafPage *>(parent_page);
-      if (right_page->GetSize() + bpt_leaf_page->GetSize() < leaf_max_size_) {
-        CoalesceNodes(bpt_leaf_page, right_page, false, parent_internal_page->KeyAt(parent_key_index));
-        RemoveEntry(parent_internal_page, parent_internal_page->KeyAt(parent_key_index));
-        buffer_pool_manager_->DeletePage(bpt_leaf_page->GetPageId());
-      } else {
-        KeyType first_key =
-            Redistribution(bpt_leaf_page, right_page, true, parent_internal_page->KeyAt(parent_key_index));
-        parent_internal_page->SetKeyAt(parent_key_index, first_key);
-        buffer_pool_manager_->UnpinPage(bpt_page->GetPageId(), true);
-      }
-      buffer_pool_manager_->UnpinPage(bpt_page->GetParentPageId(), true);
-      buffer_pool_manager_->UnpinPage(bro_page_id_right, true);
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveEntry(BPlusTreePage *bpt_page, const KeyType &key, std::deque<Page *> *brothers,
+                                 std::vector<page_id_t> *deleted_pages) {
+  // The page and the ancestors it may change are pinned and write latched by Remove(), the brothers by LatchBrothers().
+  if (bpt_page->IsLeafPage()) {
+    reinterpret_cast<LeafPage *>(bpt_page)->DeleteKey(key, comparator_);
+  } else {
+    reinterpret_cast<InternalPage *>(bpt_page)->DeleteKey(key, comparator_);
+  }
+
+  if (bpt_page->IsRootPage()) {
+    if (!bpt_page->IsLeafPage() && bpt_page->GetSize() == 1) {
+      root_page_id_ = reinterpret_cast<InternalPage *>(bpt_page)->ValueAt(0);
+      SetParentOf(root_page_id_, INVALID_PAGE_ID);
+      UpdateRootPageId(0);
+      deleted_pages->push_back(bpt_page->GetPageId());
     }
     return;
   }
+  if (bpt_page->GetSize() >= MinSize(bpt_page)) {
+    return;
+  }
+
+  page_id_t parent_page_id = bpt_page->GetParentPageId();
+  Page *page = buffer_pool_manager_->FetchPage(parent_page_id);
+  BUSTUB_ENSURE(page != nullptr, "FetchPage page nullptr!");
+  auto parent_page = reinterpret_cast<InternalPage *>(page->GetData());
+  page_id_t bro_page_id_left;
+  page_id_t bro_page_id_right;
+  int parent_key_index = -1;
+  FindBrotherPage(parent_page, bpt_page->GetPageId(), &parent_key_index, &bro_page_id_left, &bro_page_id_right);
+
+  bool is_predecessor = bro_page_id_left != INVALID_PAGE_ID;
+  page_id_t bro_page_id = is_predecessor ? bro_page_id_left : bro_page_id_right;
+  BUSTUB_ASSERT(!brothers->empty() && brothers->front()->GetPageId() == bro_page_id, "brother not latched");
+  Page *bro = brothers->front();
+  brothers->pop_front();
+  auto bro_page = reinterpret_cast<BPlusTreePage *>(bro->GetData());
+  KeyType parent_key = parent_page->KeyAt(parent_key_index);
+  int max_size = bpt_page->IsLeafPage() ? leaf_max_size_ - 1 : internal_max_size_;
+
+  if (bro_page->GetSize() + bpt_page->GetSize() <= max_size) {
+    CoalesceNodes(bpt_page, bro_page, is_predecessor, parent_key);
+    deleted_pages->push_back(is_predecessor ? bpt_page->GetPageId() : bro_page_id);
+    bro->WUnlatch();
+    buffer_pool_manager_->UnpinPage(bro_page_id, true);
+    RemoveEntry(parent_page, parent_key, brothers, deleted_pages);
+  } else {
+    parent_page->SetKeyAt(parent_key_index, Redistribution(bpt_page, bro_page, is_predecessor, parent_key));
+    bro->WUnlatch();
+    buffer_pool_manager_->UnpinPage(bro_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
 }
 
-// to do redistribution and return the end_key in bro so to replace the k' in parent node
+// move one entry of the brother to the page, and return the key that separates them afterwards
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Redistribution(BPlusTreePage *bpt_page, BPlusTreePage *bro_page, bool is_predecessor,
                                     const KeyType &key) -> KeyType {
-  KeyType move_key;
-  if (!is_predecessor) {
-    if (!bpt_page->IsLeafPage()) {
-      auto bro_internal_page = reinterpret_cast<InternalPage *>(bro_page);
-      auto bpt_internal_page = reinterpret_cast<InternalPage *>(bpt_page);
-      move_key = bro_internal_page->KeyAt(bro_internal_page->GetSize());
-      bpt_internal_page->InsertAtFirst(key, bro_internal_page->ValueAt(bro_internal_page->GetSize()));
-      bro_internal_page->DeleteEndValue();
-    } else {
-      auto bro_internal_page = reinterpret_cast<LeafPage *>(bro_page);
-      auto bpt_internal_page = reinterpret_cast<LeafPage *>(bpt_page);
-      move_key = bro_internal_page->KeyAt(bro_internal_page->GetSize());
-      bpt_internal_page->InsertAtFirst(key, bro_internal_page->ValueAt(bro_internal_page->GetSize()));
-      bro_internal_page->DeleteEndValue();
-    }
-  } else {
-    if (!bpt_page->IsLeafPage()) {
-      auto bro_internal_page = reinterpret_cast<InternalPage *>(bro_page);
-      auto bpt_internal_page = reinterpret_cast<InternalPage *>(bpt_page);
-      move_key = bro_internal_page->KeyAt(1);
-      bpt_internal_page->InsertAtEnd(key, bro_internal_page->ValueAt(0));
-      bro_internal_page->DeleteFirstValue();
-    } else {
-      auto bro_internal_page = reinterpret_cast<LeafPage *>(bro_page);
-      auto bpt_internal_page = reinterpret_cast<LeafPage *>(bpt_page);
-      move_key = bro_internal_page->KeyAt(1);
-      bpt_internal_page->InsertAtEnd(key, bro_internal_page->ValueAt(0));
-      bro_internal_page->DeleteFirstValue();
+  if (bpt_page->IsLeafPage()) {
+    auto bpt_leaf_page = reinterpret_cast<LeafPage *>(bpt_page);
+    auto bro_leaf_page = reinterpret_cast<LeafPage *>(bro_page);
+    if (is_predecessor) {
+      int last = bro_leaf_page->GetSize() - 1;
+      bpt_leaf_page->InsertAtFirst(bro_leaf_page->KeyAt(last), bro_leaf_page->ValueAt(last));
+      bro_leaf_page->DeleteEndValue();
+      return bpt_leaf_page->KeyAt(0);
     }
+    bpt_leaf_page->InsertAtEnd(bro_leaf_page->KeyAt(0), bro_leaf_page->ValueAt(0));
+    bro_leaf_page->DeleteFirstValue();
+    return bro_leaf_page->KeyAt(0);
   }
 
+  // the key of the parent moves down with the child, the key of the child moves up
+  auto bpt_internal_page = reinterpret_cast<InternalPage *>(bpt_page);
+  auto bro_internal_page = reinterpret_cast<InternalPage *>(bro_page);
+  KeyType move_key;
+  page_id_t child_page_id;
+  if (is_predecessor) {
+    int last = bro_internal_page->GetSize() - 1;
+    move_key = bro_internal_page->KeyAt(last);
+    child_page_id = bro_internal_page->ValueAt(last);
+    bpt_internal_page->InsertAtFirst(key, child_page_id);
+    bro_internal_page->DeleteEndValue();
+  } else {
+    move_key = bro_internal_page->KeyAt(1);
+    child_page_id = bro_internal_page->ValueAt(0);
+    bpt_internal_page->InsertAtEnd(key, child_page_id);
+    bro_internal_page->DeleteFirstValue();
+  }
+  SetParentOf(child_page_id, bpt_internal_page->GetPageId());
   return move_key;
 }
 
+// move all the entries of the right page of the two to the left one
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::CoalesceNodes(BPlusTreePage *bpt_page, BPlusTreePage *bro_page, bool is_predecessor,
                                    const KeyType &key) {
-  if (is_predecessor) {
-    std::swap(bpt_page, bro_page);
-  }
-  if (!bpt_page->IsLeafPage()) {
-    auto bpt_internal_page = reinterpret_cast<InternalPage *>(bpt_page);
-    auto bro_internal_page = reinterpret_cast<InternalPage *>(bro_page);
-    int n = bro_internal_page->GetSize();
-    bro_internal_page->SetKeyAt(++n, key);
-    bro_internal_page->SetValueAt(n, bpt_internal_page->ValueAt(0));
-    for (int i = 1; i < bpt_internal_page->GetSize() + 1; i++) {
-      bro_internal_page->SetKeyAt(i + n, bpt_internal_page->KeyAt(i));
-      bro_internal_page->SetValueAt(i + n, bpt_internal_page->ValueAt(i));
-      bro_internal_page->SetSize(bpt_internal_page->GetSize());
-      n++;
-    }
-  } else {
-    auto bpt_leaf_page = reinterpret_cast<InternalPage *>(bpt_page);
-    auto bro_leaf_page = reinterpret_cast<InternalPage *>(bro_page);
-    int n = bro_leaf_page->GetSize();
-    for (int i = 1; i < bpt_leaf_page->GetSize() + 1; i++) {
-      bro_leaf_page->SetKeyAt(i + n, bpt_leaf_page->KeyAt(i));
-      bro_leaf_page->SetValueAt(i + n, bpt_leaf_page->ValueAt(i));
-      bro_leaf_page->SetSize(bpt_leaf_page->GetSize());
-      n++;
+  auto left_page = is_predecessor ? bro_page : bpt_page;
+  auto right_page = is_predecessor ? bpt_page : bro_page;
+  if (left_page->IsLeafPage()) {
+    auto left_leaf_page = reinterpret_cast<LeafPage *>(left_page);
+    auto right_leaf_page = reinterpret_cast<LeafPage *>(right_page);
+    for (int i = 0; i < right_leaf_page->GetSize(); i++) {
+      left_leaf_page->InsertAtEnd(right_leaf_page->KeyAt(i), right_leaf_page->ValueAt(i));
     }
+    left_leaf_page->SetNextPageId(right_leaf_page->GetNextPageId());
+    right_leaf_page->EraseAll();
+    return;
   }
+
+  // the key of the parent separates the first child of the right page from the last one of the left page
+  auto left_internal_page = reinterpret_cast<InternalPage *>(left_page);
+  auto right_internal_page = reinterpret_cast<InternalPage *>(right_page);
+  for (int i = 0; i < right_internal_page->GetSize(); i++) {
+    left_internal_page->InsertAtEnd(i == 0 ? key : right_internal_page->KeyAt(i), right_internal_page->ValueAt(i));
+    SetParentOf(right_internal_page->ValueAt(i), left_internal_page->GetPageId());
+  }
+  right_internal_page->EraseAll();
 }
 /*****************************************************************************
  * INDEX ITERATOR
@@ -556,17 +625,12 @@ void BPLUSTREE_TYPE::CoalesceNodes(BPlusTreePage *bpt_page, BPlusTreePage *bro_p
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
-  page_id_t next_page_id = root_page_id_;
-
-  while (true) {
-    Page *page = buffer_pool_manager_->FetchPage(next_page_id);
-    auto current_page = reinterpret_cast<InternalPage *>(page);
-    if (current_page->IsLeafPage()) {
-      return INDEXITERATOR_TYPE(next_page_id, 0, buffer_pool_manager_);
-    }
-
-    next_page_id = current_page->ValueAt(0);
+  Page *page = LatchLeaf(KeyType{}, Operation::FIND, true);
+  if (page == nullptr) {
+    return End();
   }
+  // the iterator takes over the pin and the read latch of the leaf
+  return INDEXITERATOR_TYPE(page, 0, buffer_pool_manager_);
 }
 
 /*
@@ -576,9 +640,11 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
-  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
-  auto bpt_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
-  auto leaf_page = reinterpret_cast<LeafPage *>(FindLeaf(bpt_page, key, comparator_));
+  Page *page = LatchLeaf(key, Operation::FIND);
+  if (page == nullptr) {
+    return End();
+  }
+  auto leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
   int low = 0;
   int high = leaf_page->GetSize();
   int mid = 0;
@@ -590,7 +656,7 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
       high = mid;
     }
   }
-  return INDEXITERATOR_TYPE(leaf_page->GetPageId(), low, buffer_pool_manager_);
+  return INDEXITERATOR_TYPE(page, low, buffer_pool_manager_);
 }
 
 /*
@@ -600,7 +666,7 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
-  return INDEXITERATOR_TYPE(INVALID_PAGE_ID, -1, buffer_pool_manager_);
+  return INDEXITERATOR_TYPE(nullptr, -1, buffer_pool_manager_);
 }
 
 /**
@@ -623,6 +689,8 @@ auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return root_page_id_; }
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
   auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  // the header page is shared by all the indexes
+  header_page->WLatch();
   if (insert_record != 0) {
     // create a new record<index_name + root_page_id> in header_page
     header_page->InsertRecord(index_name_, root_page_id_);
@@ -630,6 +698,7 @@ void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
+  header_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
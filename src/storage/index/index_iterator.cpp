@@ -12,16 +12,30 @@ namespace bustub {
  * set your own input parameters
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(page_id_t leaf_page_id, int index, BufferPoolManager *buffer_pool_manager) {
-  leaf_page_id_ = leaf_page_id;
-  Page *page = buffer_pool_manager->FetchPage(leaf_page_id);
-  leaf_page_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
+INDEXITERATOR_TYPE::IndexIterator(Page *leaf_page, int index, BufferPoolManager *buffer_pool_manager)
+    : read_ahead_(buffer_pool_manager) {
+  page_ = leaf_page;
+  leaf_page_id_ = INVALID_PAGE_ID;
+  leaf_page_ = nullptr;
   index_ = index;
   buffer_pool_manager_ = buffer_pool_manager;
+  if (page_ != nullptr) {
+    leaf_page_id_ = page_->GetPageId();
+    leaf_page_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_->GetData());
+    read_ahead_.OnPageAccess(leaf_page_id_);
+    if (index_ >= leaf_page_->GetSize()) {
+      NextLeaf();
+    }
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() { buffer_pool_manager_->UnpinPage(leaf_page_id_, false); }
+INDEXITERATOR_TYPE::~IndexIterator() {  // NOLINT
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(leaf_page_id_, false);
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::IsEnd() -> bool { return leaf_page_id_ == INVALID_PAGE_ID; }
@@ -35,16 +49,40 @@ auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
     index_++;
     return *this;
   }
-  buffer_pool_manager_->UnpinPage(leaf_page_id_, false);
-  leaf_page_id_ = leaf_page_->GetNextPageId();
-  if (leaf_page_id_ != INVALID_PAGE_ID) {
-    Page *page = buffer_pool_manager_->FetchPage(leaf_page_id_);
-    leaf_page_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
-  }
-  index_ = -1;
+  NextLeaf();
   return *this;
 }
 
+/*
+ * Latch crabbing along the leaves, from left to right like the writers do. A writer that would have to latch this
+ * leaf while holding the next one only tries to, and starts over if it can't.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::NextLeaf() {
+  do {
+    page_id_t next_page_id = leaf_page_->GetNextPageId();
+    Page *next_page = nullptr;
+    if (next_page_id != INVALID_PAGE_ID) {
+      // Leaves split off to the right get the next page ids, so a scan over a bulk-loaded tree is mostly sequential.
+      read_ahead_.OnPageAccess(next_page_id);
+      next_page = buffer_pool_manager_->FetchPage(next_page_id);
+      BUSTUB_ENSURE(next_page != nullptr, "FetchPage next_page nullptr!");
+      next_page->RLatch();
+    }
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(leaf_page_id_, false);
+    page_ = next_page;
+    leaf_page_id_ = next_page_id;
+    if (page_ == nullptr) {
+      leaf_page_ = nullptr;
+      index_ = -1;
+      return;
+    }
+    leaf_page_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_->GetData());
+    index_ = 0;
+  } while (leaf_page_->GetSize() == 0);
+}
+
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
 template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
@@ -60,12 +60,13 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KVInsert(int index, const KeyType &key, con
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertAtFirst(const KeyType &key, const ValueType &value) -> void {
-  for (int i = GetSize(); i > 1; i--) {
+  // value becomes the first child, key separates it from the old first child
+  for (int i = GetSize(); i > 0; i--) {
     array_[i] = array_[i - 1];
   }
 
   SetKeyAt(1, key);
-  SetValueAt(1, value);
+  SetValueAt(0, value);
 
   IncreaseSize(1);
 }
@@ -92,14 +93,13 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::InternalInsert(const KeyType &key, const Va
     if (cmp(array_[mid].first, key) < 0) {
       low = mid + 1;
     } else {
-      high = mid - 1;
+      high = mid;
     }
   }
 
   for (; i > low; i--) {
     array_[i] = array_[i - 1];
   }
-  LOG_INFO("# [bpt InternalInsert] now got key:%ld at index:%d", key.ToString(), low);
   array_[low].first = key;
   array_[low].second = value;
   IncreaseSize(1);
@@ -119,20 +119,19 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &valu
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::FindSmallestBiggerKV(const KeyType &key, const KeyComparator &cmp) const -> int {
+  // the child of key is the last one whose key is not bigger than key, or the first one
   int low = 1;
   int high = GetSize();
-  if (cmp(KeyAt(1), key) > 0) {
-    return 0;
-  }
+  int mid = 0;
   while (low < high) {
-    if (cmp(KeyAt(low), key) < 0) {
-      LOG_INFO("# [bpt FindSmall] now low is %d, which is smaller than key:%ld", low, key.ToString());
-      low++;
+    mid = low + (high - low) / 2;
+    if (cmp(KeyAt(mid), key) <= 0) {
+      low = mid + 1;
     } else {
-      return low;
+      high = mid;
     }
   }
-  return GetSize() - 1;
+  return low - 1;
 }
 
 // INDEX_TEMPLATE_ARGUMENTS
@@ -146,10 +145,9 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::DeleteEndValue() -> void { IncreaseSize(-1)
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::DeleteFirstValue() -> void {
+  // the second child becomes the first one, its key is no longer used
   int n = GetSize();
-  SetValueAt(1, array_[0].second);
-  // array_[0].second = array_[1].second;
-  for (int i = 1; i < n; i++) {
+  for (int i = 0; i < n - 1; i++) {
     array_[i] = array_[i + 1];
   }
 
@@ -168,12 +166,14 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::DeleteKey(const KeyType &key, const KeyComp
     if (cmp(array_[mid].first, key) < 0) {
       low = mid + 1;
     } else {
-      high = mid - 1;
+      high = mid;
     }
   }
+  if (low == i || cmp(array_[low].first, key) != 0) {
+    return;
+  }
 
-  LOG_INFO("# [bpt DeleteKey] now key:%ld at index:%d deleted", key.ToString(), low);
-  for (; low < i; low++) {
+  for (; low < i - 1; low++) {
     array_[low] = array_[low + 1];
   }
 
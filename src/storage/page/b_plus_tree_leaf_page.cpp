@@ -70,7 +70,7 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::CopyHalfTo(BPlusTreeLeafPage *leaf_page) -> voi
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::CopyHalfFrom(MappingType *item, const int &size) -> void {
-  std::copy(item, item + size + 1, array_);
+  std::copy(item, item + size, array_);
   SetSize(size);
 }
 
@@ -116,14 +116,13 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::LeafInsert(const KeyType &key, const ValueType
     if (cmp(array_[mid].first, key) < 0) {
       low = mid + 1;
     } else {
-      high = mid - 1;
+      high = mid;
     }
   }
 
   for (; i > low; i--) {
     array_[i] = array_[i - 1];
   }
-  LOG_INFO("# [bpt LeafInsert] now got key:%ld at index:%d", key.ToString(), low);
   array_[low].first = key;
   array_[low].second = value;
   IncreaseSize(1);
@@ -143,8 +142,10 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::DeleteKey(const KeyType &key, const KeyComparat
       high = mid;
     }
   }
-  LOG_INFO("# [bpt DeleteKey] now key:%ld at index:%d deleted", key.ToString(), low);
-  for (; low < GetSize(); low++) {
+  if (low == GetSize() || cmp(array_[low].first, key) != 0) {
+    return;
+  }
+  for (; low < GetSize() - 1; low++) {
     array_[low] = array_[low + 1];
   }
 
@@ -167,12 +168,11 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::FindKey(const KeyType &key, ValueType *value, c
       high = mid;
     }
   }
-  if (cmp(array_[low].first, key) == 0) {
-    LOG_INFO("# [bpt FindKey] find key:%ld at index:%d", key.ToString(), low);
+  // the slot past the last entry may still hold a deleted one
+  if (low < GetSize() && cmp(array_[low].first, key) == 0) {
     *value = array_[low].second;
     return true;
   }
-  LOG_INFO("# [bpt FindKey] can't find key:%ld", key.ToString());
   return false;
 }
 
@@ -186,7 +186,7 @@ INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::DeleteFirstValue() -> void {
   int n = GetSize();
 
-  for (int i = 0; i < n; i++) {
+  for (int i = 0; i < n - 1; i++) {
     array_[i] = array_[i + 1];
   }
 
@@ -12,12 +12,35 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
 #include <random>
+#include <set>
 #include <string>
+#include <thread>  // NOLINT
+#include <tuple>
+#include <vector>
 
+#include "buffer/access_trace.h"
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/hot_page_file.h"
+#include "buffer/page_extent.h"
+#include "buffer/trace_replayer.h"
+#include "catalog/schema.h"
+#include "concurrency/transaction.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/free_page_map.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -145,4 +168,1029 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentMissTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 32;
+  const size_t num_threads = 8;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: create more pages than fit in the pool, so that fetching them later misses and evicts dirty pages.
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: threads fetch the same pages concurrently, every other fetch incrementing a counter of the page. Every
+  // fetch must see the latest counter, even when the page was just being written back or read in by another thread, so
+  // that no update is lost. Each thread pins one page at a time, which always fits in the pool.
+  const size_t counter_offset = 64;
+  std::vector<std::atomic<uint64_t>> counters(num_pages);
+  std::atomic<int> failed_fetches{0};
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid]() {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+      for (int i = 0; i < 500; i++) {
+        auto page_id = dist(gen);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          failed_fetches++;
+          continue;
+        }
+        bool is_write = i % 2 == 0;
+        if (is_write) {
+          page->WLatch();
+        } else {
+          page->RLatch();
+        }
+        EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+        uint64_t counter;
+        memcpy(&counter, page->GetData() + counter_offset, sizeof(counter));
+        EXPECT_EQ(counters[page_id].load(), counter);
+        if (is_write) {
+          counter++;
+          memcpy(page->GetData() + counter_offset, &counter, sizeof(counter));
+          counters[page_id] = counter;
+          page->WUnlatch();
+        } else {
+          page->RUnlatch();
+        }
+        bpm->UnpinPage(page_id, is_write);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, failed_fetches);
+
+  for (size_t i = 0; i < num_pages; i++) {
+    auto page_id = static_cast<page_id_t>(i);
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    uint64_t counter;
+    memcpy(&counter, page->GetData() + counter_offset, sizeof(counter));
+    EXPECT_EQ(counters[page_id].load(), counter);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BackgroundFlusherTest) {
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: fill the pool with dirty, unpinned pages.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: the flusher writes all of them back in the background, keeping the whole pool clean.
+  bpm->StartBackgroundFlusher(1.0, 100000);
+  for (int i = 0; i < 500 && bpm->GetBackgroundWriteCount() < buffer_pool_size; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  bpm->StopBackgroundFlusher();
+  EXPECT_EQ(buffer_pool_size, bpm->GetBackgroundWriteCount());
+
+  // Scenario: evicting them does not need any synchronous write, and their contents survive.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, bpm->GetSyncWriteBackCount());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const size_t buffer_pool_size = 8;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: create twice as many pages as fit in the pool, so that pages 0..7 end up on disk only.
+  for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: pages that were never allocated are ignored, and the queue holds at most a quarter of the pool.
+  bpm->PrefetchPage(100);
+  bpm->PrefetchRange(0, buffer_pool_size);
+  for (int i = 0; i < 500 && bpm->GetPrefetchCount() < buffer_pool_size / 4; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(buffer_pool_size / 4, bpm->GetPrefetchCount());
+
+  // Scenario: prefetched pages hold the right contents and are not left pinned.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size / 4); page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerInstanceTest, FrameArenaTest) {
+  const size_t k = 5;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+
+  // Scenario: frame data is contiguous and page-aligned, and the metadata of every page has its own cache lines.
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager, k);
+  auto *pages = bpm->GetPages();
+  EXPECT_EQ(0, sizeof(Page) % CACHE_LINE_SIZE);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(pages) % CACHE_LINE_SIZE);
+  EXPECT_FALSE(bpm->GetFrameArena()->UsesHugePages());
+  for (size_t i = 0; i < bpm->GetPoolSize(); i++) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(pages[i].GetData()) % BUSTUB_PAGE_SIZE);
+    EXPECT_EQ(pages[0].GetData() + i * BUSTUB_PAGE_SIZE, pages[i].GetData());
+  }
+
+  // Scenario: new pages start out zeroed, even in recycled frames.
+  page_id_t page_id;
+  for (size_t i = 0; i < 2 * bpm->GetPoolSize(); i++) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, '\0'), std::string(page->GetData(), BUSTUB_PAGE_SIZE));
+    memset(page->GetData(), 'x', BUSTUB_PAGE_SIZE);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  delete bpm;
+
+  // Scenario: an arena of at least one huge page is aligned to huge pages.
+  bpm = new BufferPoolManagerInstance(2 * HUGE_PAGE_SIZE / BUSTUB_PAGE_SIZE, disk_manager, k);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(bpm->GetPages()[0].GetData()) % HUGE_PAGE_SIZE);
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerInstanceTest, ReplacerPolicyTest) {
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_pages = 30;
+  for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::CLOCK, ReplacerPolicy::LRU_K, ReplacerPolicy::ARC,
+                      ReplacerPolicy::TWO_QUEUE, ReplacerPolicy::CLOCK_PRO}) {
+    SCOPED_TRACE(fmt::format("{}", policy));
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, LRUK_REPLACER_K, nullptr, policy);
+
+    page_id_t page_id;
+    for (page_id_t i = 0; i < num_pages; i++) {
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+      ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+
+    // Scenario: whatever the policy evicts, pages come back with their data.
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+    for (size_t i = 0; i < 200; i++) {
+      page_id = dist(gen);
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      ASSERT_EQ(fmt::format("page {}", page_id), std::string(page->GetData()));
+      ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+
+    // Scenario: pinned pages are never evicted.
+    for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+    }
+    ASSERT_EQ(nullptr, bpm->FetchPage(num_pages - 1));
+    ASSERT_EQ(nullptr, bpm->NewPage(&page_id));
+    for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+      ASSERT_TRUE(bpm->UnpinPage(i, false));
+    }
+    ASSERT_NE(nullptr, bpm->FetchPage(num_pages - 1));
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+TEST(BufferPoolManagerInstanceTest, AccessTraceTest) {
+  const std::string trace_name = "test.trace";
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(2, disk_manager);
+  auto trace = std::make_shared<AccessTraceWriter>(trace_name);
+
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  bpm->StartAccessTrace(trace);
+  ASSERT_TRUE(bpm->UnpinPage(0, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  ASSERT_TRUE(bpm->UnpinPage(1, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  ASSERT_TRUE(bpm->UnpinPage(2, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(2));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  ASSERT_TRUE(bpm->UnpinPage(0, false));
+  ASSERT_TRUE(bpm->DeletePage(0));
+  bpm->StopAccessTrace();
+  // Scenario: calls after the trace was stopped are not recorded.
+  ASSERT_TRUE(bpm->UnpinPage(2, false));
+  trace->Close();
+  ASSERT_EQ(9, trace->GetNumRecords());
+
+  // Scenario: the trace reads back in order, with page ids, flags and a single thread.
+  std::vector<std::tuple<AccessType, page_id_t, uint8_t>> expected = {
+      {AccessType::UNPIN, 0, ACCESS_TRACE_DIRTY}, {AccessType::NEW, 1, 0},
+      {AccessType::UNPIN, 1, 0},                  {AccessType::NEW, 2, 0},
+      {AccessType::UNPIN, 2, 0},                  {AccessType::FETCH, 2, ACCESS_TRACE_HIT},
+      {AccessType::FETCH, 0, 0},                  {AccessType::UNPIN, 0, 0},
+  };
+  AccessTraceReader reader(trace_name);
+  AccessTraceRecord record;
+  uint64_t last_timestamp = 0;
+  for (const auto &[type, expected_page_id, flags] : expected) {
+    ASSERT_TRUE(reader.Next(&record));
+    EXPECT_EQ(type, record.type_);
+    EXPECT_EQ(expected_page_id, record.page_id_);
+    EXPECT_EQ(flags, record.flags_);
+    EXPECT_GE(record.timestamp_ns_, last_timestamp);
+    last_timestamp = record.timestamp_ns_;
+  }
+  ASSERT_TRUE(reader.Next(&record));
+  EXPECT_EQ(AccessType::DELETE, record.type_);
+  ASSERT_FALSE(reader.Next(&record));
+
+  // Scenario: the trace replays against a replacer. Page 2 is the only access that finds its page in the pool.
+  AccessTraceReader replay_reader(trace_name);
+  TraceReplayer replayer(ReplacerPolicy::LRU, 2);
+  while (replay_reader.Next(&record)) {
+    replayer.Replay(record);
+  }
+  EXPECT_EQ(4, replayer.GetStats().accesses_);
+  EXPECT_EQ(1, replayer.GetStats().hits_);
+
+  delete bpm;
+  delete disk_manager;
+  remove(trace_name.c_str());
+}
+
+TEST(BufferPoolManagerInstanceTest, ResizeTest) {
+  const size_t k = 5;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager, k);
+
+  // Scenario: growing a full pool makes room for more pages.
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id;
+  for (int i = 0; i < 10; i++) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    page_ids.push_back(page_id);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_TRUE(bpm->Resize(20));
+  EXPECT_EQ(20, bpm->GetPoolSize());
+  for (int i = 0; i < 10; i++) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    page_ids.push_back(page_id);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_FALSE(bpm->Resize(0));
+  EXPECT_FALSE(bpm->Resize(bpm->GetMaxPoolSize() + 1));
+
+  // Scenario: shrinking writes back the dirty pages it drops, and waits for the pinned frames it retires.
+  for (auto id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(id, true));
+  }
+  auto *pinned_page = bpm->GetPages() + 15;
+  auto pinned_page_id = pinned_page->GetPageId();
+  ASSERT_EQ(pinned_page, bpm->FetchPage(pinned_page_id));
+
+  std::atomic<bool> resized{false};
+  std::thread resizer([&] {
+    EXPECT_TRUE(bpm->Resize(5));
+    resized = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(resized);
+  EXPECT_TRUE(bpm->UnpinPage(pinned_page_id, false));
+  resizer.join();
+  EXPECT_EQ(5, bpm->GetPoolSize());
+
+  // Every page can still be fetched, with the contents written before the shrink.
+  for (auto id : page_ids) {
+    auto *page = bpm->FetchPage(id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(id)).c_str()));
+    EXPECT_LT(page - bpm->GetPages(), 5);
+    EXPECT_TRUE(bpm->UnpinPage(id, false));
+  }
+
+  // Scenario: frames that come back after a shrink start out empty.
+  EXPECT_TRUE(bpm->Resize(10));
+  for (int i = 0; i < 10; i++) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, '\0'), std::string(page->GetData(), BUSTUB_PAGE_SIZE));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerInstanceTest, ConcurrentResizeTest) {
+  const size_t k = 2;
+  const int num_pages = 64;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(16, disk_manager, k);
+
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; i++) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: pages read while the pool grows and shrinks underneath are always intact.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; tid++) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+      while (!done) {
+        auto id = dist(gen);
+        auto *page = bpm->FetchPage(id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(id)).c_str()));
+        EXPECT_TRUE(bpm->UnpinPage(id, tid % 2 == 0));
+      }
+    });
+  }
+  for (size_t round = 0; round < 50; round++) {
+    EXPECT_TRUE(bpm->Resize(round % 2 == 0 ? 8 : 32));
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** An in-memory disk manager that counts the reads of pages at or above `watched_page_id`. */
+class ReadCountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  explicit ReadCountingDiskManager(page_id_t watched_page_id) : watched_page_id_(watched_page_id) {}
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    if (page_id >= watched_page_id_) {
+      watched_reads_++;
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  auto GetWatchedReads() const -> size_t { return watched_reads_; }
+
+  /** Count the reads of the pages from watched_page_id on. Call this before any thread reads pages. */
+  void Watch(page_id_t watched_page_id) { watched_page_id_ = watched_page_id; }
+
+ private:
+  page_id_t watched_page_id_;
+  std::atomic<size_t> watched_reads_{0};
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, AccessStrategyTest) {
+  const size_t buffer_pool_size = 16;
+  const page_id_t num_cold_pages = 100;
+  const page_id_t num_hot_pages = 8;
+
+  auto *disk_manager = new ReadCountingDiskManager(num_cold_pages);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: a large cold table is followed by a small hot working set, accessed a few times each.
+  for (page_id_t i = 0; i < num_cold_pages + num_hot_pages; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (int round = 0; round < 3; round++) {
+    for (page_id_t page_id = num_cold_pages; page_id < num_cold_pages + num_hot_pages; page_id++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+
+  // Scenario: scanning the cold table through a ring of 4 frames recycles those frames over and over.
+  BufferAccessStrategy strategy(4);
+  for (page_id_t page_id = 0; page_id < num_cold_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id, strategy);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, page->GetPageId());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_LT(0, strategy.GetReusedCount());
+
+  // Scenario: the hot working set was never evicted.
+  for (page_id_t page_id = num_cold_pages; page_id < num_cold_pages + num_hot_pages; page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, disk_manager->GetWatchedReads());
+
+  // Scenario: a ring frame that is pinned is not recycled.
+  auto *pinned = bpm->FetchPage(0, strategy);
+  ASSERT_NE(nullptr, pinned);
+  for (page_id_t page_id = 1; page_id < 8; page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id, strategy));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, pinned->GetPageId());
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** An in-memory disk manager that counts the batched reads and the pages read by them. */
+class BatchCountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override {
+    batches_.push_back(page_ids);
+    DiskManagerUnlimitedMemory::ReadPages(page_ids, pages_data);
+  }
+
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override {
+    write_batches_.push_back(page_ids);
+    DiskManagerUnlimitedMemory::WritePages(page_ids, pages_data);
+  }
+
+  auto GetBatches() const -> const std::vector<std::vector<page_id_t>> & { return batches_; }
+
+  auto GetWriteBatches() const -> const std::vector<std::vector<page_id_t>> & { return write_batches_; }
+
+ private:
+  std::vector<std::vector<page_id_t>> batches_;
+  std::vector<std::vector<page_id_t>> write_batches_;
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BatchFetchTest) {
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_pages = 20;
+
+  auto *disk_manager = new BatchCountingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (page_id_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: pages 10-19 are resident, pages 0-9 were evicted. The misses are read with a single sorted request, and
+  // the pages come back in the order they were asked for, duplicates included.
+  std::vector<page_id_t> page_ids{15, 3, 3, 1, 12};
+  auto pages = bpm->FetchPages(page_ids);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ(fmt::format("page {}", page_ids[i]), std::string(pages[i]->GetData()));
+  }
+  ASSERT_EQ(1, disk_manager->GetBatches().size());
+  EXPECT_EQ((std::vector<page_id_t>{1, 3}), disk_manager->GetBatches()[0]);
+  EXPECT_EQ(2, pages[1]->GetPinCount());
+  EXPECT_EQ(1, pages[0]->GetPinCount());
+
+  // Scenario: a page listed twice is unpinned twice. Unpinning pages that are not pinned anymore fails.
+  EXPECT_TRUE(bpm->UnpinPages(page_ids, false));
+  EXPECT_EQ(0, pages[1]->GetPinCount());
+  EXPECT_FALSE(bpm->UnpinPages({15, 1}, false));
+
+  // Scenario: a batch that needs more frames than the pool has fails and leaves nothing pinned.
+  std::vector<page_id_t> too_many;
+  for (page_id_t i = 0; i <= static_cast<page_id_t>(buffer_pool_size); i++) {
+    too_many.push_back(i);
+  }
+  EXPECT_TRUE(bpm->FetchPages(too_many).empty());
+  too_many.pop_back();
+  pages = bpm->FetchPages(too_many);
+  ASSERT_EQ(buffer_pool_size, pages.size());
+  for (size_t i = 0; i < pages.size(); i++) {
+    EXPECT_EQ(fmt::format("page {}", i), std::string(pages[i]->GetData()));
+  }
+  EXPECT_TRUE(bpm->FetchPages({static_cast<page_id_t>(buffer_pool_size)}).empty());
+  EXPECT_TRUE(bpm->UnpinPages(too_many, false));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BulkFlushTest) {
+  const size_t buffer_pool_size = 10;
+  auto *disk_manager = new BatchCountingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+  }
+  // Pages 3 and 6 stay pinned, the odd pages are clean.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    if (page_id != 3 && page_id != 6) {
+      ASSERT_TRUE(bpm->UnpinPage(page_id, page_id % 2 == 0));
+    }
+  }
+  ASSERT_TRUE(bpm->UnpinPage(3, true));
+
+  // Scenario: only the dirty pages are written, pinned or not, in one batch sorted by page id, without syncing.
+  bpm->FlushAllPages();
+  ASSERT_EQ(1, disk_manager->GetWriteBatches().size());
+  EXPECT_EQ((std::vector<page_id_t>{0, 2, 3, 4, 8}), disk_manager->GetWriteBatches()[0]);
+  EXPECT_EQ(0, disk_manager->GetNumSyncs());
+
+  // Scenario: the pages are clean now, and can still be evicted once unpinned.
+  bpm->FlushAllPages();
+  EXPECT_EQ(1, disk_manager->GetWriteBatches().size());
+  ASSERT_TRUE(bpm->UnpinPage(6, true));
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  // Scenario: syncing flushes the dirty pages, then syncs once.
+  bpm->SyncAllPages();
+  EXPECT_EQ(1, disk_manager->GetNumSyncs());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id += 2) {
+    char data[BUSTUB_PAGE_SIZE];
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ(fmt::format("page {}", page_id), std::string(data));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/**
+ * Writes back a pool full of dirty pages of a database file, once page by page and once as a bulk flush, and syncs
+ * the file after each.
+ */
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DISABLED_BulkFlushBenchmark) {
+  const size_t buffer_pool_size = 16384;
+  const int rounds = 5;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->SyncAllPages();
+
+  auto dirty_all = [&] {
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+      auto *page = bpm->FetchPage(page_id);
+      page->GetData()[0]++;
+      bpm->UnpinPage(page_id, true);
+    }
+  };
+  auto time_ms = [&](const std::function<void()> &flush) {
+    double total = 0;
+    for (int round = 0; round < rounds; round++) {
+      dirty_all();
+      auto start = std::chrono::steady_clock::now();
+      flush();
+      disk_manager->Sync();
+      total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    return total / rounds;
+  };
+
+  auto page_by_page = time_ms([&] {
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+      bpm->FlushPage(page_id);
+    }
+  });
+  auto bulk = time_ms([&] { bpm->FlushAllPages(); });
+  std::cout << buffer_pool_size << " dirty pages: page by page " << page_by_page << " ms, bulk flush " << bulk
+            << " ms, " << page_by_page / bulk << "x" << std::endl;
+
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, WarmUpTest) {
+  const std::string hot_file_name = "test.hot";
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_pages = 30;
+
+  auto *disk_manager = new ReadCountingDiskManager(0);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (page_id_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: the pinned page is the hottest, then come the pages accessed most often, then the others.
+  std::vector<page_id_t> hot_pages{4, 8, 15, 16, 23};
+  for (int round = 0; round < 3; round++) {
+    for (auto page_id : hot_pages) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(29));
+  auto hot_set = bpm->GetHotPages();
+  ASSERT_EQ(buffer_pool_size, hot_set.size());
+  EXPECT_EQ(29, hot_set[0]);
+  EXPECT_EQ(std::set<page_id_t>(hot_pages.begin(), hot_pages.end()),
+            std::set<page_id_t>(hot_set.begin() + 1, hot_set.begin() + 1 + hot_pages.size()));
+  ASSERT_TRUE(bpm->UnpinPage(29, false));
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Scenario: the hot page set survives a round trip through its file.
+  ASSERT_TRUE(HotPageFile::Write(hot_file_name, hot_set));
+  auto read_hot_set = HotPageFile::Read(hot_file_name);
+  ASSERT_TRUE(read_hot_set.has_value());
+  EXPECT_EQ(hot_set, *read_hot_set);
+  remove(hot_file_name.c_str());
+  EXPECT_FALSE(HotPageFile::Read(hot_file_name).has_value());
+  EXPECT_EQ("test.hot", HotPageFile::FileNameFor("test.db"));
+
+  // Scenario: a restarted buffer pool preloads the hot page set, and then serves it without reading from disk.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->WarmUp(hot_set);
+  bpm->WaitForWarmUp();
+  EXPECT_EQ(buffer_pool_size, bpm->GetWarmUpCount());
+  auto reads = disk_manager->GetWatchedReads();
+  for (auto page_id : hot_set) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(fmt::format("page {}", page_id), std::string(page->GetData()));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(reads, disk_manager->GetWatchedReads());
+  delete bpm;
+
+  // Scenario: warming up never evicts. With only 6 free frames, the 6 hottest pages are preloaded, and new pages are
+  // allocated past them.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  bpm->WarmUp(hot_set);
+  bpm->WaitForWarmUp();
+  EXPECT_EQ(6, bpm->GetWarmUpCount());
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  reads = disk_manager->GetWatchedReads();
+  for (size_t i = 0; i < 6; i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(hot_set[i]));
+    ASSERT_TRUE(bpm->UnpinPage(hot_set[i], false));
+  }
+  EXPECT_EQ(reads, disk_manager->GetWatchedReads());
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_GT(page_id, *std::max_element(hot_set.begin(), hot_set.begin() + 6));
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FreePageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const page_id_t num_pages = 8;
+  remove(db_name.c_str());
+  remove(FreePageMap::FileNameFor(db_name).c_str());
+  auto file_size = [&] {
+    struct stat stat_buf;
+    return stat(db_name.c_str(), &stat_buf) == 0 ? stat_buf.st_size : -1;
+  };
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (page_id_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+  ASSERT_EQ(num_pages * BUSTUB_PAGE_SIZE, file_size());
+
+  // Scenario: deleted pages are reused lowest first, zeroed, before the file grows.
+  ASSERT_TRUE(bpm->DeletePage(5));
+  ASSERT_TRUE(bpm->DeletePage(2));
+  EXPECT_EQ(2, disk_manager->GetNumFreePages());
+  std::vector<char> zeros(BUSTUB_PAGE_SIZE, 0);
+  for (page_id_t expected : {2, 5, 8}) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(expected, page_id);
+    EXPECT_EQ(0, memcmp(zeros.data(), page->GetData(), BUSTUB_PAGE_SIZE));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, disk_manager->GetNumFreePages());
+
+  // Scenario: a reused page is written over its old data even if the caller never dirties it.
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  auto *page = bpm->FetchPage(2);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, memcmp(zeros.data(), page->GetData(), BUSTUB_PAGE_SIZE));
+  ASSERT_TRUE(bpm->UnpinPage(2, false));
+
+  // Scenario: deleting the pages at the end of the file shrinks it.
+  ASSERT_NE(nullptr, bpm->FetchPage(num_pages));
+  ASSERT_TRUE(bpm->UnpinPage(num_pages, true));
+  bpm->FlushAllPages();
+  ASSERT_EQ((num_pages + 1) * BUSTUB_PAGE_SIZE, file_size());
+  ASSERT_TRUE(bpm->DeletePage(7));
+  EXPECT_EQ((num_pages + 1) * BUSTUB_PAGE_SIZE, file_size());
+  ASSERT_TRUE(bpm->DeletePage(8));
+  EXPECT_EQ((num_pages - 1) * BUSTUB_PAGE_SIZE, file_size());
+  ASSERT_TRUE(bpm->DeletePage(3));
+
+  // Scenario: the free pages survive a restart, and new ids start past the pages of the file.
+  bpm->SyncAllPages();
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  disk_manager = new DiskManager(db_name);
+  EXPECT_EQ(3, disk_manager->GetNumFreePages());
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (page_id_t expected : {3, 7, 8, 9}) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(expected, page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  page = bpm->FetchPage(4);
+  ASSERT_NE(nullptr, page);
+  EXPECT_STREQ("page 4", page->GetData());
+  ASSERT_TRUE(bpm->UnpinPage(4, false));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove("test.log");
+  remove(FreePageMap::FileNameFor(db_name).c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ExtentTest) {
+  const size_t buffer_pool_size = 8;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  PageExtent table(4);
+  PageExtent index(4);
+
+  // Scenario: pages allocated in turns by two objects stay contiguous within the extent of each.
+  std::vector<page_id_t> table_pages;
+  std::vector<page_id_t> index_pages;
+  for (int i = 0; i < 6; i++) {
+    for (auto [extent, pages] : {std::make_pair(&table, &table_pages), std::make_pair(&index, &index_pages)}) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id, *extent));
+      ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+      pages->push_back(page_id);
+    }
+  }
+  EXPECT_EQ((std::vector<page_id_t>{0, 1, 2, 3, 8, 9}), table_pages);
+  EXPECT_EQ((std::vector<page_id_t>{4, 5, 6, 7, 12, 13}), index_pages);
+
+  // Regular pages are allocated past the reserved extents.
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(16, page_id);
+  ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+
+  delete bpm;
+  delete disk_manager;
+
+  // Scenario: the default tablespace ends where the ids of tablespace 1 start. Its last free page is reused, and the
+  // ids given back by a full pool are handed out again.
+  auto last_page_id = static_cast<page_id_t>(TABLESPACE_MAX_PAGES - 1);
+  disk_manager = new DiskManagerUnlimitedMemory();
+  disk_manager->DeallocatePage(last_page_id - 2);
+  bpm = new BufferPoolManagerInstance(2, disk_manager);
+  std::vector<page_id_t> page_ids(2);
+  for (auto &id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&id));
+  }
+  EXPECT_EQ((std::vector<page_id_t>{last_page_id - 2, last_page_id - 1}), page_ids);
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  for (auto id : page_ids) {
+    ASSERT_TRUE(bpm->UnpinPage(id, true));
+  }
+  // An extent doesn't fit anymore, single pages are created until the end.
+  PageExtent last_extent(4);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id, last_extent));
+  EXPECT_EQ(last_page_id, page_id);
+  ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id, last_extent));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/**
+ * Fetches batches of random cold pages from a pool that mostly misses, either one page at a time or with FetchPages().
+ * Prints the pages fetched per second.
+ */
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DISABLED_BatchFetchBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 256;
+  const page_id_t num_pages = 8192;
+  const size_t num_batches = 20000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  {
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    for (page_id_t i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      bpm->NewPage(&page_id);
+      bpm->UnpinPage(page_id, true);
+    }
+    bpm->FlushAllPages();
+    delete bpm;
+  }
+
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "batch size	mode	pages/s" << std::endl;
+  for (size_t batch_size : {4, 16, 64}) {
+    for (bool batched : {false, true}) {
+      auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+      std::mt19937 gen(0);
+      std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+      std::vector<page_id_t> page_ids(batch_size);
+      auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < num_batches; i++) {
+        for (auto &page_id : page_ids) {
+          page_id = dist(gen);
+        }
+        if (batched) {
+          bpm->FetchPages(page_ids);
+          bpm->UnpinPages(page_ids, false);
+        } else {
+          for (auto page_id : page_ids) {
+            bpm->FetchPage(page_id);
+          }
+          for (auto page_id : page_ids) {
+            bpm->UnpinPage(page_id, false);
+          }
+        }
+      }
+      auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      std::cout << batch_size << "\t" << (batched ? "batch" : "single") << "\t"
+                << static_cast<uint64_t>(num_batches * batch_size / seconds) << std::endl;
+      delete bpm;
+    }
+  }
+  std::cout << ">>> END" << std::endl;
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+/**
+ * Point lookups over a hot working set run concurrently with repeated full scans of a table heap four times the size of
+ * the pool, with and without a ring for the scan. Prints the hit ratio of the lookups, and how many frames the ring
+ * recycled.
+ */
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DISABLED_AccessStrategyBenchmark) {
+  const size_t buffer_pool_size = 256;
+  const size_t num_table_pages = 1024;
+  const page_id_t num_hot_pages = 128;
+  const size_t num_lookups = 200000;
+  // a tuple takes up most of a page
+  Schema schema({Column{"a", TypeId::VARCHAR, 3000}});
+  Tuple tuple({ValueFactory::GetVarcharValue(std::string(3000, 'x'))}, &schema);
+
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "strategy\tlookups\thot misses\thit ratio\tring reuses" << std::endl;
+  for (bool use_strategy : {false, true}) {
+    auto *disk_manager = new ReadCountingDiskManager(std::numeric_limits<page_id_t>::max());
+    // The table is filled through a pool of its own, which leaves the pages with a long access history.
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    Transaction txn(0);
+    auto *setup_table = new TableHeap(bpm, nullptr, nullptr, &txn);
+    page_id_t first_page_id = setup_table->GetFirstPageId();
+    std::set<page_id_t> table_page_ids;
+    while (table_page_ids.size() < num_table_pages) {
+      RID rid;
+      ASSERT_TRUE(setup_table->InsertTuple(tuple, &rid, &txn));
+      table_page_ids.insert(rid.GetPageId());
+    }
+    // The hot pages come after the pages the table reserved.
+    page_id_t first_hot_page_id = INVALID_PAGE_ID;
+    for (page_id_t i = 0; i < num_hot_pages; i++) {
+      page_id_t page_id;
+      bpm->NewPage(&page_id);
+      bpm->UnpinPage(page_id, true);
+      first_hot_page_id = i == 0 ? page_id : first_hot_page_id;
+    }
+    bpm->FlushAllPages();
+    delete setup_table;
+    delete bpm;
+    bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    TableHeap table(bpm, nullptr, nullptr, first_page_id);
+    disk_manager->Watch(first_hot_page_id);
+
+    std::atomic<bool> done{false};
+    BufferAccessStrategy strategy;
+    std::thread scanner([&]() {
+      Transaction scan_txn(1);
+      while (!done) {
+        for (auto iterator = table.Begin(&scan_txn, use_strategy ? &strategy : nullptr);
+             iterator != table.End() && !done; ++iterator) {
+        }
+      }
+    });
+
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<page_id_t> dist(first_hot_page_id, first_hot_page_id + num_hot_pages - 1);
+    auto warm_reads = disk_manager->GetWatchedReads();
+    for (size_t i = 0; i < num_lookups; i++) {
+      auto page_id = dist(gen);
+      if (bpm->FetchPage(page_id) != nullptr) {
+        bpm->UnpinPage(page_id, false);
+      }
+    }
+    done = true;
+    scanner.join();
+
+    auto misses = disk_manager->GetWatchedReads() - warm_reads;
+    std::cout << (use_strategy ? "ring" : "none") << "\t" << num_lookups << "\t" << misses << "\t"
+              << 1.0 - static_cast<double>(misses) / num_lookups << "\t" << strategy.GetReusedCount() << std::endl;
+    delete bpm;
+    delete disk_manager;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
 }  // namespace bustub
@@ -0,0 +1,244 @@
+/**
+ * compressed_page_cache_test.cpp
+ */
+
+#include "buffer/compressed_page_cache.h"
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/page_codec.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+/** Fill a page with rows that look like a table of fixed-width records, which compress well. */
+void FillTablePage(page_id_t page_id, char *data) {
+  memset(data, 0, BUSTUB_PAGE_SIZE);
+  size_t offset = 0;
+  for (int row = 0; offset + 64 < BUSTUB_PAGE_SIZE / 2; row++) {
+    offset += snprintf(data + offset, 64, "id=%08d;name=customer%06d;balance=%06d|", page_id * 100 + row, row,
+                       row * 37 % 1000);
+  }
+}
+
+/** Fill a page with random bytes, which don't compress. */
+void FillRandomPage(std::mt19937 *gen, char *data) {
+  std::uniform_int_distribution<int> byte(0, 255);
+  for (size_t i = 0; i < BUSTUB_PAGE_SIZE; i++) {
+    data[i] = static_cast<char>(byte(*gen));
+  }
+}
+
+TEST(CompressedPageCacheTest, PageCodecTest) {
+  std::mt19937 gen(0);
+  std::vector<char> page(BUSTUB_PAGE_SIZE);
+  std::vector<char> output(BUSTUB_PAGE_SIZE);
+  std::string compressed;
+
+  // Scenario: every kind of page survives a round trip, and the ones with redundancy get smaller.
+  for (int kind = 0; kind < 3; kind++) {
+    if (kind == 0) {
+      memset(page.data(), 0, BUSTUB_PAGE_SIZE);
+    } else if (kind == 1) {
+      FillTablePage(7, page.data());
+    } else {
+      FillRandomPage(&gen, page.data());
+    }
+    PageCodec::Compress(page.data(), BUSTUB_PAGE_SIZE, &compressed);
+    ASSERT_TRUE(PageCodec::Decompress(compressed.data(), compressed.size(), output.data(), BUSTUB_PAGE_SIZE));
+    ASSERT_EQ(0, memcmp(page.data(), output.data(), BUSTUB_PAGE_SIZE));
+    if (kind < 2) {
+      EXPECT_LT(compressed.size(), BUSTUB_PAGE_SIZE / 4);
+    }
+  }
+
+  // Scenario: truncated or garbled input is rejected instead of overrunning the output.
+  FillTablePage(7, page.data());
+  PageCodec::Compress(page.data(), BUSTUB_PAGE_SIZE, &compressed);
+  EXPECT_FALSE(PageCodec::Decompress(compressed.data(), compressed.size() - 1, output.data(), BUSTUB_PAGE_SIZE));
+  EXPECT_FALSE(PageCodec::Decompress(compressed.data(), compressed.size(), output.data(), BUSTUB_PAGE_SIZE - 1));
+  std::string garbled("\x85\x10\x00", 3);
+  EXPECT_FALSE(PageCodec::Decompress(garbled.data(), garbled.size(), output.data(), BUSTUB_PAGE_SIZE));
+}
+
+TEST(CompressedPageCacheTest, SampleTest) {
+  std::mt19937 gen(0);
+  std::vector<char> page(BUSTUB_PAGE_SIZE);
+  std::vector<char> output(BUSTUB_PAGE_SIZE);
+
+  FillTablePage(0, page.data());
+  std::string compressed;
+  PageCodec::Compress(page.data(), BUSTUB_PAGE_SIZE, &compressed);
+  // Room for three pages.
+  CompressedPageCache cache(compressed.size() * 3 + compressed.size() / 2);
+
+  // Scenario: a stored page is found once, then it is gone.
+  for (page_id_t page_id = 0; page_id < 3; page_id++) {
+    FillTablePage(page_id, page.data());
+    ASSERT_TRUE(cache.Insert(page_id, page.data()));
+  }
+  ASSERT_TRUE(cache.Take(1, output.data()));
+  FillTablePage(1, page.data());
+  ASSERT_EQ(0, memcmp(page.data(), output.data(), BUSTUB_PAGE_SIZE));
+  ASSERT_FALSE(cache.Take(1, output.data()));
+
+  // Scenario: over budget, the least recently stored pages go first.
+  for (page_id_t page_id = 3; page_id < 5; page_id++) {
+    FillTablePage(page_id, page.data());
+    ASSERT_TRUE(cache.Insert(page_id, page.data()));
+  }
+  auto stats = cache.GetStats();
+  EXPECT_EQ(3, stats.num_pages_);
+  EXPECT_EQ(1, stats.evictions_);
+  EXPECT_LE(stats.bytes_used_, stats.memory_budget_);
+  EXPECT_GT(stats.CompressionRatio(), 4.0);
+  EXPECT_FALSE(cache.Take(0, output.data()));
+  EXPECT_TRUE(cache.Take(2, output.data()));
+
+  // Scenario: a page that doesn't compress is not stored, and replaces the copy that was.
+  FillRandomPage(&gen, page.data());
+  EXPECT_FALSE(cache.Insert(3, page.data()));
+  EXPECT_FALSE(cache.Take(3, output.data()));
+
+  // Scenario: erased pages are gone.
+  cache.Erase(4);
+  EXPECT_FALSE(cache.Take(4, output.data()));
+
+  stats = cache.GetStats();
+  EXPECT_EQ(0, stats.num_pages_);
+  EXPECT_EQ(0, stats.bytes_used_);
+  EXPECT_EQ(5, stats.insertions_);
+  EXPECT_EQ(1, stats.rejections_);
+  EXPECT_EQ(2, stats.hits_);
+  EXPECT_EQ(4, stats.misses_);
+}
+
+/** An in-memory disk manager that counts reads. */
+class CountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    reads_++;
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  auto GetReads() const -> size_t { return reads_; }
+
+ private:
+  std::atomic<size_t> reads_{0};
+};
+
+TEST(CompressedPageCacheTest, BufferPoolTest) {
+  const size_t buffer_pool_size = 8;
+  const page_id_t num_pages = 32;
+
+  auto *disk_manager = new CountingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  auto cache = std::make_shared<CompressedPageCache>(num_pages * BUSTUB_PAGE_SIZE);
+  bpm->SetCompressedCache(cache);
+
+  // Scenario: every evicted page lands in the cache once it is written back, and comes back from there. Each fetch is
+  // a cache hit, since the pages still resident from the first pass are evicted by it before they are fetched.
+  for (page_id_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    FillTablePage(page_id, page->GetData());
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  std::vector<char> expected(BUSTUB_PAGE_SIZE);
+  for (int round = 0; round < 2; round++) {
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      FillTablePage(page_id, expected.data());
+      ASSERT_EQ(0, memcmp(expected.data(), page->GetData(), BUSTUB_PAGE_SIZE));
+      ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  EXPECT_EQ(0, disk_manager->GetReads());
+  auto stats = cache->GetStats();
+  EXPECT_EQ(2 * num_pages, stats.hits_);
+  EXPECT_EQ(num_pages - buffer_pool_size, stats.num_pages_);
+
+  // Scenario: a page modified after it came back from the cache is stored again with the new content.
+  auto *page = bpm->FetchPage(0);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "modified");
+  ASSERT_TRUE(bpm->UnpinPage(0, true));
+  for (page_id_t page_id = 1; page_id <= static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  page = bpm->FetchPage(0);
+  EXPECT_EQ("modified", std::string(page->GetData()));
+  ASSERT_TRUE(bpm->UnpinPage(0, false));
+
+  // Scenario: a deleted page is dropped from the cache, and batched fetches use the cache too.
+  EXPECT_TRUE(bpm->DeletePage(num_pages - 1));
+  auto pages = bpm->FetchPages({num_pages - 4, num_pages - 3});
+  ASSERT_EQ(2, pages.size());
+  FillTablePage(num_pages - 3, expected.data());
+  EXPECT_EQ(0, memcmp(expected.data(), pages[1]->GetData(), BUSTUB_PAGE_SIZE));
+  EXPECT_TRUE(bpm->UnpinPages({num_pages - 4, num_pages - 3}, false));
+  EXPECT_EQ(0, disk_manager->GetReads());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/**
+ * A skewed workload over a table four times the size of the pool, with a compressed cache of half the size of the
+ * pool or without one. Prints the disk reads and the throughput.
+ */
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, DISABLED_CapacityBenchmark) {
+  const size_t buffer_pool_size = 1024;
+  const page_id_t num_pages = 4096;
+  const size_t num_fetches = 500000;
+
+  std::vector<double> weights;
+  for (page_id_t i = 1; i <= num_pages; i++) {
+    weights.push_back(1.0 / i);
+  }
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "cache budget\tdisk reads\tcache hit ratio\tcompression\tfetches/s" << std::endl;
+  for (size_t budget : {size_t{0}, buffer_pool_size * BUSTUB_PAGE_SIZE / 2}) {
+    auto *disk_manager = new CountingDiskManager();
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    std::shared_ptr<CompressedPageCache> cache;
+    if (budget > 0) {
+      cache = std::make_shared<CompressedPageCache>(budget);
+      bpm->SetCompressedCache(cache);
+    }
+    for (page_id_t i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      FillTablePage(i, bpm->NewPage(&page_id)->GetData());
+      bpm->UnpinPage(page_id, true);
+    }
+
+    std::mt19937 gen(0);
+    std::discrete_distribution<page_id_t> zipf(weights.begin(), weights.end());
+    auto reads = disk_manager->GetReads();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_fetches; i++) {
+      auto page_id = zipf(gen);
+      bpm->FetchPage(page_id);
+      bpm->UnpinPage(page_id, false);
+    }
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    auto stats = cache == nullptr ? CompressedPageCacheStats{} : cache->GetStats();
+    std::cout << budget << "\t" << disk_manager->GetReads() - reads << "\t" << stats.HitRatio() << "\t"
+              << stats.CompressionRatio() << "\t" << static_cast<uint64_t>(num_fetches / seconds) << std::endl;
+    delete bpm;
+    delete disk_manager;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
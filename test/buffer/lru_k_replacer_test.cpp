@@ -5,11 +5,15 @@
 #include "buffer/lru_k_replacer.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <deque>
+#include <iostream>
 #include <memory>
 #include <random>
 #include <set>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -97,4 +101,157 @@ TEST(LRUKReplacerTest, SampleTest) {
   lru_replacer.Remove(1);
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+/**
+ * Reference LRU-K replacer that scans every tracked frame on each eviction. It is the straightforward implementation
+ * of the policy, used to check the ordered-set replacer and as the baseline of the eviction benchmark.
+ */
+class ScanLRUKReplacer {
+ public:
+  ScanLRUKReplacer(size_t num_frames, size_t k) : k_(k) {}
+
+  auto Evict(frame_id_t *frame_id) -> bool {
+    bool found = false;
+    bool found_inf = false;
+    size_t found_ts = 0;
+    for (const auto &[id, entry] : frames_) {
+      if (!entry.evictable_) {
+        continue;
+      }
+      bool inf = entry.history_.size() < k_;
+      size_t ts = entry.history_.front();
+      if (!found || (inf && !found_inf) || (inf == found_inf && ts < found_ts)) {
+        found = true;
+        found_inf = inf;
+        found_ts = ts;
+        *frame_id = id;
+      }
+    }
+    if (found) {
+      frames_.erase(*frame_id);
+    }
+    return found;
+  }
+
+  void RecordAccess(frame_id_t frame_id) {
+    auto &history = frames_[frame_id].history_;
+    history.push_back(++current_timestamp_);
+    if (history.size() > k_) {
+      history.pop_front();
+    }
+  }
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) {
+    if (frames_.count(frame_id) != 0) {
+      frames_[frame_id].evictable_ = set_evictable;
+    }
+  }
+
+  auto Size() -> size_t {
+    return std::count_if(frames_.begin(), frames_.end(), [](const auto &f) { return f.second.evictable_; });
+  }
+
+ private:
+  struct Entry {
+    bool evictable_{true};
+    std::deque<size_t> history_;
+  };
+  size_t current_timestamp_{0};
+  size_t k_;
+  std::unordered_map<frame_id_t, Entry> frames_;
+};
+
+TEST(LRUKReplacerTest, MatchesScanReplacerTest) {
+  const size_t num_frames = 64;
+  const size_t k = 3;
+  LRUKReplacer lru_replacer(num_frames, k);
+  ScanLRUKReplacer reference(num_frames, k);
+
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<frame_id_t> frame_dist(0, num_frames - 1);
+  std::uniform_int_distribution<int> op_dist(0, 9);
+  for (int i = 0; i < 20000; i++) {
+    auto frame_id = frame_dist(gen);
+    auto op = op_dist(gen);
+    if (op < 5) {
+      lru_replacer.RecordAccess(frame_id);
+      reference.RecordAccess(frame_id);
+    } else if (op < 8) {
+      lru_replacer.SetEvictable(frame_id, op == 5);
+      reference.SetEvictable(frame_id, op == 5);
+    } else {
+      frame_id_t expected = -1;
+      frame_id_t actual = -1;
+      ASSERT_EQ(reference.Evict(&expected), lru_replacer.Evict(&actual));
+      ASSERT_EQ(expected, actual);
+    }
+    ASSERT_EQ(reference.Size(), lru_replacer.Size());
+  }
+}
+
+/**
+ * Fill a replacer with `num_frames` evictable frames, then time `num_ops` rounds of evict + re-admit, which is what
+ * every buffer pool miss does to the replacer.
+ */
+template <typename ReplacerType>
+auto EvictBenchmarkMs(size_t num_frames, size_t num_ops) -> int64_t {
+  ReplacerType replacer(num_frames, LRUK_REPLACER_K);
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<frame_id_t> frame_dist(0, num_frames - 1);
+  for (size_t i = 0; i < num_frames; i++) {
+    replacer.RecordAccess(static_cast<frame_id_t>(i));
+  }
+  for (size_t i = 0; i < num_frames; i++) {
+    replacer.RecordAccess(frame_dist(gen));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_ops; i++) {
+    frame_id_t frame_id;
+    replacer.Evict(&frame_id);
+    replacer.RecordAccess(frame_id);
+    replacer.SetEvictable(frame_id, false);
+    replacer.SetEvictable(frame_id, true);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+}
+
+TEST(LRUKReplacerTest, ResizeTest) {
+  LRUKReplacer lru_replacer(4, 2);
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    lru_replacer.RecordAccess(frame_id);
+  }
+  lru_replacer.SetEvictable(1, false);
+  ASSERT_EQ(3, lru_replacer.Size());
+
+  // Scenario: shrinking drops the frames that are cut off, evictable or not.
+  lru_replacer.Resize(2);
+  ASSERT_EQ(1, lru_replacer.Size());
+  frame_id_t frame_id;
+  ASSERT_TRUE(lru_replacer.Evict(&frame_id));
+  ASSERT_EQ(0, frame_id);
+  ASSERT_FALSE(lru_replacer.Evict(&frame_id));
+
+  // Scenario: growing accepts new frames, which start out with no history.
+  lru_replacer.Resize(8);
+  lru_replacer.RecordAccess(7);
+  lru_replacer.RecordAccess(3);
+  ASSERT_EQ(2, lru_replacer.Size());
+  ASSERT_TRUE(lru_replacer.Evict(&frame_id));
+  ASSERT_EQ(7, frame_id);
+}
+
+TEST(LRUKReplacerTest, DISABLED_EvictBenchmark) {
+  const size_t num_ops = 200;
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "frames\tscan (ms)\tordered (ms)" << std::endl;
+  for (size_t num_frames : {10000, 100000, 1000000}) {
+    auto scan_ms = EvictBenchmarkMs<ScanLRUKReplacer>(num_frames, num_ops);
+    auto ordered_ms = EvictBenchmarkMs<LRUKReplacer>(num_frames, num_ops);
+    std::cout << num_frames << "\t" << scan_ms << "\t" << ordered_ms << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
 }  // namespace bustub
@@ -0,0 +1,310 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/page_extent.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 5;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, k);
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+
+  // Scenario: The buffer pool is empty. We should be able to create a new page.
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  // Scenario: Once we have a page, we should be able to read and write content.
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: We should be able to create new pages until we fill up the buffer pool. Allocation is round-robin,
+  // so consecutive new pages are handed out by consecutive instances.
+  for (size_t i = 1; i < buffer_pool_size * num_instances; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+  }
+
+  // Scenario: Once the buffer pool is full, we should not be able to create any new pages.
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: After unpinning pages {0, 1, 2, 3, 4}, every instance has exactly one evictable frame.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+    bpm->FlushPage(i);
+  }
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    bpm->UnpinPage(page_id_temp, false);
+  }
+
+  // Scenario: We should be able to fetch the data we wrote a while ago.
+  page0 = bpm->FetchPage(0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+
+  // Scenario: Pages are routed to the instance that owns them, so deleting works across instances.
+  EXPECT_EQ(true, bpm->DeletePage(0));
+  EXPECT_EQ(false, bpm->DeletePage(page_id_t{6}));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, BatchFetchTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  for (size_t i = 0; i < 3 * buffer_pool_size * num_instances; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: a batch spanning every instance comes back in the order it was asked for.
+  std::vector<page_id_t> page_ids{7, 0, 11, 4, 0, 2};
+  auto pages = bpm->FetchPages(page_ids);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ("page " + std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+  }
+  EXPECT_TRUE(bpm->UnpinPages(page_ids, false));
+
+  // Scenario: when one instance runs out of frames, the pages fetched from the others are unpinned again.
+  std::vector<page_id_t> too_many{0, 1};
+  for (size_t i = 0; i <= buffer_pool_size; i++) {
+    too_many.push_back(static_cast<page_id_t>(i * num_instances + 2));
+  }
+  EXPECT_TRUE(bpm->FetchPages(too_many).empty());
+  for (page_id_t page_id : {0, 1}) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** Records the batches of pages written. */
+class WriteBatchRecordingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override {
+    write_batches_.push_back(page_ids);
+    DiskManagerUnlimitedMemory::WritePages(page_ids, pages_data);
+  }
+
+  auto GetWriteBatches() const -> const std::vector<std::vector<page_id_t>> & { return write_batches_; }
+
+ private:
+  std::vector<std::vector<page_id_t>> write_batches_;
+};
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, BulkFlushTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new WriteBatchRecordingDiskManager();
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  for (size_t i = 0; i < buffer_pool_size * num_instances; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: the dirty pages of all instances are written as a single batch in page id order, and synced once.
+  bpm->SyncAllPages();
+  ASSERT_EQ(1, disk_manager->GetWriteBatches().size());
+  const auto &batch = disk_manager->GetWriteBatches()[0];
+  ASSERT_EQ(buffer_pool_size * num_instances, batch.size());
+  for (size_t i = 0; i < batch.size(); i++) {
+    EXPECT_EQ(static_cast<page_id_t>(i), batch[i]);
+  }
+  EXPECT_EQ(1, disk_manager->GetNumSyncs());
+
+  bpm->FlushAllPages();
+  EXPECT_EQ(1, disk_manager->GetWriteBatches().size());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ExtentTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+
+  // Scenario: an extent spans the ids of every instance, and each page is created in the instance that owns it.
+  PageExtent extent(8);
+  for (page_id_t expected = 1; expected <= 8; expected++) {
+    auto *page = bpm->NewPage(&page_id, extent);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(expected, page_id);
+    EXPECT_EQ(page, bpm->FetchPage(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Every instance allocates its regular pages past the extent.
+  for (size_t i = 0; i < num_instances; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_GE(page_id, 9);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrencyTest) {
+  const size_t num_threads = 8;
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 16;
+  const int rounds = 50;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&bpm]() {
+      std::vector<page_id_t> page_ids;
+      page_id_t page_id;
+      for (int i = 0; i < rounds; i++) {
+        auto *page = bpm->NewPage(&page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+        page_ids.push_back(page_id);
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      }
+      for (auto id : page_ids) {
+        auto *page = bpm->FetchPage(id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(std::to_string(id), std::string(page->GetData()));
+        EXPECT_EQ(true, bpm->UnpinPage(id, false));
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/**
+ * Run `num_threads` threads that each fetch and unpin pages uniformly at random from a working set that fits in
+ * memory, i.e. every access is a cache hit. Returns the throughput in operations per second.
+ */
+auto FetchUnpinThroughput(BufferPoolManager *bpm, size_t num_threads, size_t num_pages, size_t ops_per_thread)
+    -> double {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([bpm, tid, num_pages, ops_per_thread]() {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, static_cast<page_id_t>(num_pages) - 1);
+      for (size_t i = 0; i < ops_per_thread; i++) {
+        auto page_id = dist(gen);
+        auto *page = bpm->FetchPage(page_id);
+        if (page != nullptr) {
+          bpm->UnpinPage(page_id, false);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  auto seconds = std::chrono::duration<double>(end - start).count();
+  return static_cast<double>(num_threads * ops_per_thread) / seconds;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, DISABLED_FetchUnpinScalingBenchmark) {
+  const size_t total_frames = 1024;
+  const size_t num_pages = 512;
+  const size_t ops_per_thread = 200000;
+  const std::vector<size_t> instance_counts{1, 4, 16};
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "instances\tthreads\tops/s" << std::endl;
+  for (auto num_instances : instance_counts) {
+    auto *bpm = new ParallelBufferPoolManager(num_instances, total_frames / num_instances, disk_manager);
+    // Warm the pool so that the benchmark only measures cache hits.
+    for (size_t i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      bpm->NewPage(&page_id);
+      bpm->UnpinPage(page_id, true);
+    }
+    for (size_t num_threads = 1; num_threads <= std::thread::hardware_concurrency(); num_threads *= 2) {
+      auto ops = FetchUnpinThroughput(bpm, num_threads, num_pages, ops_per_thread);
+      std::cout << num_instances << "\t" << num_threads << "\t" << static_cast<uint64_t>(ops) << std::endl;
+    }
+    delete bpm;
+  }
+  std::cout << ">>> END" << std::endl;
+
+  delete disk_manager;
+}
+
+}  // namespace bustub
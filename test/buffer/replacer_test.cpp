@@ -0,0 +1,218 @@
+/**
+ * replacer_test.cpp
+ */
+
+#include "buffer/replacer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_pro_replacer.h"
+#include "buffer/trace_replayer.h"
+#include "buffer/two_queue_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+const std::vector<ReplacerPolicy> ALL_POLICIES = {ReplacerPolicy::LRU,   ReplacerPolicy::CLOCK,
+                                                  ReplacerPolicy::LRU_K, ReplacerPolicy::ARC,
+                                                  ReplacerPolicy::TWO_QUEUE, ReplacerPolicy::CLOCK_PRO};
+
+// Every policy must honor the contract the buffer pool relies on, whatever order it evicts in.
+TEST(ReplacerTest, ConformanceTest) {
+  for (auto policy : ALL_POLICIES) {
+    SCOPED_TRACE(fmt::format("{}", policy));
+    auto replacer = MakeReplacer(policy, 8);
+    for (frame_id_t i = 0; i < 8; i++) {
+      replacer->RecordAccess(i, i);
+    }
+    replacer->RecordAccess(2, 2);
+    replacer->RecordAccess(4, 4);
+    replacer->SetEvictable(3, false);
+    ASSERT_EQ(7, replacer->Size());
+
+    // Removing a frame, or making it non-evictable, takes it out of the eviction order.
+    replacer->Remove(6);
+    ASSERT_EQ(6, replacer->Size());
+    auto order = replacer->EvictionOrder(100);
+    ASSERT_EQ((std::set<frame_id_t>{0, 1, 2, 4, 5, 7}), std::set<frame_id_t>(order.begin(), order.end()));
+
+    std::set<frame_id_t> evicted;
+    frame_id_t frame_id;
+    for (size_t i = 0; i < 3; i++) {
+      ASSERT_TRUE(replacer->Evict(&frame_id));
+      ASSERT_NE(3, frame_id);
+      ASSERT_TRUE(evicted.insert(frame_id).second);
+    }
+    ASSERT_EQ(3, replacer->Size());
+
+    // Frames cut off by a shrink are forgotten, the others are still evicted.
+    replacer->Resize(6);
+    replacer->SetEvictable(3, true);
+    while (replacer->Evict(&frame_id)) {
+      ASSERT_LT(frame_id, 6);
+      ASSERT_TRUE(evicted.insert(frame_id).second);
+    }
+    ASSERT_EQ(0, replacer->Size());
+    for (frame_id_t i = 0; i < 6; i++) {
+      ASSERT_EQ(1, evicted.count(i));
+    }
+  }
+}
+
+TEST(ReplacerTest, ARCTest) {
+  ARCReplacer replacer(4);
+  for (frame_id_t i = 0; i < 4; i++) {
+    replacer.RecordAccess(i, i);
+  }
+  // Page 0 is seen twice and moves to T2, the others stay in T1, which goes first while p is 0.
+  replacer.RecordAccess(0, 0);
+  ASSERT_EQ((std::vector<frame_id_t>{1, 2, 3, 0}), replacer.EvictionOrder(4));
+  frame_id_t frame_id;
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  ASSERT_EQ(1, frame_id);
+
+  // Page 1 comes back while in B1: T1 was too small, so its target grows and the page goes to T2.
+  replacer.RecordAccess(1, 1);
+  ASSERT_EQ(1, replacer.GetTargetT1Size());
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  ASSERT_EQ(2, frame_id);
+  // T1 is down to its target, so the least recently used page of T2 goes next.
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  ASSERT_EQ(0, frame_id);
+
+  // Page 0 comes back while in B2: T2 was too small.
+  replacer.RecordAccess(0, 0);
+  ASSERT_EQ(0, replacer.GetTargetT1Size());
+  ASSERT_EQ((std::vector<frame_id_t>{3, 1, 0}), replacer.EvictionOrder(4));
+}
+
+TEST(ReplacerTest, TwoQueueTest) {
+  // Kin is 2 and Kout is 4 with 8 frames.
+  TwoQueueReplacer replacer(8);
+  for (frame_id_t i = 0; i < 8; i++) {
+    replacer.RecordAccess(i, i);
+  }
+  // With Am empty, A1in is evicted in FIFO order. Page 0 goes to A1out.
+  frame_id_t frame_id;
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  ASSERT_EQ(0, frame_id);
+
+  // Page 0 coming back from A1out goes to Am. A hit in A1in does not change the FIFO order.
+  replacer.RecordAccess(0, 0);
+  replacer.RecordAccess(1, 1);
+  // A1in is drained down to Kin before Am gives up a frame, and is only used again once Am is empty.
+  ASSERT_EQ((std::vector<frame_id_t>{1, 2, 3, 4, 5, 0, 6, 7}), replacer.EvictionOrder(8));
+  for (auto expected : replacer.EvictionOrder(8)) {
+    ASSERT_TRUE(replacer.Evict(&frame_id));
+    ASSERT_EQ(expected, frame_id);
+  }
+  ASSERT_FALSE(replacer.Evict(&frame_id));
+}
+
+TEST(ReplacerTest, ClockProTest) {
+  ClockProReplacer replacer(4);
+  for (frame_id_t i = 0; i < 4; i++) {
+    replacer.RecordAccess(i, i);
+  }
+  auto cold_target = replacer.GetColdTarget();
+  frame_id_t frame_id;
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  ASSERT_EQ(0, frame_id);
+
+  // Page 0 comes back during its test period: it turns hot, and cold pages get more room.
+  replacer.RecordAccess(0, 0);
+  ASSERT_EQ(cold_target + 1, replacer.GetColdTarget());
+
+  // A scan only churns the cold pages.
+  for (page_id_t page_id = 100; page_id < 120; page_id++) {
+    ASSERT_TRUE(replacer.Evict(&frame_id));
+    ASSERT_NE(0, frame_id);
+    replacer.RecordAccess(frame_id, page_id);
+  }
+  ASSERT_EQ(4, replacer.Size());
+}
+
+TEST(ReplacerTest, TraceReplayerTest) {
+  std::vector<page_id_t> trace;
+  for (size_t round = 0; round < 10; round++) {
+    for (page_id_t page_id = 0; page_id < 5; page_id++) {
+      trace.push_back(page_id);
+    }
+  }
+  for (auto policy : ALL_POLICIES) {
+    SCOPED_TRACE(fmt::format("{}", policy));
+    // Everything fits: only the first access of each page misses.
+    auto stats = TraceReplayer::Replay(policy, 5, trace);
+    ASSERT_EQ(trace.size(), stats.accesses_);
+    ASSERT_EQ(trace.size() - 5, stats.hits_);
+    ASSERT_LE(stats.p99_latency_ns_, stats.max_latency_ns_);
+  }
+  // A loop one page larger than the pool defeats LRU completely.
+  ASSERT_EQ(0, TraceReplayer::Replay(ReplacerPolicy::LRU, 4, trace).hits_);
+
+  TraceReplayer replayer(ReplacerPolicy::ARC, 2);
+  replayer.Access(1);
+  replayer.Access(2);
+  replayer.Delete(1);
+  replayer.Access(3);
+  replayer.Access(2);
+  ASSERT_EQ(1, replayer.GetStats().hits_);
+}
+
+/**
+ * A mix of OLTP lookups, which follow a zipfian distribution over a hot set, and sequential scans of a table much
+ * larger than the pool.
+ */
+auto MakeMixedTrace(size_t length, page_id_t num_hot_pages, page_id_t num_table_pages, double scan_fraction)
+    -> std::vector<page_id_t> {
+  std::mt19937 gen(0);
+  std::vector<double> weights;
+  for (page_id_t i = 1; i <= num_hot_pages; i++) {
+    weights.push_back(1.0 / i);
+  }
+  std::discrete_distribution<page_id_t> zipf(weights.begin(), weights.end());
+  std::bernoulli_distribution is_scan(scan_fraction);
+  std::vector<page_id_t> trace;
+  trace.reserve(length);
+  page_id_t scan_position = 0;
+  while (trace.size() < length) {
+    if (is_scan(gen)) {
+      // Scans read runs of 64 consecutive table pages, which sit after the hot set.
+      for (size_t i = 0; i < 64 && trace.size() < length; i++) {
+        trace.push_back(num_hot_pages + scan_position);
+        scan_position = (scan_position + 1) % num_table_pages;
+      }
+    } else {
+      trace.push_back(zipf(gen));
+    }
+  }
+  return trace;
+}
+
+TEST(ReplacerTest, DISABLED_PolicyComparisonBenchmark) {
+  const size_t trace_length = 1000000;
+  const page_id_t num_hot_pages = 20000;
+  const page_id_t num_table_pages = 100000;
+
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "scans\tframes\tpolicy\thit ratio\tmean (ns)\tp99 (ns)" << std::endl;
+  for (double scan_fraction : {0.0, 0.01, 0.05}) {
+    auto trace = MakeMixedTrace(trace_length, num_hot_pages, num_table_pages, scan_fraction);
+    for (size_t num_frames : {1000, 5000, 20000}) {
+      for (auto policy : ALL_POLICIES) {
+        auto stats = TraceReplayer::Replay(policy, num_frames, trace);
+        std::cout << scan_fraction << "\t" << num_frames << "\t" << fmt::format("{}", policy) << "\t"
+                  << stats.HitRatio() << "\t" << stats.mean_latency_ns_ << "\t" << stats.p99_latency_ns_
+                  << std::endl;
+      }
+    }
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -0,0 +1,155 @@
+/**
+ * page_table_test.cpp
+ */
+
+#include "container/hash/page_table.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "container/hash/extendible_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  auto table = std::make_unique<PageTable>(4);
+  frame_id_t frame_id;
+  EXPECT_FALSE(table->Find(0, frame_id));
+
+  table->Insert(0, 3);
+  table->Insert(8, 1);
+  table->Insert(16, 2);
+  EXPECT_EQ(3, table->Size());
+  EXPECT_TRUE(table->Find(8, frame_id));
+  EXPECT_EQ(1, frame_id);
+
+  // Inserting an existing page replaces its frame.
+  table->Insert(8, 5);
+  EXPECT_EQ(3, table->Size());
+  EXPECT_TRUE(table->Find(8, frame_id));
+  EXPECT_EQ(5, frame_id);
+
+  EXPECT_TRUE(table->Remove(8));
+  EXPECT_FALSE(table->Remove(8));
+  EXPECT_FALSE(table->Find(8, frame_id));
+  EXPECT_TRUE(table->Find(16, frame_id));
+  EXPECT_EQ(2, frame_id);
+  EXPECT_EQ(2, table->Size());
+}
+
+TEST(PageTableTest, ChurnAndGrowthTest) {
+  auto table = std::make_unique<PageTable>(16);
+  auto num_slots = table->GetNumSlots();
+
+  // Scenario: a buffer pool's worth of pages is replaced over and over. Tombstones are cleaned up without growing.
+  for (page_id_t page_id = 0; page_id < 10000; page_id++) {
+    if (page_id >= 16) {
+      ASSERT_TRUE(table->Remove(page_id - 16));
+    }
+    table->Insert(page_id, page_id % 16);
+  }
+  EXPECT_EQ(16, table->Size());
+  EXPECT_EQ(num_slots, table->GetNumSlots());
+  for (page_id_t page_id = 10000 - 16; page_id < 10000; page_id++) {
+    frame_id_t frame_id;
+    ASSERT_TRUE(table->Find(page_id, frame_id));
+    EXPECT_EQ(page_id % 16, frame_id);
+  }
+
+  // Scenario: holding more entries than expected grows the table.
+  for (page_id_t page_id = 0; page_id < 1000; page_id++) {
+    table->Insert(page_id, page_id);
+  }
+  EXPECT_LT(num_slots, table->GetNumSlots());
+  for (page_id_t page_id = 0; page_id < 1000; page_id++) {
+    frame_id_t frame_id;
+    ASSERT_TRUE(table->Find(page_id, frame_id));
+    EXPECT_EQ(page_id, frame_id);
+  }
+}
+
+TEST(PageTableTest, ConcurrentFindTest) {
+  const page_id_t num_stable = 64;
+  auto table = std::make_unique<PageTable>(128);
+  for (page_id_t page_id = 0; page_id < num_stable; page_id++) {
+    table->Insert(page_id, page_id);
+  }
+
+  // Scenario: readers always find the stable pages while a writer churns through other pages and grows the table.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 4; tid++) {
+    readers.emplace_back([&, tid]() {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, num_stable - 1);
+      while (!done) {
+        auto page_id = dist(gen);
+        frame_id_t frame_id;
+        ASSERT_TRUE(table->Find(page_id, frame_id));
+        EXPECT_EQ(page_id, frame_id);
+      }
+    });
+  }
+  for (page_id_t page_id = num_stable; page_id < 20000; page_id++) {
+    table->Insert(page_id, page_id);
+    if (page_id % 4 != 0) {
+      table->Remove(page_id);
+    }
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+/** Run `num_threads` threads doing uniformly random lookups on `table`, and return the lookups per second. */
+auto LookupThroughput(HashTable<page_id_t, frame_id_t> *table, size_t num_threads, page_id_t num_pages,
+                      size_t lookups_per_thread) -> double {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([=]() {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+      frame_id_t frame_id;
+      for (size_t i = 0; i < lookups_per_thread; i++) {
+        table->Find(dist(gen), frame_id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return static_cast<double>(num_threads * lookups_per_thread) / seconds;
+}
+
+TEST(PageTableTest, DISABLED_LookupBenchmark) {
+  const page_id_t num_pages = 4096;
+  const size_t lookups_per_thread = 1000000;
+
+  ExtendibleHashTable<page_id_t, frame_id_t> extendible(4);
+  PageTable page_table(num_pages);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    extendible.Insert(page_id, page_id);
+    page_table.Insert(page_id, page_id);
+  }
+
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "threads\textendible ops/s\tpage table ops/s" << std::endl;
+  for (size_t num_threads = 1; num_threads <= std::thread::hardware_concurrency(); num_threads *= 2) {
+    auto extendible_ops = LookupThroughput(&extendible, num_threads, num_pages, lookups_per_thread);
+    auto page_table_ops = LookupThroughput(&page_table, num_threads, num_pages, lookups_per_thread);
+    std::cout << num_threads << "\t" << static_cast<uint64_t>(extendible_ops) << "\t"
+              << static_cast<uint64_t>(page_table_ops) << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
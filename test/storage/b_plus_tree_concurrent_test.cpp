@@ -10,9 +10,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
+#include <iostream>
+#include <iterator>
+#include <mutex>  // NOLINT
+#include <random>
 #include <thread>  // NOLINT
 
 #include "buffer/buffer_pool_manager_instance.h"
@@ -100,7 +106,7 @@ void DeleteHelperSplit(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -146,13 +152,13 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   EXPECT_EQ(current_key, keys.size() + 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -197,13 +203,13 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   EXPECT_EQ(current_key, keys.size() + 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
+TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -239,13 +245,13 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   EXPECT_EQ(size, 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -282,13 +288,13 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   EXPECT_EQ(size, 4);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
+TEST(BPlusTreeConcurrentTest, MixTest) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -327,10 +333,407 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   EXPECT_EQ(size, 5);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, InsertTest3) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree, with small pages so that the inserts split leaves and internal pages up to the root
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // keys to Insert, in random order
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 1000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  LaunchParallelTest(4, InsertHelperSplit, &tree, keys, 4);
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids)) << key;
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+
+  int64_t current_key = 1;
+  index_key.SetFromInteger(current_key);
+  for (auto iterator = tree.Begin(index_key); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, keys.size() + 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, MixTest2) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // first, populate the index with the odd keys
+  std::vector<int64_t> keys;
+  std::vector<int64_t> new_keys;
+  for (int64_t key = 1; key <= 400; key++) {
+    (key % 2 == 1 ? keys : new_keys).push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  // The odd keys are always found while two threads insert the even ones, splitting the pages they are in.
+  std::atomic<bool> done{false};
+  std::atomic<int> misses{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 2; i++) {
+    threads.emplace_back([&, i] { InsertHelperSplit(&tree, new_keys, 2, i); });
+  }
+  for (int i = 0; i < 2; i++) {
+    threads.emplace_back([&] {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      do {
+        for (auto key : keys) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          if (!tree.GetValue(index_key, &rids)) {
+            misses++;
+          }
+        }
+      } while (!done);
+    });
+  }
+  threads[0].join();
+  threads[1].join();
+  done = true;
+  threads[2].join();
+  threads[3].join();
+  EXPECT_EQ(0, misses);
+
+  int64_t size = 0;
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(1);
+  for (auto iterator = tree.Begin(index_key); iterator != tree.End(); ++iterator) {
+    size = size + 1;
+  }
+  EXPECT_EQ(size, 400);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, DeleteTest3) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  const size_t buffer_pool_size = 50;
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  // create b+ tree, with small pages so that the removes merge and redistribute pages up to the root
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 1000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  InsertHelper(&tree, keys);
+
+  // the keys that are not multiples of 5 are removed, in random order
+  std::vector<int64_t> remove_keys;
+  std::copy_if(keys.begin(), keys.end(), std::back_inserter(remove_keys), [](int64_t key) { return key % 5 != 0; });
+  LaunchParallelTest(4, DeleteHelperSplit, &tree, remove_keys, 4);
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (int64_t key = 1; key <= 1000; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key % 5 == 0, tree.GetValue(index_key, &rids)) << key;
+  }
+  int64_t current_key = 5;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 5;
+  }
+  EXPECT_EQ(current_key, 1005);
+
+  // no page of the tree is left pinned: every frame but the header page's can be taken by a new page
+  std::vector<page_id_t> page_ids(buffer_pool_size - 1);
+  for (auto &new_page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&new_page_id));
+  }
+  for (auto new_page_id : page_ids) {
+    bpm->UnpinPage(new_page_id, false);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, MixTest3) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // first, populate the index with the keys that are multiples of 3 or 3k + 1
+  std::vector<int64_t> kept_keys;
+  std::vector<int64_t> remove_keys;
+  std::vector<int64_t> new_keys;
+  for (int64_t key = 1; key <= 600; key++) {
+    (key % 3 == 0 ? kept_keys : key % 3 == 1 ? remove_keys : new_keys).push_back(key);
+  }
+  InsertHelper(&tree, kept_keys);
+  InsertHelper(&tree, remove_keys);
+
+  // The kept keys are always found while two threads remove the 3k + 1 keys and two insert the 3k + 2 ones, merging,
+  // redistributing and splitting the pages they are in. Meanwhile another thread scans the leaves in key order.
+  std::atomic<bool> done{false};
+  std::atomic<int> misses{0};
+  std::atomic<int> unordered{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 2; i++) {
+    threads.emplace_back([&, i] { DeleteHelperSplit(&tree, remove_keys, 2, i); });
+    threads.emplace_back([&, i] { InsertHelperSplit(&tree, new_keys, 2, i); });
+  }
+  for (int i = 0; i < 2; i++) {
+    threads.emplace_back([&] {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      do {
+        for (auto key : kept_keys) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          if (!tree.GetValue(index_key, &rids)) {
+            misses++;
+          }
+        }
+      } while (!done);
+    });
+  }
+  threads.emplace_back([&] {
+    do {
+      int64_t last_key = 0;
+      for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+        int64_t key = (*iterator).second.GetSlotNum();
+        if (key < last_key) {
+          unordered++;
+        }
+        last_key = key;
+      }
+    } while (!done);
+  });
+  for (int i = 0; i < 4; i++) {
+    threads[i].join();
+  }
+  done = true;
+  for (int i = 4; i < 7; i++) {
+    threads[i].join();
+  }
+  EXPECT_EQ(0, misses);
+  EXPECT_EQ(0, unordered);
+
+  int64_t current_key = 2;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + (current_key % 3 == 0 ? 2 : 1);
+  }
+  EXPECT_EQ(current_key, 602);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
   delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, MixTest4) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree, with internal pages of 3 children so that removes merge them all the way up
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // first, populate the index with the keys that are multiples of 3 or 3k + 1
+  std::vector<int64_t> kept_keys;
+  std::vector<int64_t> remove_keys;
+  std::vector<int64_t> new_keys;
+  for (int64_t key = 1; key <= 900; key++) {
+    (key % 3 == 0 ? kept_keys : key % 3 == 1 ? remove_keys : new_keys).push_back(key);
+  }
+  InsertHelper(&tree, kept_keys);
+  InsertHelper(&tree, remove_keys);
+
+  // In each round, two threads remove the 3k + 1 keys and two insert the 3k + 2 ones, merging and splitting internal
+  // pages too, while four threads scan the leaves in key order. The next round puts the keys back the other way round.
+  std::atomic<bool> done{false};
+  std::atomic<int> unordered{0};
+  std::vector<std::thread> scanners;
+  for (int i = 0; i < 4; i++) {
+    scanners.emplace_back([&] {
+      do {
+        int64_t last_key = 0;
+        for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+          int64_t key = (*iterator).second.GetSlotNum();
+          if (key <= last_key) {
+            unordered++;
+          }
+          last_key = key;
+        }
+      } while (!done);
+    });
+  }
+  for (int round = 0; round < 5; round++) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 2; i++) {
+      threads.emplace_back([&, i] { DeleteHelperSplit(&tree, remove_keys, 2, i); });
+      threads.emplace_back([&, i] { InsertHelperSplit(&tree, new_keys, 2, i); });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::swap(remove_keys, new_keys);
+  }
+  done = true;
+  for (auto &scanner : scanners) {
+    scanner.join();
+  }
+  EXPECT_EQ(0, unordered);
+
+  int64_t current_key = 2;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + (current_key % 3 == 0 ? 2 : 1);
+  }
+  EXPECT_EQ(current_key, 902);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
 
+/**
+ * Lookups and inserts of a growing number of threads on a tree of 10000 keys, 4 lookups of existing keys for an insert
+ * of a new one, with latch crabbing alone and with the operations serialized by a global mutex.
+ */
+TEST(BPlusTreeConcurrentTest, DISABLED_ScalingBenchmark) {
+  const int64_t num_keys = 10000;
+  const int ops_per_thread = 20000;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  double single_thread_rate = 0;
+  for (int num_threads : {1, 2, 4, 8}) {
+    double rates[2] = {0, 0};
+    for (bool with_global_mutex : {false, true}) {
+      auto *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManagerInstance(1024, disk_manager);
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 32, 32);
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+      std::vector<int64_t> keys;
+      for (int64_t key = 0; key < num_keys; key++) {
+        keys.push_back(key * 2);
+      }
+      InsertHelper(&tree, keys);
+
+      std::mutex mtx;
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+          std::mt19937 gen(t);
+          std::uniform_int_distribution<int64_t> dist(0, num_keys - 1);
+          GenericKey<8> index_key;
+          std::vector<RID> rids;
+          int64_t next_key = 2 * num_keys + 2 * t + 1;
+          for (int i = 0; i < ops_per_thread; i++) {
+            std::unique_lock<std::mutex> lock(mtx, std::defer_lock);
+            if (with_global_mutex) {
+              lock.lock();
+            }
+            if (i % 5 == 4) {
+              index_key.SetFromInteger(next_key);
+              tree.Insert(index_key, RID(next_key), nullptr);
+              next_key += 2 * num_threads;
+            } else {
+              rids.clear();
+              index_key.SetFromInteger(dist(gen) * 2);
+              tree.GetValue(index_key, &rids);
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      rates[with_global_mutex ? 1 : 0] = num_threads * ops_per_thread / elapsed.count();
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+    if (num_threads == 1) {
+      single_thread_rate = rates[0];
+    }
+    std::cout << num_threads << " threads: crabbing " << static_cast<size_t>(rates[0]) << " ops/s ("
+              << rates[0] / single_thread_rate << "x), global mutex " << static_cast<size_t>(rates[1]) << " ops/s"
+              << std::endl;
+  }
+}
+
 }  // namespace bustub
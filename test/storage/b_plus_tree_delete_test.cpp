@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <random>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -163,4 +164,93 @@ TEST(BPlusTreeTests, DeleteTest2) {
   remove("test.db");
   remove("test.log");
 }
+
+TEST(BPlusTreeTests, DeleteTest3) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  const size_t buffer_pool_size = 50;
+  for (uint32_t seed = 0; seed < 5; seed++) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    // create b+ tree, with small pages so that the removes merge and redistribute leaves and internal pages
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    auto *transaction = new Transaction(0);
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::mt19937 generator(seed);
+    std::vector<int64_t> keys;
+    for (int64_t key = 1; key <= 200; key++) {
+      keys.push_back(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), generator);
+    for (auto key : keys) {
+      int64_t value = key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(key >> 32), value);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+
+    std::shuffle(keys.begin(), keys.end(), generator);
+    std::vector<int64_t> remove_keys(keys.begin(), keys.begin() + 100);
+    for (auto key : remove_keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+
+    std::vector<RID> rids;
+    std::vector<int64_t> left_keys;
+    for (int64_t key = 1; key <= 200; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      bool is_removed = std::find(remove_keys.begin(), remove_keys.end(), key) != remove_keys.end();
+      EXPECT_EQ(!is_removed, tree.GetValue(index_key, &rids)) << "seed " << seed << ", key " << key;
+      if (!is_removed) {
+        EXPECT_EQ(rids[0].GetSlotNum(), key);
+        left_keys.push_back(key);
+      }
+    }
+    size_t i = 0;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      ASSERT_LT(i, left_keys.size());
+      EXPECT_EQ((*iterator).second.GetSlotNum(), left_keys[i++]);
+    }
+    EXPECT_EQ(i, left_keys.size());
+
+    // remove the other keys too, down to an empty root
+    for (auto key : left_keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_FALSE(tree.GetValue(index_key, &rids));
+    }
+
+    // no page of the tree is left pinned: every frame but the header page's can be taken by a new page
+    std::vector<page_id_t> page_ids(buffer_pool_size - 1);
+    for (auto &new_page_id : page_ids) {
+      ASSERT_NE(nullptr, bpm->NewPage(&new_page_id)) << "seed " << seed;
+    }
+    for (auto new_page_id : page_ids) {
+      bpm->UnpinPage(new_page_id, false);
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete transaction;
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+}
 }  // namespace bustub
@@ -10,11 +10,28 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
 #include <cstring>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/page_extent.h"
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_mmap.h"
+#include "storage/disk/disk_manager_simulated.h"
+#include "storage/disk/tablespace_disk_manager.h"
 
 namespace bustub {
 
@@ -23,14 +40,20 @@ class DiskManagerTest : public ::testing::Test {
   // This function is called before every test.
   void SetUp() override {
     remove("test.db");
-    remove("test.log");
+    RemoveLog();
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
-    remove("test.log");
+    RemoveLog();
   };
+
+  static void RemoveLog() {
+    for (uint64_t seq = 0; seq < 16; seq++) {
+      remove(DiskManager::LogSegmentName("test.log", seq).c_str());
+    }
+  }
 };
 
 // NOLINTNEXTLINE
@@ -55,6 +78,295 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadWritePagesTest) {
+  const int num_pages = 8;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<char *> data_ptrs;
+  for (int i = 0; i < num_pages; i++) {
+    snprintf(data[i].data(), BUSTUB_PAGE_SIZE, "page %d", i);
+    data_ptrs.push_back(data[i].data());
+  }
+
+  // Two runs of adjacent pages, one of them past the end of the file.
+  std::vector<page_id_t> page_ids{0, 1, 2, 5, 6, 7, 8, 9};
+  dm.WritePages(page_ids, data_ptrs);
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  std::vector<std::vector<char>> bufs(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE, 'x'));
+  std::vector<char *> buf_ptrs;
+  for (auto &buf : bufs) {
+    buf_ptrs.push_back(buf.data());
+  }
+  dm.ReadPages(page_ids, buf_ptrs);
+  for (int i = 0; i < num_pages; i++) {
+    EXPECT_EQ(0, std::memcmp(data[i].data(), bufs[i].data(), BUSTUB_PAGE_SIZE));
+  }
+
+  // Pages in the hole are zeros, and a run crossing the end of the file is zero-filled past it.
+  std::vector<page_id_t> hole_ids{3, 4, 9, 10, 11};
+  std::vector<char *> hole_ptrs(buf_ptrs.begin(), buf_ptrs.begin() + hole_ids.size());
+  dm.ReadPages(hole_ids, hole_ptrs);
+  std::vector<char> zeros(BUSTUB_PAGE_SIZE, 0);
+  EXPECT_EQ(0, std::memcmp(zeros.data(), bufs[0].data(), BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(0, std::memcmp(zeros.data(), bufs[1].data(), BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(0, std::memcmp(data[7].data(), bufs[2].data(), BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(0, std::memcmp(zeros.data(), bufs[3].data(), BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(0, std::memcmp(zeros.data(), bufs[4].data(), BUSTUB_PAGE_SIZE));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIoTest) {
+  const int num_pages = 4;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, DiskIoMode::DIRECT);
+  // The file system of the test may not support O_DIRECT, in which case the pages go through the page cache.
+  if (dm.GetIoMode() != DiskIoMode::DIRECT) {
+    std::cout << "O_DIRECT is not supported here, testing the buffered fallback" << std::endl;
+  }
+
+  // Aligned buffers are used as is, unaligned ones (one byte off) are bounced.
+  auto *aligned = static_cast<char *>(::operator new[](2 * num_pages * BUSTUB_PAGE_SIZE,
+                                                       std::align_val_t{DIRECT_IO_ALIGNMENT}));
+  std::vector<char> unaligned_storage(num_pages * BUSTUB_PAGE_SIZE + 1);
+  char *unaligned = unaligned_storage.data() + 1;
+  std::vector<page_id_t> page_ids;
+  std::vector<char *> data_ptrs;
+  for (int i = 0; i < num_pages; i++) {
+    char *data = i % 2 == 0 ? aligned + i * BUSTUB_PAGE_SIZE : unaligned + i * BUSTUB_PAGE_SIZE;
+    memset(data, 0, BUSTUB_PAGE_SIZE);
+    snprintf(data, BUSTUB_PAGE_SIZE, "page %d", i);
+    page_ids.push_back(i);
+    data_ptrs.push_back(data);
+  }
+  dm.WritePages(page_ids, data_ptrs);
+  dm.WritePage(num_pages, unaligned);
+  EXPECT_EQ(num_pages + 1, dm.GetNumWrites());
+
+  char *bufs = aligned + num_pages * BUSTUB_PAGE_SIZE;
+  std::vector<char *> buf_ptrs;
+  for (int i = 0; i < num_pages; i++) {
+    buf_ptrs.push_back(bufs + i * BUSTUB_PAGE_SIZE);
+  }
+  dm.ReadPages(page_ids, buf_ptrs);
+  for (int i = 0; i < num_pages; i++) {
+    EXPECT_EQ(0, std::memcmp(data_ptrs[i], buf_ptrs[i], BUSTUB_PAGE_SIZE));
+  }
+  std::vector<char> buf(BUSTUB_PAGE_SIZE + 1);
+  dm.ReadPage(num_pages, buf.data() + 1);
+  EXPECT_EQ(0, std::memcmp(unaligned, buf.data() + 1, BUSTUB_PAGE_SIZE));
+
+  // Reading past the end of the file gives zeros.
+  dm.ReadPage(num_pages + 1, buf_ptrs[0]);
+  std::vector<char> zeros(BUSTUB_PAGE_SIZE, 0);
+  EXPECT_EQ(0, std::memcmp(zeros.data(), buf_ptrs[0], BUSTUB_PAGE_SIZE));
+
+  dm.ShutDown();
+  ::operator delete[](aligned, std::align_val_t{DIRECT_IO_ALIGNMENT});
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, MmapReadTest) {
+  const page_id_t num_pages = 8;
+  std::string db_file("test.db");
+  {
+    auto dm = DiskManager(db_file);
+    std::vector<char> data(BUSTUB_PAGE_SIZE);
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      snprintf(data.data(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+      dm.WritePage(page_id, data.data());
+    }
+    dm.ShutDown();
+  }
+
+  auto dm = DiskManagerMmap(db_file);
+  ASSERT_EQ(num_pages, dm.GetNumPages());
+  std::vector<char> buf(BUSTUB_PAGE_SIZE);
+  std::vector<char> expected(BUSTUB_PAGE_SIZE);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    snprintf(expected.data(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    dm.ReadPage(page_id, buf.data());
+    EXPECT_EQ(0, std::memcmp(expected.data(), buf.data(), BUSTUB_PAGE_SIZE));
+    EXPECT_EQ(0, std::memcmp(expected.data(), dm.GetPage(page_id), BUSTUB_PAGE_SIZE));
+  }
+
+  // Pages past the end of the file read as zeros and are not mapped.
+  dm.ReadPage(num_pages, buf.data());
+  EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, 0), buf);
+  EXPECT_EQ(nullptr, dm.GetPage(num_pages));
+  EXPECT_THROW(dm.WritePage(0, buf.data()), Exception);
+
+  // Scenario: a buffer pool smaller than the file scans it twice, evicting clean pages only.
+  auto bpm = BufferPoolManagerInstance(2, &dm);
+  for (int round = 0; round < 2; round++) {
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      auto *page = bpm.FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, std::memcmp(dm.GetPage(page_id), page->GetData(), BUSTUB_PAGE_SIZE));
+      ASSERT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, TablespaceTest) {
+  std::string db_file("test.db");
+  std::string ts_file("test_ts.db");
+  remove(ts_file.c_str());
+  auto dm = TablespaceDiskManager(db_file);
+  auto ts = dm.AddTablespace("fast", ts_file);
+  EXPECT_EQ(1, ts);
+  EXPECT_EQ(ts, dm.GetTablespace("fast"));
+  EXPECT_EQ(DEFAULT_TABLESPACE, dm.GetTablespace(TablespaceDiskManager::DEFAULT_TABLESPACE_NAME));
+  EXPECT_EQ(std::nullopt, dm.GetTablespace("slow"));
+  EXPECT_THROW(dm.AddTablespace("fast", ts_file), Exception);
+
+  // Pages of a tablespace are stored in its own file, at their local page id.
+  auto page_id = DiskManager::MakePageId(ts, 3);
+  EXPECT_EQ(ts, DiskManager::TablespaceOf(page_id));
+  EXPECT_EQ(3, DiskManager::LocalPageId(page_id));
+  std::vector<char> data(BUSTUB_PAGE_SIZE);
+  std::vector<char> buf(BUSTUB_PAGE_SIZE);
+  std::strncpy(data.data(), "tablespace page", BUSTUB_PAGE_SIZE);
+  dm.WritePage(page_id, data.data());
+  dm.ReadPage(page_id, buf.data());
+  EXPECT_EQ(data, buf);
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat(ts_file.c_str(), &stat_buf));
+  EXPECT_EQ(4 * BUSTUB_PAGE_SIZE, stat_buf.st_size);
+  ASSERT_EQ(0, stat(db_file.c_str(), &stat_buf));
+  EXPECT_EQ(0, stat_buf.st_size);
+  EXPECT_THROW(dm.ReadPage(DiskManager::MakePageId(ts + 1, 0), buf.data()), Exception);
+
+  // Batches mixing tablespaces are split between the files.
+  std::vector<std::vector<char>> pages(4, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<page_id_t> page_ids{0, 1, DiskManager::MakePageId(ts, 0), DiskManager::MakePageId(ts, 1)};
+  std::vector<char *> pages_data;
+  for (size_t i = 0; i < pages.size(); i++) {
+    snprintf(pages[i].data(), BUSTUB_PAGE_SIZE, "page %d", page_ids[i]);
+    pages_data.push_back(pages[i].data());
+  }
+  dm.WritePages(page_ids, pages_data);
+  for (size_t i = 0; i < pages.size(); i++) {
+    dm.ReadPage(page_ids[i], buf.data());
+    EXPECT_EQ(pages[i], buf);
+  }
+  ASSERT_EQ(0, stat(db_file.c_str(), &stat_buf));
+  EXPECT_EQ(2 * BUSTUB_PAGE_SIZE, stat_buf.st_size);
+
+  // Scenario: an extent of the tablespace starts past its last page, and the buffer pool creates and evicts the pages
+  // of a table placed there while it allocates regular pages in the database file.
+  {
+    auto bpm = BufferPoolManagerInstance(2, &dm);
+    PageExtent extent(4, ts);
+    for (page_id_t i = 0; i < 6; i++) {
+      page_id_t ts_page_id;
+      auto *page = bpm.NewPage(&ts_page_id, extent);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(DiskManager::MakePageId(ts, 4 + i), ts_page_id);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", ts_page_id);
+      ASSERT_TRUE(bpm.UnpinPage(ts_page_id, true));
+      ASSERT_NE(nullptr, bpm.NewPage(&page_id));
+      EXPECT_EQ(2 + i, page_id);
+      ASSERT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    for (page_id_t i = 0; i < 6; i++) {
+      auto ts_page_id = DiskManager::MakePageId(ts, 4 + i);
+      auto *page = bpm.FetchPage(ts_page_id);
+      ASSERT_NE(nullptr, page);
+      std::vector<char> expected(BUSTUB_PAGE_SIZE);
+      snprintf(expected.data(), BUSTUB_PAGE_SIZE, "page %d", ts_page_id);
+      EXPECT_EQ(0, std::memcmp(expected.data(), page->GetData(), BUSTUB_PAGE_SIZE));
+      ASSERT_TRUE(bpm.UnpinPage(ts_page_id, false));
+    }
+    bpm.FlushAllPages();
+  }
+  EXPECT_EQ(DiskManager::MakePageId(ts, 12), dm.GetTablespaceEnd(ts));
+  ASSERT_EQ(0, stat(ts_file.c_str(), &stat_buf));
+  EXPECT_EQ(10 * BUSTUB_PAGE_SIZE, stat_buf.st_size);
+
+  // Scenario: pages deallocated in the tablespace are reserved again once they make up a whole extent.
+  for (page_id_t i = 4; i < 7; i++) {
+    dm.DeallocatePage(DiskManager::MakePageId(ts, i));
+  }
+  EXPECT_EQ(DiskManager::MakePageId(ts, 12), dm.AllocateExtent(ts, 4));
+  dm.DeallocatePage(DiskManager::MakePageId(ts, 7));
+  EXPECT_EQ(DiskManager::MakePageId(ts, 4), dm.AllocateExtent(ts, 4));
+  EXPECT_EQ(DiskManager::MakePageId(ts, 16), dm.AllocateExtent(ts, 4));
+
+  dm.ShutDown();
+  remove(ts_file.c_str());
+  remove("test_ts.fsm");
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SimulatedDeviceTest) {
+  using std::chrono::milliseconds;
+  auto elapsed_since = [](std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<milliseconds>(std::chrono::steady_clock::now() - start);
+  };
+  DeviceProfile profile;
+  profile.read_latency_ = milliseconds(5);
+  profile.write_latency_ = milliseconds(1);
+  profile.queue_depth_ = 1;
+  DiskManagerSimulated dm(profile);
+
+  // Pages read back as written, and pages never written as zeros.
+  std::vector<char> data(BUSTUB_PAGE_SIZE);
+  std::vector<char> buf(BUSTUB_PAGE_SIZE);
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    snprintf(data.data(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    dm.WritePage(page_id, data.data());
+  }
+  EXPECT_EQ(8, dm.GetNumPages());
+  dm.ReadPage(3, buf.data());
+  EXPECT_STREQ("page 3", buf.data());
+  dm.ReadPage(100, buf.data());
+  EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, 0), buf);
+
+  // A batch is a single request, and a queue depth of 1 serves the requests of two threads one after the other.
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 2; t++) {
+    threads.emplace_back([&] {
+      std::vector<std::vector<char>> pages(4, std::vector<char>(BUSTUB_PAGE_SIZE));
+      std::vector<char *> pages_data;
+      for (auto &page : pages) {
+        pages_data.push_back(page.data());
+      }
+      for (int i = 0; i < 2; i++) {
+        dm.ReadPages({0, 1, 2, 3}, pages_data);
+      }
+      EXPECT_STREQ("page 2", pages[2].data());
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_GE(elapsed_since(start), milliseconds(4 * 5));
+  EXPECT_EQ(2 + 2 * 2 * 4, dm.GetNumReads());
+
+  // The transfers of all requests share the throughput of the device.
+  profile = DeviceProfile{};
+  profile.bytes_per_second_ = 100 * BUSTUB_PAGE_SIZE;
+  DiskManagerSimulated throttled(profile);
+  std::vector<std::vector<char>> pages(10, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<page_id_t> page_ids;
+  std::vector<char *> pages_data;
+  for (size_t i = 0; i < pages.size(); i++) {
+    page_ids.push_back(static_cast<page_id_t>(i));
+    pages_data.push_back(pages[i].data());
+  }
+  start = std::chrono::steady_clock::now();
+  throttled.WritePages(page_ids, pages_data);
+  throttled.ReadPages(page_ids, pages_data);
+  EXPECT_GE(elapsed_since(start), milliseconds(2 * 10 * 10));
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -72,7 +384,331 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LogSegmentTest) {
+  // Log buffers of every size up to a few blocks, filled with their index so that a misplaced byte shows.
+  const int num_buffers = 64;
+  auto buffer_size = [](int i) { return 1 + (i * 1031) % (3 * static_cast<int>(LOG_BLOCK_SIZE)); };
+  std::vector<std::vector<char>> buffers;
+  int log_size = 0;
+  for (int i = 0; i < num_buffers; i++) {
+    buffers.emplace_back(buffer_size(i), static_cast<char>(i + 1));
+    log_size += buffer_size(i);
+  }
+  auto check_log = [&](DiskManager &dm, int from_offset, size_t from_buffer) {
+    int offset = from_offset;
+    for (size_t i = from_buffer; i < buffers.size(); i++) {
+      std::vector<char> buf(buffers[i].size());
+      ASSERT_TRUE(dm.ReadLog(buf.data(), static_cast<int>(buf.size()), offset));
+      ASSERT_EQ(buffers[i], buf) << "buffer " << i;
+      offset += static_cast<int>(buf.size());
+    }
+    std::vector<char> buf(16);
+    EXPECT_FALSE(dm.ReadLog(buf.data(), static_cast<int>(buf.size()), offset));
+  };
+
+  // Segments are preallocated, and the log reads back across blocks.
+  struct stat stat_buf;
+  {
+    auto dm = DiskManager("test.db");
+    for (int i = 0; i < num_buffers / 2; i++) {
+      dm.WriteLog(buffers[i].data(), static_cast<int>(buffers[i].size()));
+    }
+    ASSERT_EQ(0, stat(DiskManager::LogSegmentName("test.log", 0).c_str(), &stat_buf));
+    EXPECT_EQ(LOG_SEGMENT_SIZE, static_cast<size_t>(stat_buf.st_size));
+    EXPECT_EQ(num_buffers / 2, dm.GetNumLogSyncs());
+    dm.ShutDown();
+  }
+
+  // Scenario: the log is opened again, continues in the middle of its last block and spills into a second segment.
+  std::vector<char> big(LOG_SEGMENT_PAYLOAD, 'x');
+  {
+    auto dm = DiskManager("test.db");
+    for (int i = num_buffers / 2; i < num_buffers; i++) {
+      dm.WriteLog(buffers[i].data(), static_cast<int>(buffers[i].size()));
+    }
+    EXPECT_EQ(log_size, dm.GetLogSize());
+    check_log(dm, 0, 0);
+    dm.WriteLog(big.data(), static_cast<int>(big.size()));
+    EXPECT_EQ(0, stat(DiskManager::LogSegmentName("test.log", 1).c_str(), &stat_buf));
+    std::vector<char> buf(big.size());
+    ASSERT_TRUE(dm.ReadLog(buf.data(), static_cast<int>(buf.size()), log_size));
+    EXPECT_EQ(big, buf);
+    dm.ShutDown();
+  }
+
+  // The segments before the last one are recycled as a spare one, and the offsets restart at the last one, which the
+  // log then fills up to continue in the spare one.
+  {
+    auto dm = DiskManager("test.db");
+    EXPECT_EQ(log_size + static_cast<int>(big.size()), dm.GetLogSize());
+    dm.RecycleLog();
+    auto tail = log_size + static_cast<int>(big.size()) - static_cast<int>(LOG_SEGMENT_PAYLOAD);
+    EXPECT_EQ(tail, dm.GetLogSize());
+    EXPECT_NE(0, stat(DiskManager::LogSegmentName("test.log", 0).c_str(), &stat_buf));
+    EXPECT_EQ(0, stat(DiskManager::LogSegmentName("test.log", 2).c_str(), &stat_buf));
+    dm.WriteLog(big.data(), static_cast<int>(big.size()));
+    buffers.clear();
+    buffers.push_back(big);
+    check_log(dm, tail, 0);
+    dm.ShutDown();
+  }
+  // A recycled segment's old blocks are not mistaken for log data when the log is opened again.
+  auto dm = DiskManager("test.db");
+  EXPECT_EQ(static_cast<int>(LOG_SEGMENT_PAYLOAD) + log_size + static_cast<int>(big.size()) -
+                static_cast<int>(LOG_SEGMENT_PAYLOAD),
+            dm.GetLogSize());
+  check_log(dm, log_size + static_cast<int>(big.size()) - static_cast<int>(LOG_SEGMENT_PAYLOAD), 0);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LogGroupFlushTest) {
+  const int num_threads = 4;
+  const int writes_per_thread = 50;
+  auto dm = DiskManager("test.db");
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      // Log buffers are swapped between writes, as the log manager does.
+      std::vector<std::vector<char>> buffers(2, std::vector<char>(100, static_cast<char>('a' + t)));
+      for (int i = 0; i < writes_per_thread; i++) {
+        dm.WriteLog(buffers[i % 2].data(), static_cast<int>(buffers[i % 2].size()));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * writes_per_thread, dm.GetNumFlushes());
+  EXPECT_LE(dm.GetNumLogSyncs(), dm.GetNumFlushes());
+  EXPECT_EQ(num_threads * writes_per_thread * 100, dm.GetLogSize());
+
+  // Every write landed in one piece.
+  std::vector<char> buf(100);
+  for (int offset = 0; offset < dm.GetLogSize(); offset += 100) {
+    ASSERT_TRUE(dm.ReadLog(buf.data(), 100, offset));
+    EXPECT_EQ(std::vector<char>(100, buf[0]), buf);
+  }
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
+/**
+ * Reads random pages of the same database file from a growing number of threads. Page reads are positional, so the
+ * throughput should scale with the threads as long as the file stays in the page cache.
+ */
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_RandomReadScalingBenchmark) {
+  const page_id_t num_pages = 16384;
+  const size_t reads_per_thread = 200000;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  std::vector<char> data(BUSTUB_PAGE_SIZE);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    snprintf(data.data(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    dm.WritePage(page_id, data.data());
+  }
+
+  double single_thread_rate = 0;
+  for (size_t num_threads = 1; num_threads <= 16; num_threads *= 2) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t] {
+        std::mt19937 gen(t);
+        std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+        std::vector<char> buf(BUSTUB_PAGE_SIZE);
+        for (size_t i = 0; i < reads_per_thread; i++) {
+          dm.ReadPage(dist(gen), buf.data());
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    auto rate = static_cast<double>(num_threads * reads_per_thread) / elapsed.count();
+    if (num_threads == 1) {
+      single_thread_rate = rate;
+    }
+    std::cout << num_threads << " threads: " << static_cast<size_t>(rate) << " reads/s, " << rate / single_thread_rate
+              << "x" << std::endl;
+  }
+
+  dm.ShutDown();
+}
+
+/**
+ * Writes a database file and reads random pages of it, once through the page cache and once with O_DIRECT. The file
+ * is dropped from the page cache before every read pass, so buffered reads start cold as well; the buffered file
+ * then stays cached by the OS, next to the buffer pool that would cache the same pages again.
+ */
+/**
+ * Reads random pages through a buffer pool that holds a quarter of them, on each emulated device, with 1 to 16 threads.
+ * Prints the pages fetched per second.
+ */
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_SimulatedDeviceBenchmark) {
+  const page_id_t num_pages = 1024;
+  const size_t fetches = 4000;
+  std::cout << "device\tthreads\tfetches/s" << std::endl;
+  for (auto [name, profile] : {std::make_pair("hdd", DeviceProfile::Hdd()),
+                               std::make_pair("sata", DeviceProfile::SataSsd()),
+                               std::make_pair("nvme", DeviceProfile::Nvme())}) {
+    DiskManagerSimulated dm(profile);
+    // Load the pages with large batches, a request each.
+    std::vector<char> data(64 * BUSTUB_PAGE_SIZE);
+    for (page_id_t first = 0; first < num_pages; first += 64) {
+      std::vector<page_id_t> page_ids;
+      std::vector<char *> pages_data;
+      for (page_id_t i = 0; i < 64; i++) {
+        page_ids.push_back(first + i);
+        pages_data.push_back(data.data() + i * BUSTUB_PAGE_SIZE);
+      }
+      dm.WritePages(page_ids, pages_data);
+    }
+    for (size_t num_threads = 1; num_threads <= 16; num_threads *= 4) {
+      auto bpm = BufferPoolManagerInstance(num_pages / 4, &dm);
+      // A hard disk serves a few hundred requests per second: keep its run short.
+      auto fetches_per_thread = (profile.queue_depth_ == 1 ? fetches / 20 : fetches) / num_threads;
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+          std::mt19937 gen(t);
+          std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+          for (size_t i = 0; i < fetches_per_thread; i++) {
+            auto page_id = dist(gen);
+            if (bpm.FetchPage(page_id) != nullptr) {
+              bpm.UnpinPage(page_id, false);
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << name << "\t" << num_threads << "\t"
+                << static_cast<size_t>(static_cast<double>(fetches_per_thread * num_threads) / elapsed.count())
+                << std::endl;
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_DirectIoBenchmark) {
+  const page_id_t num_pages = 16384;
+  const size_t num_reads = 50000;
+  auto *data = static_cast<char *>(::operator new[](BUSTUB_PAGE_SIZE, std::align_val_t{DIRECT_IO_ALIGNMENT}));
+  for (auto io_mode : {DiskIoMode::BUFFERED, DiskIoMode::DIRECT}) {
+    remove("test.db");
+    std::string db_file("test.db");
+    auto dm = DiskManager(db_file, io_mode);
+    const char *name = dm.GetIoMode() == DiskIoMode::DIRECT ? "direct" : "buffered";
+
+    auto start = std::chrono::steady_clock::now();
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      memset(data, 0, BUSTUB_PAGE_SIZE);
+      snprintf(data, BUSTUB_PAGE_SIZE, "page %d", page_id);
+      dm.WritePage(page_id, data);
+    }
+    dm.Sync();
+    std::chrono::duration<double> write_time = std::chrono::steady_clock::now() - start;
+
+    int fd = open(db_file.c_str(), O_RDONLY);  // NOLINT
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_reads; i++) {
+      dm.ReadPage(dist(gen), data);
+    }
+    std::chrono::duration<double> read_time = std::chrono::steady_clock::now() - start;
+
+    std::cout << name << ": " << static_cast<size_t>(num_pages / write_time.count()) << " writes/s, "
+              << static_cast<size_t>(num_reads / read_time.count()) << " random reads/s" << std::endl;
+    dm.ShutDown();
+  }
+  ::operator delete[](data, std::align_val_t{DIRECT_IO_ALIGNMENT});
+}
+
+/**
+ * Scans a database file a few times through a buffer pool much smaller than the file, once with page misses served by
+ * pread and once by copies out of a memory mapping. The file is in the page cache either way.
+ */
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_MmapScanBenchmark) {
+  const page_id_t num_pages = 16384;
+  const size_t buffer_pool_size = 64;
+  const int num_scans = 10;
+  std::string db_file("test.db");
+  {
+    auto dm = DiskManager(db_file);
+    std::vector<char> data(BUSTUB_PAGE_SIZE);
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      snprintf(data.data(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+      dm.WritePage(page_id, data.data());
+    }
+    dm.ShutDown();
+  }
+
+  auto scan = [&](DiskManager *dm) {
+    auto bpm = BufferPoolManagerInstance(buffer_pool_size, dm);
+    auto start = std::chrono::steady_clock::now();
+    for (int scan = 0; scan < num_scans; scan++) {
+      for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+        bpm.FetchPage(page_id);
+        bpm.UnpinPage(page_id, false);
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(num_scans) * num_pages / elapsed.count();
+  };
+  auto pread_dm = DiskManager(db_file);
+  auto mmap_dm = DiskManagerMmap(db_file);
+  scan(&pread_dm);
+  auto pread_rate = scan(&pread_dm);
+  scan(&mmap_dm);
+  auto mmap_rate = scan(&mmap_dm);
+  std::cout << "pread: " << static_cast<size_t>(pread_rate) << " pages/s, mmap: " << static_cast<size_t>(mmap_rate)
+            << " pages/s, " << mmap_rate / pread_rate << "x" << std::endl;
+  pread_dm.ShutDown();
+}
+
+/**
+ * Commits of small log records by a growing number of threads, each waiting for its record to be durable. Concurrent
+ * commits share the syncs of the log.
+ */
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_LogGroupCommitBenchmark) {
+  const int commits_per_thread = 500;
+  for (int num_threads : {1, 2, 8, 32}) {
+    RemoveLog();
+    auto dm = DiskManager("test.db");
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&] {
+        std::vector<std::vector<char>> buffers(2, std::vector<char>(128, 'r'));
+        for (int i = 0; i < commits_per_thread; i++) {
+          dm.WriteLog(buffers[i % 2].data(), static_cast<int>(buffers[i % 2].size()));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << num_threads << " threads: " << static_cast<size_t>(dm.GetNumFlushes() / elapsed.count())
+              << " commits/s, " << dm.GetNumLogSyncs() << " syncs for " << dm.GetNumFlushes() << " commits"
+              << std::endl;
+    dm.ShutDown();
+  }
+}
+
 }  // namespace bustub
@@ -0,0 +1,252 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+/**
+ * A disk manager that records every batch it is asked to issue, and holds the first one until Release() is called so
+ * that requests pile up in the scheduler.
+ */
+class GatedDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  struct Call {
+    bool is_write_;
+    std::vector<page_id_t> page_ids_;
+  };
+
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override {
+    Record(false, page_ids);
+    DiskManagerUnlimitedMemory::ReadPages(page_ids, pages_data);
+  }
+
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &pages_data) override {
+    Record(true, page_ids);
+    DiskManagerUnlimitedMemory::WritePages(page_ids, pages_data);
+  }
+
+  /** Block until the first batch has reached the disk manager. */
+  void WaitUntilHeld() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return !calls_.empty(); });
+  }
+
+  void Release() {
+    {
+      std::scoped_lock<std::mutex> lock(mutex_);
+      released_ = true;
+    }
+    cv_.notify_all();
+  }
+
+  auto GetCalls() -> std::vector<Call> {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    return calls_;
+  }
+
+ private:
+  void Record(bool is_write, const std::vector<page_id_t> &page_ids) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    calls_.push_back({is_write, page_ids});
+    cv_.notify_all();
+    cv_.wait(lock, [&] { return released_; });
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool released_{false};
+  std::vector<Call> calls_;
+};
+
+static void FillPage(char *data, page_id_t page_id, int version) {
+  memset(data, 0, BUSTUB_PAGE_SIZE);
+  snprintf(data, BUSTUB_PAGE_SIZE, "page %d version %d", page_id, version);
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, ScheduleReadWriteTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto scheduler = std::make_unique<DiskScheduler>(disk_manager.get());
+
+  char data[BUSTUB_PAGE_SIZE];
+  char buf[BUSTUB_PAGE_SIZE];
+  FillPage(data, 0, 1);
+  ASSERT_TRUE(scheduler->ScheduleWrite(0, data).get());
+  ASSERT_TRUE(scheduler->ScheduleRead(0, buf).get());
+  EXPECT_EQ(0, memcmp(data, buf, BUSTUB_PAGE_SIZE));
+
+  // Scenario: a request with a callback and a promise. The callback runs before the promise is set.
+  bool called = false;
+  DiskRequest request;
+  request.data_ = buf;
+  request.page_id_ = 0;
+  request.callback_ = DiskScheduler::CreatePromise();
+  request.on_complete_ = [&](bool ok) { called = ok; };
+  auto future = request.callback_.get_future();
+  scheduler->Schedule(std::move(request));
+  ASSERT_TRUE(future.get());
+  EXPECT_TRUE(called);
+
+  // Scenario: the exception of the disk manager is handed to the caller.
+  EXPECT_THROW(scheduler->ScheduleRead(42, buf).get(), Exception);
+
+  scheduler->WaitForIdle();
+  auto stats = scheduler->GetStats();
+  EXPECT_EQ(3, stats.reads_);
+  EXPECT_EQ(1, stats.writes_);
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, MergeAndPriorityTest) {
+  auto disk_manager = std::make_unique<GatedDiskManager>();
+  std::vector<std::unique_ptr<char[]>> pages;
+  for (page_id_t page_id = 0; page_id <= 100; page_id++) {
+    pages.emplace_back(new char[BUSTUB_PAGE_SIZE]);
+    FillPage(pages.back().get(), page_id, 1);
+    disk_manager->DiskManagerUnlimitedMemory::WritePage(page_id, pages.back().get());
+  }
+
+  auto scheduler = std::make_unique<DiskScheduler>(disk_manager.get(), 1);
+  std::vector<std::future<bool>> futures;
+  // Keep the only worker busy, so that everything below is queued.
+  futures.push_back(scheduler->ScheduleRead(100, pages[100].get()));
+  disk_manager->WaitUntilHeld();
+
+  char background_data[BUSTUB_PAGE_SIZE];
+  char foreground_data[BUSTUB_PAGE_SIZE];
+  FillPage(background_data, 50, 2);
+  FillPage(foreground_data, 60, 2);
+  futures.push_back(scheduler->ScheduleWrite(50, background_data, DiskRequestPriority::BACKGROUND));
+  futures.push_back(scheduler->ScheduleWrite(60, foreground_data));
+  for (page_id_t page_id = 9; page_id >= 0; page_id--) {
+    futures.push_back(scheduler->ScheduleRead(page_id, pages[page_id].get()));
+  }
+  futures.push_back(scheduler->ScheduleRead(11, pages[11].get()));
+
+  // Scenario: a read of a page with a queued write gets the data of that write right away.
+  char buf[BUSTUB_PAGE_SIZE];
+  auto read_queued_write = scheduler->ScheduleRead(50, buf);
+  ASSERT_EQ(std::future_status::ready, read_queued_write.wait_for(std::chrono::seconds(0)));
+  EXPECT_EQ(0, memcmp(background_data, buf, BUSTUB_PAGE_SIZE));
+
+  disk_manager->Release();
+  DiskScheduler::WaitAll(&futures);
+
+  // Adjacent reads are merged and issued in page order, then the foreground write, then the background one.
+  auto calls = disk_manager->GetCalls();
+  ASSERT_EQ(5, calls.size());
+  EXPECT_FALSE(calls[1].is_write_);
+  EXPECT_EQ((std::vector<page_id_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), calls[1].page_ids_);
+  EXPECT_FALSE(calls[2].is_write_);
+  EXPECT_EQ(std::vector<page_id_t>{11}, calls[2].page_ids_);
+  EXPECT_TRUE(calls[3].is_write_);
+  EXPECT_EQ(std::vector<page_id_t>{60}, calls[3].page_ids_);
+  EXPECT_TRUE(calls[4].is_write_);
+  EXPECT_EQ(std::vector<page_id_t>{50}, calls[4].page_ids_);
+
+  auto stats = scheduler->GetStats();
+  EXPECT_EQ(1, stats.reads_from_queued_writes_);
+  EXPECT_EQ(3, stats.read_batches_);
+  EXPECT_EQ(2, stats.write_batches_);
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, SamePageOrderTest) {
+  auto disk_manager = std::make_unique<GatedDiskManager>();
+  char old_data[BUSTUB_PAGE_SIZE];
+  FillPage(old_data, 1, 1);
+  disk_manager->DiskManagerUnlimitedMemory::WritePage(0, old_data);
+  disk_manager->DiskManagerUnlimitedMemory::WritePage(1, old_data);
+
+  auto scheduler = std::make_unique<DiskScheduler>(disk_manager.get(), 2);
+  std::vector<std::future<bool>> futures;
+  char buf0[BUSTUB_PAGE_SIZE];
+  futures.push_back(scheduler->ScheduleRead(0, buf0));
+  disk_manager->WaitUntilHeld();
+
+  // Scenario: a read queued before a write of the same page sees the old data, even with a second worker idle.
+  char before_write[BUSTUB_PAGE_SIZE];
+  char data_v2[BUSTUB_PAGE_SIZE];
+  char data_v3[BUSTUB_PAGE_SIZE];
+  FillPage(data_v2, 1, 2);
+  FillPage(data_v3, 1, 3);
+  futures.push_back(scheduler->ScheduleRead(1, before_write));
+  disk_manager->Release();
+  futures.push_back(scheduler->ScheduleWrite(1, data_v2));
+  futures.push_back(scheduler->ScheduleWrite(1, data_v3));
+  DiskScheduler::WaitAll(&futures);
+  EXPECT_EQ(0, memcmp(old_data, before_write, BUSTUB_PAGE_SIZE));
+
+  // Scenario: the last write of a page wins.
+  char after_write[BUSTUB_PAGE_SIZE];
+  ASSERT_TRUE(scheduler->ScheduleRead(1, after_write).get());
+  EXPECT_EQ(0, memcmp(data_v3, after_write, BUSTUB_PAGE_SIZE));
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, BufferPoolTest) {
+  const size_t buffer_pool_size = 8;
+  const page_id_t num_pages = 64;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto scheduler = std::make_shared<DiskScheduler>(disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get());
+  bpm->SetDiskScheduler(scheduler);
+  ASSERT_EQ(scheduler.get(), bpm->GetDiskScheduler());
+
+  // Every page is evicted, written back and read again through the scheduler.
+  for (page_id_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    FillPage(page->GetData(), page_id, 1);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      char expected[BUSTUB_PAGE_SIZE];
+      for (page_id_t page_id = t; page_id < num_pages; page_id += 4) {
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        FillPage(expected, page_id, 1);
+        EXPECT_EQ(0, memcmp(expected, page->GetData(), BUSTUB_PAGE_SIZE));
+        ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  auto stats = scheduler->GetStats();
+  EXPECT_GE(stats.writes_, static_cast<size_t>(num_pages - buffer_pool_size));
+  EXPECT_GE(stats.reads_, static_cast<size_t>(num_pages - buffer_pool_size));
+  bpm.reset();
+}
+
+}  // namespace bustub
@@ -7,6 +7,7 @@
 #include <utility>
 
 #include "argparse/argparse.hpp"
+#include "buffer/access_trace.h"
 #include "common/bustub_instance.h"
 #include "common/exception.h"
 #include "common/util/string_util.h"
@@ -145,6 +146,7 @@ auto main(int argc, char **argv) -> int {  // NOLINT
   program.add_argument("file").help("the sqllogictest file to run");
   program.add_argument("--verbose").help("increase output verbosity").default_value(false).implicit_value(true);
   program.add_argument("-d", "--diff").help("write diff file").default_value(false).implicit_value(true);
+  program.add_argument("--trace").help("record the buffer pool access trace to this file");
 
   try {
     program.parse_args(argc, argv);
@@ -173,6 +175,10 @@ auto main(int argc, char **argv) -> int {  // NOLINT
   bustub->GenerateMockTable();
 
   if (bustub->buffer_pool_manager_ != nullptr) {
+    if (program.present("--trace")) {
+      bustub->buffer_pool_manager_->StartAccessTrace(
+          std::make_shared<bustub::AccessTraceWriter>(program.get("--trace")));
+    }
     bustub->GenerateTestTable();
   }
 
@@ -10,6 +10,7 @@
 
 #include "argparse/argparse.hpp"
 #include "binder/binder.h"
+#include "buffer/access_trace.h"
 #include "common/bustub_instance.h"
 #include "common/exception.h"
 #include "common/util/string_util.h"
@@ -120,6 +121,8 @@ auto main(int argc, char **argv) -> int {
   program.add_argument("--duration").help("run terrier bench for n milliseconds");
   program.add_argument("--force-create-index").help("create index in terrier bench");
   program.add_argument("--force-enable-update").help("use update statement in terrier bench");
+  program.add_argument("--bpm-instances").help("number of buffer pool instances (shards) in terrier bench");
+  program.add_argument("--trace").help("record the buffer pool access trace to this file");
 
   try {
     program.parse_args(argc, argv);
@@ -129,7 +132,16 @@ auto main(int argc, char **argv) -> int {
     return 1;
   }
 
-  auto bustub = std::make_unique<bustub::BustubInstance>();
+  size_t bpm_instances = 1;
+  if (program.present("--bpm-instances")) {
+    bpm_instances = std::stoi(program.get("--bpm-instances"));
+  }
+
+  auto bustub = std::make_unique<bustub::BustubInstance>(bpm_instances);
+  if (program.present("--trace")) {
+    bustub->buffer_pool_manager_->StartAccessTrace(
+        std::make_shared<bustub::AccessTraceWriter>(program.get("--trace")));
+  }
   auto writer = bustub::SimpleStreamWriter(std::cerr);
 
   // create schema
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/access_trace.h"
+#include "buffer/trace_replayer.h"
+#include "common/exception.h"
+#include "common/util/string_util.h"
+#include "fmt/core.h"
+
+namespace {
+
+const std::vector<bustub::ReplacerPolicy> ALL_POLICIES = {
+    bustub::ReplacerPolicy::LRU, bustub::ReplacerPolicy::CLOCK,     bustub::ReplacerPolicy::LRU_K,
+    bustub::ReplacerPolicy::ARC, bustub::ReplacerPolicy::TWO_QUEUE, bustub::ReplacerPolicy::CLOCK_PRO};
+
+auto ParsePolicies(const std::string &arg) -> std::vector<bustub::ReplacerPolicy> {
+  std::vector<bustub::ReplacerPolicy> policies;
+  for (const auto &name : bustub::StringUtil::Split(arg, ',')) {
+    auto it = std::find_if(ALL_POLICIES.begin(), ALL_POLICIES.end(), [&](bustub::ReplacerPolicy policy) {
+      return bustub::StringUtil::Lower(fmt::format("{}", policy)) == bustub::StringUtil::Lower(name);
+    });
+    if (it == ALL_POLICIES.end()) {
+      throw bustub::Exception(fmt::format("unknown replacer policy: {}", name));
+    }
+    policies.push_back(*it);
+  }
+  return policies;
+}
+
+auto ParseFrames(const std::string &arg) -> std::vector<size_t> {
+  std::vector<size_t> frames;
+  for (const auto &count : bustub::StringUtil::Split(arg, ',')) {
+    frames.push_back(std::stoul(count));
+  }
+  return frames;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-trace-replay");
+  program.add_argument("trace").help("the buffer pool access trace to replay");
+  program.add_argument("--policies").help("comma-separated replacer policies to replay against (default: all)");
+  program.add_argument("--frames").help("comma-separated pool sizes (default: powers of two up to the working set)");
+  program.add_argument("--k").help("lookback constant of the LRU-K replacer");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  std::vector<bustub::AccessTraceRecord> records;
+  std::unordered_set<bustub::page_id_t> pages;
+  std::unordered_set<uint16_t> threads;
+  size_t fetches = 0;
+  size_t fetch_hits = 0;
+  try {
+    bustub::AccessTraceReader reader(program.get("trace"));
+    bustub::AccessTraceRecord record;
+    while (reader.Next(&record)) {
+      records.push_back(record);
+      threads.insert(record.thread_id_);
+      if (record.type_ == bustub::AccessType::FETCH || record.type_ == bustub::AccessType::NEW) {
+        pages.insert(record.page_id_);
+      }
+      if (record.type_ == bustub::AccessType::FETCH) {
+        fetches++;
+        fetch_hits += (record.flags_ & bustub::ACCESS_TRACE_HIT) != 0 ? 1 : 0;
+      }
+    }
+  } catch (const bustub::Exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  auto policies = program.present("--policies") ? ParsePolicies(program.get("--policies")) : ALL_POLICIES;
+  size_t k = program.present("--k") ? std::stoul(program.get("--k")) : bustub::LRUK_REPLACER_K;
+  std::vector<size_t> frame_counts;
+  if (program.present("--frames")) {
+    frame_counts = ParseFrames(program.get("--frames"));
+  } else {
+    for (size_t frames = 16; frames / 2 < pages.size(); frames *= 2) {
+      frame_counts.push_back(frames);
+    }
+  }
+
+  auto duration_ms = records.empty() ? 0 : records.back().timestamp_ns_ / 1000000;
+  fmt::print("records: {}, pages: {}, threads: {}, duration: {} ms\n", records.size(), pages.size(), threads.size(),
+             duration_ms);
+  if (fetches != 0) {
+    fmt::print("traced pool: {} fetches, hit ratio {:.4f}\n", fetches, static_cast<double>(fetch_hits) / fetches);
+  }
+  fmt::print("frames\tpolicy\thit ratio\tmean (ns)\tp99 (ns)\n");
+  for (auto frames : frame_counts) {
+    for (auto policy : policies) {
+      bustub::TraceReplayer replayer(policy, frames, k);
+      for (const auto &record : records) {
+        replayer.Replay(record);
+      }
+      auto stats = replayer.GetStats();
+      fmt::print("{}\t{}\t{:.4f}\t{:.1f}\t{}\n", frames, policy, stats.HitRatio(), stats.mean_latency_ns_,
+                 stats.p99_latency_ns_);
+    }
+  }
+  return 0;
+}